@@ -0,0 +1,125 @@
+/*
+
+  Example-12_Interrupt.ino
+
+  The TMF882X Arduino library uses the TMF882X Software Development Kit (SDK) from
+  AMS to interface with the sensor. This SDK returns results by calling a provided
+  function and passing in a message structure.
+
+  This example shows how to use the INT pin of the TMF882X to service the device
+  as soon as new results are available, instead of polling the device on a fixed
+  sample delay.
+
+  The interrupt service routine only tells the library an interrupt took place. The
+  library then reads out the results right away. The latency from the interrupt to
+  the measurement callback is tracked by the library and printed after each set of
+  samples.
+
+  Hardware:
+    Connect the INT pin of the TMF882X board to the pin defined by INT_PIN below.
+
+  Supported Boards:
+
+   SparkFun Qwiic dToF Imager - TMF8820        https://www.sparkfun.com/products/19036
+   SparkFun Qwiic Mini dToF Imager - TMF8820   https://www.sparkfun.com/products/19218
+   SparkFun Qwiic Mini dToF Imager - TMF8821   https://www.sparkfun.com/products/19451
+   SparkFun Qwiic dToF Imager - TMF8821        https://www.sparkfun.com/products/19037
+
+  Written by Kirk Benell @ SparkFun Electronics, April 2022
+
+  Repository:
+     https://github.com/sparkfun/SparkFun_Qwiic_TMF882X_Arduino_Library
+
+  Documentation:
+     https://sparkfun.github.io/SparkFun_Qwiic_TMF882X_Arduino_Library/
+
+  SparkFun code, firmware, and software is released under the MIT License(http://opensource.org/licenses/MIT).
+*/
+
+#include "SparkFun_TMF882X_Library.h"  //http://librarymanager/All#SparkFun_Qwiic_TMPF882X
+
+SparkFun_TMF882X  myTMF882X;
+
+// The host pin connected to the INT pin of the TMF882X
+
+#define INT_PIN  2
+
+// Each loop takes a number of samples/measurements. Define how many to take here.
+
+#define NUMBER_OF_SAMPLES_TO_TAKE  10
+
+// Our interrupt service routine - just let the library know the interrupt happened.
+
+void onInterrupt()
+{
+    myTMF882X.signalInterrupt();
+}
+
+// Define our measurement callback function. The Library calls this when a
+// measurment is taken.
+
+void onMeasurementCallback(struct tmf882x_msg_meas_results *myResults)
+{
+    Serial.print("Result Number: "); Serial.print(myResults->result_num);
+    Serial.print(" Number of Results: "); Serial.println(myResults->num_results);
+
+    for(uint32_t i = 0; i < myResults->num_results; ++i)
+    {
+        Serial.print("    conf: "); Serial.print(myResults->results[i].confidence);
+        Serial.print(" distance mm: "); Serial.print(myResults->results[i].distance_mm);
+        Serial.print(" channel: "); Serial.print(myResults->results[i].channel);
+        Serial.print(" sub_capture: "); Serial.println(myResults->results[i].sub_capture);
+    }
+}
+
+void setup()
+{
+
+    delay(500);
+    Serial.begin(115200);
+    Serial.println("");
+
+    if(!myTMF882X.begin())
+    {
+        Serial.println("Error - The TMF882X failed to initialize - is the board connected?");
+        while(1);
+    }
+
+    // set our callback function in the library.
+    myTMF882X.setMeasurementHandler(onMeasurementCallback);
+
+    // The INT pin of the TMF882X is open drain, active low.
+    pinMode(INT_PIN, INPUT_PULLUP);
+    attachInterrupt(digitalPinToInterrupt(INT_PIN), onInterrupt, FALLING);
+
+    // Have the library wait on the interrupt, not the sample delay. The sample
+    // delay is now the longest the library will wait for an interrupt.
+    myTMF882X.setInterruptMode(true);
+    myTMF882X.setSampleDelay(1000);
+}
+
+void loop()
+{
+    delay(2000);
+
+    Serial.println("---------------------------------------------------------");
+    Serial.print("Taking ");
+    Serial.print(NUMBER_OF_SAMPLES_TO_TAKE);
+    Serial.println(" data samples.");
+    Serial.println();
+
+    myTMF882X.resetLatencyStats();
+    myTMF882X.startMeasuring(NUMBER_OF_SAMPLES_TO_TAKE);
+
+    // How long did it take to get from the interrupt to our callback?
+    TMF882XLatencyStats stats;
+    myTMF882X.getLatencyStats(stats);
+
+    Serial.println();
+    Serial.print("Interrupt to callback latency (us) - count: "); Serial.print(stats.count);
+    Serial.print(" min: "); Serial.print(stats.minUS);
+    Serial.print(" max: "); Serial.print(stats.maxUS);
+    Serial.print(" avg: "); Serial.println(stats.avgUS);
+
+    Serial.println("---------------------------------------------------------\n\n");
+}
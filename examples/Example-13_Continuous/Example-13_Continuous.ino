@@ -0,0 +1,104 @@
+/*
+
+  Example-13_Continuous.ino
+
+  The TMF882X Arduino library uses the TMF882X Software Development Kit (SDK) from
+  AMS to interface with the sensor. This SDK returns results by calling a provided
+  function and passing in a message structure.
+
+  This example shows how to take measurements without giving the main loop over
+  to the library. Continuous mode is started in setup(), and the device is serviced
+  by calling service() from loop(). Each call returns right away if nothing is
+  pending, leaving the loop free for other work - here, blinking the LED.
+
+  Supported Boards:
+
+   SparkFun Qwiic dToF Imager - TMF8820        https://www.sparkfun.com/products/19036
+   SparkFun Qwiic Mini dToF Imager - TMF8820   https://www.sparkfun.com/products/19218
+   SparkFun Qwiic Mini dToF Imager - TMF8821   https://www.sparkfun.com/products/19451
+   SparkFun Qwiic dToF Imager - TMF8821        https://www.sparkfun.com/products/19037
+
+  Written by Kirk Benell @ SparkFun Electronics, April 2022
+
+  Repository:
+     https://github.com/sparkfun/SparkFun_Qwiic_TMF882X_Arduino_Library
+
+  Documentation:
+     https://sparkfun.github.io/SparkFun_Qwiic_TMF882X_Arduino_Library/
+
+  SparkFun code, firmware, and software is released under the MIT License(http://opensource.org/licenses/MIT).
+*/
+
+#include "SparkFun_TMF882X_Library.h"  //http://librarymanager/All#SparkFun_Qwiic_TMPF882X
+
+SparkFun_TMF882X  myTMF882X;
+
+#ifndef LED_BUILTIN
+#define LED_BUILTIN 13
+#endif
+
+#define BLINK_PERIOD_MS  250
+
+unsigned long lastBlink = 0;
+bool ledOn = false;
+
+// Define our measurement callback function. The Library calls this when a
+// measurment is taken.
+
+void onMeasurementCallback(struct tmf882x_msg_meas_results *myResults)
+{
+    Serial.print("Result Number: "); Serial.print(myResults->result_num);
+    Serial.print(" Number of Results: "); Serial.println(myResults->num_results);
+
+    for(uint32_t i = 0; i < myResults->num_results; ++i)
+    {
+        Serial.print("    conf: "); Serial.print(myResults->results[i].confidence);
+        Serial.print(" distance mm: "); Serial.print(myResults->results[i].distance_mm);
+        Serial.print(" channel: "); Serial.print(myResults->results[i].channel);
+        Serial.print(" sub_capture: "); Serial.println(myResults->results[i].sub_capture);
+    }
+    Serial.println();
+}
+
+void setup()
+{
+
+    delay(500);
+    Serial.begin(115200);
+    Serial.println("");
+
+    pinMode(LED_BUILTIN, OUTPUT);
+
+    if(!myTMF882X.begin())
+    {
+        Serial.println("Error - The TMF882X failed to initialize - is the board connected?");
+        while(1);
+    }
+
+    // set our callback function in the library.
+    myTMF882X.setMeasurementHandler(onMeasurementCallback);
+
+    // In continuous mode, the sample delay is the poll period of service()
+    myTMF882X.setSampleDelay(100);
+
+    if(!myTMF882X.beginContinuous())
+    {
+        Serial.println("Error - Unable to start continuous measurements");
+        while(1);
+    }
+}
+
+void loop()
+{
+    // Service the sensor - returns right away if there is nothing to do.
+    if(myTMF882X.service() < 0)
+        Serial.println("Error - servicing the TMF882X failed");
+
+    // Our other work
+    if(millis() - lastBlink >= BLINK_PERIOD_MS)
+    {
+        lastBlink = millis();
+        ledOn = !ledOn;
+        digitalWrite(LED_BUILTIN, ledOn ? HIGH : LOW);
+    }
+}
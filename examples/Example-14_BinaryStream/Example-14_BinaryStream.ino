@@ -0,0 +1,97 @@
+/*
+
+  Example-14_BinaryStream.ino
+
+  This example shows how to send results and raw histogram data from the
+  connected TMF882X device over a serial port, using the compact binary
+  stream format of the library.
+
+  The ASCII output of Example-11 takes over a second to send a histogram
+  at 115200 baud. In the binary format, most bins of a histogram take one
+  or two bytes - a histogram takes 1.3 to 2.6 KB.
+
+  On the host, the stream is converted to CSV using the tool in
+  extras/stream of this library:
+
+      ./stream2csv.sh -t histogram capture.bin > histograms.csv
+
+  Supported Boards:
+
+   SparkFun Qwiic dToF Imager - TMF8820        https://www.sparkfun.com/products/19036
+   SparkFun Qwiic Mini dToF Imager - TMF8820   https://www.sparkfun.com/products/19218
+   SparkFun Qwiic Mini dToF Imager - TMF8821   https://www.sparkfun.com/products/19451
+   SparkFun Qwiic dToF Imager - TMF8821        https://www.sparkfun.com/products/19037
+
+  Repository:
+     https://github.com/sparkfun/SparkFun_Qwiic_TMF882X_Arduino_Library
+
+  Documentation:
+     https://sparkfun.github.io/SparkFun_Qwiic_TMF882X_Arduino_Library/
+
+  SparkFun code, firmware, and software is released under the MIT License(http://opensource.org/licenses/MIT).
+*/
+
+#include "SparkFun_TMF882X_Library.h"  //http://librarymanager/All#SparkFun_Qwiic_TMPF882X
+
+SparkFun_TMF882X  myTMF882X;
+
+// The binary stream encoder - writes to Serial
+SparkFun_TMF882X_Stream myStream;
+
+// Define our message callback function - results, histograms and
+// statistics are all written to the stream
+
+void onMessageCallback(struct tmf882x_msg *myMessage)
+{
+    myStream.writeMessage(myMessage);
+}
+
+void setup()
+{
+
+    delay(500);
+    Serial.begin(115200);
+
+    if(!myTMF882X.begin())
+    {
+        Serial.println("Error - The TMF882X failed to initialize - is the board connected?");
+        while(1){}
+    }
+
+    // Frames are written to Serial. Any text printed is skipped by the decoder
+    myStream.begin(Serial);
+
+    // set our call back function that handles all messages
+    myTMF882X.setMessageHandler(onMessageCallback);
+
+    struct tmf882x_mode_app_config tofConfig;
+    if (!myTMF882X.getTMF882XConfig(tofConfig)) 
+    {
+        Serial.println("Error - unable to get device configuration.");
+        while(1){}
+    }
+    
+    // Change the APP configuration
+    //  - set the reporting period to 500 milliseconds
+    //  - Enable Histogram mode
+    tofConfig.report_period_ms = 500;
+    tofConfig.histogram_dump = 1;
+
+    if (!myTMF882X.setTMF882XConfig(tofConfig)) 
+    {
+        Serial.println("Error - unable to set device configuration.");
+        while(1){}
+    }
+
+    // Start measuring - the results are delivered by service() in the loop
+    if (!myTMF882X.beginContinuous())
+    {
+        Serial.println("Error - unable to start measurements.");
+        while(1){}
+    }
+}
+
+void loop()
+{
+    myTMF882X.service();
+}
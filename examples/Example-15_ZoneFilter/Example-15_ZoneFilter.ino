@@ -0,0 +1,100 @@
+/*
+
+  Example-15_ZoneFilter.ino
+
+  This example shows how to filter the distance of each zone of the results
+  of the connected TMF882X device. A Kalman filter smooths the noise of the
+  distances, while a target that moves is followed as soon as its new distance
+  is seen on two frames in a row.
+
+  The filter runs on the results before they are passed to the measurement
+  callback function.
+
+  Supported Boards:
+
+   SparkFun Qwiic dToF Imager - TMF8820        https://www.sparkfun.com/products/19036
+   SparkFun Qwiic Mini dToF Imager - TMF8820   https://www.sparkfun.com/products/19218
+   SparkFun Qwiic Mini dToF Imager - TMF8821   https://www.sparkfun.com/products/19451
+   SparkFun Qwiic dToF Imager - TMF8821        https://www.sparkfun.com/products/19037
+
+  Repository:
+     https://github.com/sparkfun/SparkFun_Qwiic_TMF882X_Arduino_Library
+
+  Documentation:
+     https://sparkfun.github.io/SparkFun_Qwiic_TMF882X_Arduino_Library/
+
+  SparkFun code, firmware, and software is released under the MIT License(http://opensource.org/licenses/MIT).
+*/
+
+#include "SparkFun_TMF882X_Library.h"  //http://librarymanager/All#SparkFun_Qwiic_TMPF882X
+
+SparkFun_TMF882X  myTMF882X;
+
+// The filter, and a state for each zone and target. In 8x8 mode, the filter
+// needs kMaxDepthFrameCaptures times as many states.
+TMF882XZoneFilter myFilter;
+TMF882XFilterZone myZones[kFilterZonesPerCapture];
+
+// Define our measurement callback function - the distances are filtered
+
+void onMeasurementCallback(struct tmf882x_msg_meas_results *myResults)
+{
+    Serial.print("Result Number: "); Serial.print(myResults->result_num);
+    Serial.print(" Number of Results: "); Serial.println(myResults->num_results);
+
+    for(int i = 0; i < myResults->num_results; ++i) 
+    {
+        Serial.print("    conf: "); Serial.print(myResults->results[i].confidence);
+        Serial.print(" distance mm: "); Serial.print(myResults->results[i].distance_mm);
+        Serial.print(" channel: "); Serial.print(myResults->results[i].channel);
+        Serial.print(" sub_capture: "); Serial.println(myResults->results[i].sub_capture);  
+    }
+    Serial.println();
+}
+
+void setup()
+{
+
+    delay(500);
+    Serial.begin(115200);
+    Serial.println("");
+
+    if(!myTMF882X.begin())
+    {
+        Serial.println("Error - The TMF882X failed to initialize - is the board connected?");
+        while(1){}
+    }
+
+    // Setup the filter
+    //  - Kalman filter - the distance changes by ~10 mm each frame, and the
+    //    measured distance has a noise of ~30 mm
+    //  - Only use distances with a confidence of at least 100
+    //  - Follow a target that moves by more than 250 mm
+    if (!myFilter.begin(myZones, kFilterZonesPerCapture) || !myFilter.setKalman(100, 900))
+    {
+        Serial.println("Error - unable to setup the filter.");
+        while(1){}
+    }
+    myFilter.setMinConfidence(100);
+    myFilter.setJumpReset(250);
+
+    myTMF882X.setFilter(&myFilter);
+
+    // set our callback function in the library.
+    myTMF882X.setMeasurementHandler(onMeasurementCallback);
+
+    // Set our delay between samples - 100 milliseconds
+    myTMF882X.setSampleDelay(100);
+
+    // Start measuring - the results are delivered by service() in the loop
+    if (!myTMF882X.beginContinuous())
+    {
+        Serial.println("Error - unable to start measurements.");
+        while(1){}
+    }
+}
+
+void loop()
+{
+    myTMF882X.service();
+}
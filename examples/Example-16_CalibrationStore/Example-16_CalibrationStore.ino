@@ -0,0 +1,92 @@
+/*
+
+  Example-16_CalibrationStore.ino
+
+  This example shows how to keep the factory calibration of the connected
+  TMF882X device in the EEPROM of the board. The calibration is keyed by the
+  unique ID of the device - when begin() is called, the calibration kept for
+  the device is set on it. The first time a device is seen, a factory
+  calibration is run and saved to the EEPROM.
+
+  Run the first boot of a device with no target within 40 cm of the sensor,
+  and in a dark setting - see the TMF882X datasheet.
+
+  Supported Boards:
+
+   SparkFun Qwiic dToF Imager - TMF8820        https://www.sparkfun.com/products/19036
+   SparkFun Qwiic Mini dToF Imager - TMF8820   https://www.sparkfun.com/products/19218
+   SparkFun Qwiic Mini dToF Imager - TMF8821   https://www.sparkfun.com/products/19451
+   SparkFun Qwiic dToF Imager - TMF8821        https://www.sparkfun.com/products/19037
+
+  Repository:
+     https://github.com/sparkfun/SparkFun_Qwiic_TMF882X_Arduino_Library
+
+  Documentation:
+     https://sparkfun.github.io/SparkFun_Qwiic_TMF882X_Arduino_Library/
+
+  SparkFun code, firmware, and software is released under the MIT License(http://opensource.org/licenses/MIT).
+*/
+
+#include "SparkFun_TMF882X_Library.h"  //http://librarymanager/All#SparkFun_Qwiic_TMPF882X
+
+#ifndef SFE_TMF882X_HAS_EEPROM
+#error "This example needs a board with an EEPROM library - AVR, ESP32, ESP8266 or RP2040"
+#endif
+
+SparkFun_TMF882X  myTMF882X;
+
+// The calibration store - the first 1024 bytes of the EEPROM hold the
+// calibrations of 4 devices.
+SparkFun_TMF882X_CalibrationEEPROM myCalStore;
+
+static struct tmf882x_msg_meas_results myResults;
+
+void setup()
+{
+
+    delay(1000);
+    Serial.begin(115200);
+    Serial.println("");
+
+    if (!myCalStore.begin(0, 1024))
+    {
+        Serial.println("Error - unable to setup the calibration store.");
+        while(1){}
+    }
+
+    // Set the store before begin() - begin() restores the calibration
+    myTMF882X.setCalibrationStore(&myCalStore);
+
+    if(!myTMF882X.begin())
+    {
+        Serial.println("Error - The TMF882X failed to initialize - is the board connected?");
+        while(1){}
+    }else
+        Serial.println("TMF882X started - calibration set.");
+
+    struct tmf882x_mode_app_dev_UID devUID;
+
+    if (myTMF882X.getDeviceUniqueID(devUID))
+    {
+        Serial.print("Device UID: ");
+        Serial.println(devUID.uid);
+    }
+    Serial.println();
+}
+
+void loop()
+{
+    delay(1000);
+
+    // get a Measurement
+    if(myTMF882X.startMeasuring(myResults))
+    {
+        for (int i = 0; i < myResults.num_results; ++i)
+        {
+            Serial.print("    conf: "); Serial.print(myResults.results[i].confidence);
+            Serial.print(" distance mm: "); Serial.print(myResults.results[i].distance_mm);
+            Serial.print(" channel: "); Serial.println(myResults.results[i].channel);
+        }
+        Serial.println();
+    }
+}
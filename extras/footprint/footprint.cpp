@@ -0,0 +1,74 @@
+// footprint.cpp
+//
+// This is a library written for SparkFun Qwiic TMF882X boards
+//
+// SparkFun sells these bpards at its website: www.sparkfun.com
+//
+// Do you like this library? Help support SparkFun. Buy a board!
+//
+//  SparkFun Qwiic dToF Imager - TMF8820        https://www.sparkfun.com/products/19036
+//  SparkFun Qwiic Mini dToF Imager - TMF8820   https://www.sparkfun.com/products/19218
+//  SparkFun Qwiic Mini dToF Imager - TMF8821   https://www.sparkfun.com/products/19451
+//  SparkFun Qwiic dToF Imager - TMF8821        https://www.sparkfun.com/products/19037
+//
+// Written by Kirk Benell @ SparkFun Electronics, April 2022
+//
+// This library provides an abstract interface to the underlying TMF882X
+// SDK that is provided by AMS.
+//
+// Repository:
+//     https://github.com/sparkfun/SparkFun_Qwiic_TMF882X_Arduino_Library
+//
+//
+// SparkFun code, firmware, and software is released under the MIT
+// License(http://opensource.org/licenses/MIT).
+//
+// SPDX-License-Identifier: MIT
+//
+//    The MIT License (MIT)
+//
+//    Copyright (c) 2022 SparkFun Electronics
+//    Permission is hereby granted, free of charge, to any person obtaining a
+//    copy of this software and associated documentation files (the "Software"),
+//    to deal in the Software without restriction, including without limitation
+//    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//    and/or sell copies of the Software, and to permit persons to whom the
+//    Software is furnished to do so, subject to the following conditions: The
+//    above copyright notice and this permission notice shall be included in all
+//    copies or substantial portions of the Software. THE SOFTWARE IS PROVIDED
+//    "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+//    NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+//    PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+//    ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+//    CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+// Footprint probe - compiled once for each memory profile by footprint.sh.
+//
+// The size of each item is captured as the size of a global array, so the sizes
+// are read from the object file with nm. This works with a cross compiler, without
+// running anything on the target.
+
+#include "qwiic_tmf882x.h"
+
+// Library device object - includes the SDK context
+uint8_t fp_device[sizeof(QwDevTMF882X)];
+
+// SDK context of a device
+uint8_t fp_sdk_context[sizeof(tmf882x_tof)];
+
+// SDK i2c message buffer - within the SDK context
+uint8_t fp_i2c_msg[sizeof(struct tmf882x_mode_app_i2c_msg)];
+
+// SDK output message slots - within the SDK context, one of each type
+#define fp_app_size(member) sizeof(((struct tmf882x_mode_app *)0)->volat_data.member)
+
+uint8_t fp_output_msg[fp_app_size(result_msg) + fp_app_size(err_msg)
+#ifndef CONFIG_TMF882X_NO_STATS_SUPPORT
+                      + fp_app_size(stats_msg)
+#endif
+#ifndef CONFIG_TMF882X_NO_HISTOGRAM_SUPPORT
+                      + fp_app_size(hist_msg)
+#endif
+];
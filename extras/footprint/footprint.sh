@@ -0,0 +1,75 @@
+#!/bin/sh
+#
+# footprint.sh
+#
+# Report the RAM and flash use of the TMF882X library for each memory profile.
+# See src/inc/tmf882x_profile.h for a description of the profiles.
+#
+# Usage:
+#    ./footprint.sh
+#
+# To report for a target, set CROSS to the prefix of the cross compiler:
+#
+#    CROSS=arm-none-eabi- CFLAGS="-mcpu=cortex-m4 -mthumb" ./footprint.sh
+#
+# RAM is per device. Flash is the code and constant data of the library and SDK
+# object files - the firmware image (tof_bin_image.c) is reported on its own.
+
+CROSS=${CROSS:-}
+CC=${CROSS}gcc
+CXX=${CROSS}g++
+NM=${CROSS}nm
+SIZE=${CROSS}size
+
+CFLAGS="${CFLAGS:-} -Os -ffunction-sections -fdata-sections -fno-common"
+
+HERE=$(cd "$(dirname "$0")" && pwd)
+SRC="$HERE/../../src"
+BUILD=$(mktemp -d)
+trap 'rm -rf "$BUILD"' EXIT
+
+# Library and SDK files - the Arduino and Linux bus/platform files, and the
+# simulator, depend on the host, and aren't included.
+C_FILES="tmf882x_interface.c tmf882x_mode.c tmf882x_mode_app.c tmf882x_mode_bl.c
+         tmf882x_clock_correction.c tmf882x_hist_unpack.c tmf882x_result_unpack.c intel_hex_interpreter.c"
+CXX_FILES="qwiic_tmf882x.cpp qwiic_tmf882x_zones.cpp qwiic_tmf882x_array.cpp qwiic_tmf882x_stream.cpp qwiic_tmf882x_filter.cpp qwiic_tmf882x_governor.cpp qwiic_tmf882x_calibration.cpp sfe_shim.cpp"
+
+# symbolSize <object> <symbol> - size of a symbol, in bytes
+symbolSize()
+{
+    printf "%d" 0x$($NM -S "$1" | awk -v sym="$2" '$4 == sym { print $2 }')
+}
+
+# textSize <objects...> - code and constant data
+textSize()
+{
+    $SIZE "$@" | awk 'NR > 1 { total += $1 } END { print total }'
+}
+
+# Firmware image - the same for each profile
+$CC $CFLAGS -I"$SRC" -I"$SRC/inc" -c "$SRC/tof_bin_image.c" -o "$BUILD/fw.o" || exit 1
+
+echo "| Profile | Device RAM | SDK context | i2c buffer | Output messages | Flash |"
+echo "| :--- | ---: | ---: | ---: | ---: | ---: |"
+
+for profile in FULL RESULTS_STATS RESULTS; do
+    DEFS="-DTMF882X_MEMORY_PROFILE=TMF882X_PROFILE_$profile"
+    OUT="$BUILD/$profile"
+    mkdir -p "$OUT"
+
+    for f in $C_FILES; do
+        $CC $CFLAGS $DEFS -I"$SRC" -I"$SRC/inc" -c "$SRC/$f" -o "$OUT/$f.o" || exit 1
+    done
+    for f in $CXX_FILES; do
+        $CXX $CFLAGS $DEFS -I"$SRC" -I"$SRC/inc" -c "$SRC/$f" -o "$OUT/$f.o" || exit 1
+    done
+    $CXX $CFLAGS $DEFS -I"$SRC" -I"$SRC/inc" -c "$HERE/footprint.cpp" -o "$BUILD/probe_$profile.o" || exit 1
+
+    PROBE="$BUILD/probe_$profile.o"
+
+    echo "| $profile | $(symbolSize $PROBE fp_device) | $(symbolSize $PROBE fp_sdk_context) |" \
+         "$(symbolSize $PROBE fp_i2c_msg) | $(symbolSize $PROBE fp_output_msg) | $(textSize "$OUT"/*.o) |"
+done
+
+echo
+echo "Firmware image: $(textSize "$BUILD/fw.o") bytes of flash"
@@ -0,0 +1,199 @@
+// governor_check.cpp
+//
+// This is a library written for SparkFun Qwiic TMF882X boards
+//
+// SparkFun sells these bpards at its website: www.sparkfun.com
+//
+// Do you like this library? Help support SparkFun. Buy a board!
+//
+//  SparkFun Qwiic dToF Imager - TMF8820        https://www.sparkfun.com/products/19036
+//  SparkFun Qwiic Mini dToF Imager - TMF8820   https://www.sparkfun.com/products/19218
+//  SparkFun Qwiic Mini dToF Imager - TMF8821   https://www.sparkfun.com/products/19451
+//  SparkFun Qwiic dToF Imager - TMF8821        https://www.sparkfun.com/products/19037
+//
+// Written by Kirk Benell @ SparkFun Electronics, April 2022
+//
+// This library provides an abstract interface to the underlying TMF882X
+// SDK that is provided by AMS.
+//
+// Repository:
+//     https://github.com/sparkfun/SparkFun_Qwiic_TMF882X_Arduino_Library
+//
+//
+// SparkFun code, firmware, and software is released under the MIT
+// License(http://opensource.org/licenses/MIT).
+//
+// SPDX-License-Identifier: MIT
+//
+//    The MIT License (MIT)
+//
+//    Copyright (c) 2022 SparkFun Electronics
+//    Permission is hereby granted, free of charge, to any person obtaining a
+//    copy of this software and associated documentation files (the "Software"),
+//    to deal in the Software without restriction, including without limitation
+//    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//    and/or sell copies of the Software, and to permit persons to whom the
+//    Software is furnished to do so, subject to the following conditions: The
+//    above copyright notice and this permission notice shall be included in all
+//    copies or substantial portions of the Software. THE SOFTWARE IS PROVIDED
+//    "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+//    NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+//    PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+//    ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+//    CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+// Frame rate governor check - built and run on the host by governor_check.sh.
+//
+// Feeds TMF882XGovernor frames of known confidence, ambient light and photon
+// count, and checks when it steps, and the config it sets:
+//
+//    weak frames               step up after the up hold frames
+//    strong frames             step down after the down hold frames
+//    ambient over the limit    not strong - no step down
+//    photons under the limit   not strong - no step down
+//    iteration limits          steps stop at the limits
+
+#include <stdio.h>
+#include <string.h>
+
+#include "qwiic_tmf882x_governor.h"
+
+static int nFailed = 0;
+
+#define CHECK(cond, what)                                                                                              \
+    do                                                                                                                 \
+    {                                                                                                                  \
+        bool ok = (cond);                                                                                              \
+        printf("%-48s %s\n", what, ok ? "ok" : "FAILED");                                                              \
+        if (!ok)                                                                                                       \
+            nFailed++;                                                                                                 \
+    } while (0)
+
+//////////////////////////////////////////////////////////////////////////////
+// Fill one capture - every zone with one target of a confidence
+
+static void makeResults(struct tmf882x_msg_meas_results &results, uint8_t confidence, uint32_t ambient,
+                        uint32_t photons)
+{
+    memset(&results, 0, sizeof(results));
+
+    results.num_results = 9;
+    results.ambient_light = ambient;
+    results.photon_count = photons;
+
+    for (uint32_t i = 0; i < results.num_results; i++)
+    {
+        results.results[i].confidence = confidence;
+        results.results[i].distance_mm = 500;
+        results.results[i].channel = i + 1;
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// Feed frames of one capture - returns the frame a step is due on, 0 if none
+
+static uint32_t feed(TMF882XGovernor &governor, uint32_t nFrames, uint8_t confidence, uint32_t ambient,
+                     uint32_t photons)
+{
+    struct tmf882x_msg_meas_results results;
+
+    makeResults(results, confidence, ambient, photons);
+
+    for (uint32_t i = 1; i <= nFrames; i++)
+    {
+        if (governor.update(&results, true))
+            return i;
+    }
+    return 0;
+}
+
+int main(void)
+{
+    struct tmf882x_mode_app_config config;
+    TMF882XGovernorStats stats;
+
+    memset(&config, 0, sizeof(config));
+
+    // weak frames step up
+    {
+        TMF882XGovernor governor;
+        config.kilo_iterations = 256;
+
+        CHECK(feed(governor, 20, 50, 0, 0) == kGovernorDefaultUpFrames, "weak frames step up after the hold");
+        CHECK(governor.adjust(config) && config.kilo_iterations == 256 + 256 / kGovernorStepDivisor,
+              "step up adds a quarter of the iterations");
+        governor.getStats(stats);
+        CHECK(stats.stepsUp == 1 && stats.kiloIterations == config.kilo_iterations, "step up is counted");
+    }
+
+    // strong frames step down
+    {
+        TMF882XGovernor governor;
+        config.kilo_iterations = 256;
+
+        CHECK(feed(governor, 20, 250, 0, 0) == kGovernorDefaultDownFrames, "strong frames step down after the hold");
+        CHECK(governor.adjust(config) && config.kilo_iterations == 256 - 256 / kGovernorStepDivisor,
+              "step down takes a quarter of the iterations");
+    }
+
+    // the ambient limit keeps bright frames from being strong
+    {
+        TMF882XGovernor governor;
+        struct tmf882x_msg_meas_results results;
+
+        governor.setAmbientLimit(1);
+        makeResults(results, 250, 100000, 0);
+
+        CHECK(!governor.update(&results, true), "frame over the ambient limit is no step");
+        CHECK(feed(governor, 20, 250, 100000, 0) == 0, "frames over the ambient limit never step down");
+        CHECK(feed(governor, 20, 250, 1, 0) == kGovernorDefaultDownFrames, "frames within the ambient limit step");
+    }
+
+    // the ambient limit is the most ambient light of the captures of a frame
+    {
+        TMF882XGovernor governor;
+        struct tmf882x_msg_meas_results dark, bright;
+
+        governor.setAmbientLimit(1000);
+        makeResults(dark, 250, 10, 0);
+        makeResults(bright, 250, 5000, 0);
+
+        bool stepped = false;
+        for (int i = 0; i < 20; i++)
+        {
+            stepped |= governor.update(&bright, false);
+            stepped |= governor.update(&dark, true);
+        }
+        CHECK(!stepped, "a bright capture makes the frame bright");
+    }
+
+    // photons under the limit - not enough margin to drop iterations
+    {
+        TMF882XGovernor governor;
+
+        governor.setPhotonLimit(1000);
+        CHECK(feed(governor, 20, 250, 0, 1000) == 0, "frames without photon margin never step down");
+        CHECK(feed(governor, 20, 250, 0, 2000) == kGovernorDefaultDownFrames, "frames with photon margin step");
+    }
+
+    // steps stop at the iteration limits
+    {
+        TMF882XGovernor governor;
+
+        config.kilo_iterations = kGovernorDefaultMaxKiloIterations;
+        feed(governor, 20, 50, 0, 0);
+        CHECK(!governor.adjust(config) || config.kilo_iterations == kGovernorDefaultMaxKiloIterations,
+              "step up stops at the most iterations");
+
+        config.kilo_iterations = kGovernorDefaultMinKiloIterations;
+        feed(governor, 20, 250, 0, 0);
+        governor.adjust(config);
+        CHECK(config.kilo_iterations == kGovernorDefaultMinKiloIterations, "step down stops at the fewest iterations");
+    }
+
+    printf("\n%s\n", nFailed ? "FAILED" : "All checks passed");
+
+    return nFailed ? 1 : 0;
+}
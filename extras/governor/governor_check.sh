@@ -0,0 +1,24 @@
+#!/bin/sh
+#
+# governor_check.sh
+#
+# Check the frame rate governor on the host - when it steps, and the config it
+# sets. See governor_check.cpp
+#
+# Usage:
+#    ./governor_check.sh
+#
+# Returns non-zero if a check fails.
+
+CXX=${CXX:-g++}
+CFLAGS="${CFLAGS:--O2}"
+
+HERE=$(cd "$(dirname "$0")" && pwd)
+SRC="$HERE/../../src"
+BUILD=$(mktemp -d)
+trap 'rm -rf "$BUILD"' EXIT
+
+$CXX $CFLAGS -I"$SRC" -I"$SRC/inc" "$HERE/governor_check.cpp" "$SRC/qwiic_tmf882x_governor.cpp" \
+    -o "$BUILD/governor_check" || exit 1
+
+"$BUILD/governor_check"
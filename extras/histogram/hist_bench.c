@@ -0,0 +1,177 @@
+// hist_bench.c
+//
+// This is a library written for SparkFun Qwiic TMF882X boards
+//
+// SparkFun sells these bpards at its website: www.sparkfun.com
+//
+// Do you like this library? Help support SparkFun. Buy a board!
+//
+//  SparkFun Qwiic dToF Imager - TMF8820        https://www.sparkfun.com/products/19036
+//  SparkFun Qwiic Mini dToF Imager - TMF8820   https://www.sparkfun.com/products/19218
+//  SparkFun Qwiic Mini dToF Imager - TMF8821   https://www.sparkfun.com/products/19451
+//  SparkFun Qwiic dToF Imager - TMF8821        https://www.sparkfun.com/products/19037
+//
+// Written by Kirk Benell @ SparkFun Electronics, April 2022
+//
+// This library provides an abstract interface to the underlying TMF882X
+// SDK that is provided by AMS.
+//
+// Repository:
+//     https://github.com/sparkfun/SparkFun_Qwiic_TMF882X_Arduino_Library
+//
+//
+// SparkFun code, firmware, and software is released under the MIT
+// License(http://opensource.org/licenses/MIT).
+//
+// SPDX-License-Identifier: MIT
+//
+//    The MIT License (MIT)
+//
+//    Copyright (c) 2022 SparkFun Electronics
+//    Permission is hereby granted, free of charge, to any person obtaining a
+//    copy of this software and associated documentation files (the "Software"),
+//    to deal in the Software without restriction, including without limitation
+//    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//    and/or sell copies of the Software, and to permit persons to whom the
+//    Software is furnished to do so, subject to the following conditions: The
+//    above copyright notice and this permission notice shall be included in all
+//    copies or substantial portions of the Software. THE SOFTWARE IS PROVIDED
+//    "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+//    NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+//    PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+//    ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+//    CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Histogram unpack check and benchmark - built and run on the host by
+// hist_bench.sh.
+//
+// Each kernel in src/tmf882x_hist_unpack.c is checked, bit for bit, against
+// the original decoder of the SDK - a cleared message, and a loop that ORs each
+// byte of a bin into place. The check covers random, all zero and all one data,
+// unaligned input and bin counts that aren't a multiple of four. The kernels
+// are then timed against the original decoder.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "inc/tmf882x.h"
+#include "inc/tmf882x_hist_unpack.h"
+
+#define kBytesPerBin 3
+#define kNumBins (TMF882X_HIST_NUM_TDC * TMF882X_HIST_NUM_BINS)
+#define kIterations 20000
+
+typedef void (*unpack_fn)(uint32_t *bins, const uint8_t *data, uint32_t num_bins);
+
+// The original decoder - bins of each TDC, byte planes of all TDCs
+static void unpack_reference(uint32_t *bins, const uint8_t *data, uint32_t num_bins)
+{
+    memset(bins, 0, num_bins * sizeof(uint32_t));
+
+    for (uint32_t byte_idx = 0; byte_idx < kBytesPerBin; ++byte_idx)
+    {
+        for (uint32_t bin_idx = 0; bin_idx < num_bins; ++bin_idx)
+            bins[bin_idx] |= (data[byte_idx * num_bins + bin_idx] << (8 * byte_idx));
+    }
+}
+
+static void unpack_default(uint32_t *bins, const uint8_t *data, uint32_t num_bins)
+{
+    tmf882x_hist_unpack24(bins, data, num_bins);
+}
+
+static const struct
+{
+    const char *name;
+    unpack_fn fn;
+} kKernels[] = {
+    {"reference", unpack_reference},
+    {"bytes", tmf882x_hist_unpack24_bytes},
+    {"words", tmf882x_hist_unpack24_words},
+    {"default", unpack_default},
+};
+
+#define kNumKernels (sizeof(kKernels) / sizeof(kKernels[0]))
+
+static uint8_t data[kNumBins * kBytesPerBin + 8];
+static uint32_t expected[kNumBins];
+static uint32_t bins[kNumBins + 1];
+
+static double nowSecs(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Check each kernel against the reference, for a fill pattern, an input offset and a bin count
+static int check(int pattern, uint32_t offset, uint32_t num_bins)
+{
+    uint8_t *input = data + offset;
+    int failed = 0;
+
+    for (uint32_t i = 0; i < num_bins * kBytesPerBin; i++)
+        input[i] = pattern == 0 ? 0 : pattern == 1 ? 0xFF : (uint8_t)rand();
+
+    unpack_reference(expected, input, num_bins);
+
+    for (uint32_t k = 1; k < kNumKernels; k++)
+    {
+        // poison the output - and check the bin past the end isn't written
+        memset(bins, 0xA5, sizeof(bins));
+        kKernels[k].fn(bins, input, num_bins);
+
+        if (memcmp(bins, expected, num_bins * sizeof(uint32_t)) || bins[num_bins] != 0xA5A5A5A5)
+        {
+            printf("FAIL: %s - pattern %d, offset %u, %u bins\n", kKernels[k].name, pattern, offset, num_bins);
+            failed++;
+        }
+    }
+    return failed;
+}
+
+int main(void)
+{
+    static const uint32_t kBinCounts[] = {kNumBins, TMF882X_HIST_NUM_BINS, 1, 3, 5, 7, 255};
+    int failed = 0;
+    int checks = 0;
+
+    srand(882);
+
+    for (int pattern = 0; pattern < 3; pattern++)
+    {
+        for (uint32_t offset = 0; offset < 4; offset++)
+        {
+            for (uint32_t n = 0; n < sizeof(kBinCounts) / sizeof(kBinCounts[0]); n++)
+            {
+                failed += check(pattern, offset, kBinCounts[n]);
+                checks++;
+            }
+        }
+    }
+    printf("Checks: %d, failed: %d\n\n", checks * (int)(kNumKernels - 1), failed);
+
+    printf("| Kernel | ns per histogram | ns per bin |\n");
+    printf("| :--- | ---: | ---: |\n");
+
+    for (uint32_t k = 0; k < kNumKernels; k++)
+    {
+        double start = nowSecs();
+
+        for (int i = 0; i < kIterations; i++)
+        {
+            kKernels[k].fn(bins, data, kNumBins);
+            // keep the compiler from dropping the unused results
+            __asm__ __volatile__("" : : "r"(bins) : "memory");
+        }
+
+        double ns = (nowSecs() - start) * 1e9 / kIterations;
+        printf("| %s | %.0f | %.2f |\n", kKernels[k].name, ns, ns / kNumBins);
+    }
+
+    return failed ? 1 : 0;
+}
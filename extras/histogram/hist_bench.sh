@@ -0,0 +1,27 @@
+#!/bin/sh
+#
+# hist_bench.sh
+#
+# Check the histogram unpack kernels of the SDK against the original decoder,
+# bit for bit, and time them. See hist_bench.c
+#
+# Usage:
+#    ./hist_bench.sh
+#
+# Set CFLAGS to try other compiler options - the default is -O2.
+#
+#    CFLAGS="-O3 -march=native" ./hist_bench.sh
+#
+# Returns non-zero if a check fails.
+
+CC=${CC:-gcc}
+CFLAGS="${CFLAGS:--O2}"
+
+HERE=$(cd "$(dirname "$0")" && pwd)
+SRC="$HERE/../../src"
+BUILD=$(mktemp -d)
+trap 'rm -rf "$BUILD"' EXIT
+
+$CC $CFLAGS -I"$SRC" -I"$SRC/inc" "$HERE/hist_bench.c" "$SRC/tmf882x_hist_unpack.c" -o "$BUILD/hist_bench" || exit 1
+
+"$BUILD/hist_bench"
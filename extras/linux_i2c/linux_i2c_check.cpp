@@ -0,0 +1,231 @@
+// linux_i2c_check.cpp
+//
+// This is a library written for SparkFun Qwiic TMF882X boards
+//
+// SparkFun sells these bpards at its website: www.sparkfun.com
+//
+// Do you like this library? Help support SparkFun. Buy a board!
+//
+//  SparkFun Qwiic dToF Imager - TMF8820        https://www.sparkfun.com/products/19036
+//  SparkFun Qwiic Mini dToF Imager - TMF8820   https://www.sparkfun.com/products/19218
+//  SparkFun Qwiic Mini dToF Imager - TMF8821   https://www.sparkfun.com/products/19451
+//  SparkFun Qwiic dToF Imager - TMF8821        https://www.sparkfun.com/products/19037
+//
+// Written by Kirk Benell @ SparkFun Electronics, April 2022
+//
+// This library provides an abstract interface to the underlying TMF882X
+// SDK that is provided by AMS.
+//
+// Repository:
+//     https://github.com/sparkfun/SparkFun_Qwiic_TMF882X_Arduino_Library
+//
+//
+// SparkFun code, firmware, and software is released under the MIT
+// License(http://opensource.org/licenses/MIT).
+//
+// SPDX-License-Identifier: MIT
+//
+//    The MIT License (MIT)
+//
+//    Copyright (c) 2022 SparkFun Electronics
+//    Permission is hereby granted, free of charge, to any person obtaining a
+//    copy of this software and associated documentation files (the "Software"),
+//    to deal in the Software without restriction, including without limitation
+//    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//    and/or sell copies of the Software, and to permit persons to whom the
+//    Software is furnished to do so, subject to the following conditions: The
+//    above copyright notice and this permission notice shall be included in all
+//    copies or substantial portions of the Software. THE SOFTWARE IS PROVIDED
+//    "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+//    NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+//    PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+//    ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+//    CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+// Linux i2c-dev bus check - built and run on the host by linux_i2c_check.sh.
+// No I2C hardware is needed.
+//
+// QwLinuxI2C is run against a loopback fake - a subclass that overrides
+// transfer() with a register file - and checks the messages it is sent:
+//
+//    register read     two messages, a write of the register then an I2C_M_RD
+//                      read, in one transfer
+//    register write    one message, the register then the data
+//    long writes       over kMaxLinuxI2CWrite bytes are rejected, not sent
+//
+// The default transfer() is then checked to issue a read as one I2C_RDWR call,
+// by linking the check with its own ioctl().
+
+#include <fcntl.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <linux/i2c-dev.h>
+
+#include "qwiic_linux_i2c.h"
+
+using namespace sfe_TMF882X;
+
+#define kFakeAddress 0x41
+
+static int nFailed = 0;
+
+#define CHECK(cond, what)                                                                                              \
+    do                                                                                                                 \
+    {                                                                                                                  \
+        bool ok = (cond);                                                                                              \
+        printf("%-48s %s\n", what, ok ? "ok" : "FAILED");                                                              \
+        if (!ok)                                                                                                       \
+            nFailed++;                                                                                                 \
+    } while (0)
+
+//////////////////////////////////////////////////////////////////////////////
+// Loopback fake - a device with a 256 byte register file. Records the
+// messages of the last transfer.
+
+class LoopbackI2C : public QwLinuxI2C
+{
+  public:
+    LoopbackI2C(void) : nTransfers{0}, nMsgs{0}
+    {
+        memset(regs, 0, sizeof(regs));
+        memset(flags, 0, sizeof(flags));
+        memset(lengths, 0, sizeof(lengths));
+    }
+
+    uint8_t regs[256];
+    uint32_t nTransfers;
+    uint32_t nMsgs;
+    uint16_t flags[2];
+    uint16_t lengths[2];
+
+  protected:
+    int transfer(struct i2c_msg *msgs, uint32_t n)
+    {
+        uint8_t reg = 0;
+
+        nTransfers++;
+        nMsgs = n;
+
+        for (uint32_t i = 0; i < n; i++)
+        {
+            if (i < 2)
+            {
+                flags[i] = msgs[i].flags;
+                lengths[i] = msgs[i].len;
+            }
+
+            if (msgs[i].addr != kFakeAddress)
+                return -1;
+
+            // a write sets the register, then writes the data after it
+            if (!(msgs[i].flags & I2C_M_RD))
+            {
+                reg = msgs[i].buf[0];
+                for (uint16_t k = 1; k < msgs[i].len; k++)
+                    regs[(uint8_t)(reg + k - 1)] = msgs[i].buf[k];
+            }
+            else
+            {
+                for (uint16_t k = 0; k < msgs[i].len; k++)
+                    msgs[i].buf[k] = regs[(uint8_t)(reg + k)];
+            }
+        }
+        return 0;
+    }
+};
+
+//////////////////////////////////////////////////////////////////////////////
+// ioctl() of the check - counts the I2C_RDWR calls of the default transfer()
+
+static uint32_t nRdwrCalls = 0;
+static uint32_t rdwrMsgs = 0;
+static uint16_t rdwrFlags[2];
+
+extern "C" int ioctl(int fd, unsigned long request, ...)
+{
+    (void)fd;
+
+    if (request != I2C_RDWR)
+        return -1;
+
+    va_list args;
+    va_start(args, request);
+    struct i2c_rdwr_ioctl_data *xfer = va_arg(args, struct i2c_rdwr_ioctl_data *);
+    va_end(args);
+
+    nRdwrCalls++;
+    rdwrMsgs = xfer->nmsgs;
+
+    for (uint32_t i = 0; i < xfer->nmsgs && i < 2; i++)
+        rdwrFlags[i] = xfer->msgs[i].flags;
+
+    return (int)xfer->nmsgs;
+}
+
+int main(void)
+{
+    uint8_t data[kMaxLinuxI2CWrite + 1];
+    uint8_t readBack[kMaxLinuxI2CWrite];
+
+    for (uint32_t i = 0; i < sizeof(data); i++)
+        data[i] = (uint8_t)(i * 3 + 1);
+
+    // the loopback fake
+    {
+        LoopbackI2C bus;
+
+        bus.init(0); // any open descriptor - the fake doesn't use it
+
+        bus.nTransfers = 0;
+        CHECK(bus.writeRegisterRegion(kFakeAddress, 0x20, data, 16) == 0, "register write succeeds");
+        CHECK(bus.nTransfers == 1 && bus.nMsgs == 1 && !(bus.flags[0] & I2C_M_RD) && bus.lengths[0] == 17,
+              "write is one message - register and data");
+
+        bus.nTransfers = 0;
+        memset(readBack, 0, sizeof(readBack));
+        CHECK(bus.readRegisterRegion(kFakeAddress, 0x20, readBack, 16) == 0, "register read succeeds");
+        CHECK(bus.nTransfers == 1 && bus.nMsgs == 2, "read is two messages in one transfer");
+        CHECK(!(bus.flags[0] & I2C_M_RD) && bus.lengths[0] == 1, "first message writes the register");
+        CHECK((bus.flags[1] & I2C_M_RD) && bus.lengths[1] == 16, "second message is an I2C_M_RD read");
+        CHECK(!memcmp(readBack, data, 16), "read returns the data written");
+
+        bus.nTransfers = 0;
+        CHECK(bus.writeRegisterRegion(kFakeAddress, 0, data, kMaxLinuxI2CWrite) == 0,
+              "write of kMaxLinuxI2CWrite bytes succeeds");
+        CHECK(bus.writeRegisterRegion(kFakeAddress, 0, data, kMaxLinuxI2CWrite + 1) != 0,
+              "write over kMaxLinuxI2CWrite is rejected");
+        CHECK(bus.nTransfers == 1, "rejected write isn't sent");
+
+        CHECK(bus.ping(kFakeAddress) && !bus.ping(kFakeAddress + 1), "ping finds the device");
+    }
+
+    // the default transfer() - one I2C_RDWR call
+    {
+        QwLinuxI2C bus;
+        int fd = open("/dev/null", O_RDWR);
+
+        bus.init(fd);
+
+        nRdwrCalls = 0;
+        CHECK(bus.readRegisterRegion(kFakeAddress, 0x20, readBack, 16) == 0, "read through ioctl succeeds");
+        CHECK(nRdwrCalls == 1 && rdwrMsgs == 2, "read is one I2C_RDWR call of two messages");
+        CHECK(!(rdwrFlags[0] & I2C_M_RD) && (rdwrFlags[1] & I2C_M_RD), "write, then I2C_M_RD read");
+
+        nRdwrCalls = 0;
+        CHECK(bus.writeRegisterRegion(kFakeAddress, 0, data, kMaxLinuxI2CWrite + 1) != 0 && !nRdwrCalls,
+              "write over kMaxLinuxI2CWrite makes no call");
+
+        bus.close();
+        CHECK(fcntl(fd, F_GETFD) != -1, "descriptor of the caller is left open");
+        close(fd);
+    }
+
+    printf("\n%s\n", nFailed ? "FAILED" : "All checks passed");
+
+    return nFailed ? 1 : 0;
+}
@@ -0,0 +1,24 @@
+#!/bin/sh
+#
+# linux_i2c_check.sh
+#
+# Check the Linux i2c-dev bus object on the host, against a loopback fake - no
+# I2C hardware is needed. See linux_i2c_check.cpp
+#
+# Usage:
+#    ./linux_i2c_check.sh
+#
+# Returns non-zero if a check fails.
+
+CXX=${CXX:-g++}
+CFLAGS="${CFLAGS:--O2}"
+
+HERE=$(cd "$(dirname "$0")" && pwd)
+SRC="$HERE/../../src"
+BUILD=$(mktemp -d)
+trap 'rm -rf "$BUILD"' EXIT
+
+$CXX $CFLAGS -I"$SRC" -I"$SRC/inc" "$HERE/linux_i2c_check.cpp" "$SRC/qwiic_linux_i2c.cpp" \
+    -o "$BUILD/linux_i2c_check" || exit 1
+
+"$BUILD/linux_i2c_check"
@@ -0,0 +1,234 @@
+// replay.cpp
+//
+// This is a library written for SparkFun Qwiic TMF882X boards
+//
+// SparkFun sells these bpards at its website: www.sparkfun.com
+//
+// Do you like this library? Help support SparkFun. Buy a board!
+//
+//  SparkFun Qwiic dToF Imager - TMF8820        https://www.sparkfun.com/products/19036
+//  SparkFun Qwiic Mini dToF Imager - TMF8820   https://www.sparkfun.com/products/19218
+//  SparkFun Qwiic Mini dToF Imager - TMF8821   https://www.sparkfun.com/products/19451
+//  SparkFun Qwiic dToF Imager - TMF8821        https://www.sparkfun.com/products/19037
+//
+// Written by Kirk Benell @ SparkFun Electronics, April 2022
+//
+// This library provides an abstract interface to the underlying TMF882X
+// SDK that is provided by AMS.
+//
+// Repository:
+//     https://github.com/sparkfun/SparkFun_Qwiic_TMF882X_Arduino_Library
+//
+//
+// SparkFun code, firmware, and software is released under the MIT
+// License(http://opensource.org/licenses/MIT).
+//
+// SPDX-License-Identifier: MIT
+//
+//    The MIT License (MIT)
+//
+//    Copyright (c) 2022 SparkFun Electronics
+//    Permission is hereby granted, free of charge, to any person obtaining a
+//    copy of this software and associated documentation files (the "Software"),
+//    to deal in the Software without restriction, including without limitation
+//    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//    and/or sell copies of the Software, and to permit persons to whom the
+//    Software is furnished to do so, subject to the following conditions: The
+//    above copyright notice and this permission notice shall be included in all
+//    copies or substantial portions of the Software. THE SOFTWARE IS PROVIDED
+//    "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+//    NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+//    PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+//    ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+//    CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+// Replay a recording of raw TMF882X messages through the library decoders -
+// built and run on the host by replay.sh.
+//
+// A recording is a binary stream (see src/qwiic_tmf882x_stream.h) of
+// kStreamI2CMessage frames, written by QwDevTMF882X::setI2CRecorder(). Each
+// message is passed to QwDevTMF882X::replayI2CMessage() as fast as possible,
+// so the decoders can be profiled and changed against a fixed input - the
+// same recording always decodes to the same output.
+//
+// The device is the simulator (src/qwiic_tmf882x_sim.h) - only its state is
+// used by the decoders, no messages are read from it. The decoded results,
+// histograms and statistics can be written to a stream file for stream2csv.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "qwiic_tmf882x.h"
+#include "qwiic_tmf882x_sim.h"
+#include "qwiic_tmf882x_stream.h"
+#include "sfe_arduino.h"
+
+using namespace sfe_TMF882X;
+
+class FileOutput : public TMF882XStreamOutput
+{
+  public:
+    FILE *file = nullptr;
+
+    bool write(const uint8_t *data, uint16_t length)
+    {
+        return fwrite(data, 1, length, file) == length;
+    }
+};
+
+static QwSimTMF882X sim;
+static QwDevTMF882X device;
+static TMF882XStreamDecoder decoder;
+static TMF882XStreamEncoder encoder;
+static FileOutput output;
+
+static uint32_t nRecords, nReplayErrors, nResults, nHistograms, nStats;
+static bool restart;
+
+static void onI2CMessage(uint32_t timeUS, const struct tmf882x_mode_app_i2c_msg *i2c_msg)
+{
+    nRecords++;
+    if (!device.replayI2CMessage(i2c_msg, timeUS, restart))
+        nReplayErrors++;
+    restart = false;
+}
+
+static void onMessage(struct tmf882x_msg *msg)
+{
+    switch (msg->hdr.msg_id)
+    {
+    case ID_MEAS_RESULTS:
+        nResults++;
+        break;
+    case ID_HISTOGRAM:
+        nHistograms++;
+        break;
+    case ID_MEAS_STATS:
+        nStats++;
+        break;
+    default:
+        return;
+    }
+
+    if (output.file)
+        encoder.writeMessage(msg);
+}
+
+static double seconds(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static int usage(void)
+{
+    fprintf(stderr, "Usage: replay [-8] [-r passes] [-o output] file\n"
+                    "  -8          decode as 8x8 (TMF8828) mode\n"
+                    "  -r passes   replay the recording this many times\n"
+                    "  -o output   write the decoded messages to a stream file\n");
+    return 2;
+}
+
+int main(int argc, char **argv)
+{
+    const char *path = nullptr;
+    const char *outPath = nullptr;
+    bool mode8x8 = false;
+    long nPasses = 1;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "-8"))
+            mode8x8 = true;
+        else if (!strcmp(argv[i], "-r") && i + 1 < argc)
+            nPasses = atol(argv[++i]);
+        else if (!strcmp(argv[i], "-o") && i + 1 < argc)
+            outPath = argv[++i];
+        else if (argv[i][0] == '-' || path)
+            return usage();
+        else
+            path = argv[i];
+    }
+
+    if (!path || nPasses < 1)
+        return usage();
+
+    // Read the whole recording, so only the decode is timed
+    FILE *input = fopen(path, "rb");
+    if (!input)
+    {
+        perror(path);
+        return 1;
+    }
+
+    fseek(input, 0, SEEK_END);
+    long size = ftell(input);
+    fseek(input, 0, SEEK_SET);
+
+    uint8_t *recording = (uint8_t *)malloc(size > 0 ? size : 1);
+    if (!recording || fread(recording, 1, size, input) != (size_t)size)
+    {
+        fprintf(stderr, "Error reading %s\n", path);
+        return 1;
+    }
+    fclose(input);
+
+    if (outPath)
+    {
+        output.file = fopen(outPath, "wb");
+        if (!output.file)
+        {
+            perror(outPath);
+            return 1;
+        }
+        encoder.setOutput(output);
+    }
+
+    // No waiting on the simulator clock
+    sfe_set_virtual_clock(true);
+
+    device.setCommunicationBus(sim, kSimTMF882XAddress);
+    if (!device.init() || (mode8x8 && !device.set8x8Mode(true)))
+    {
+        fprintf(stderr, "Error initializing the device\n");
+        return 1;
+    }
+    device.setMessageHandler(onMessage);
+
+    decoder.setI2CMessageHandler(onI2CMessage);
+
+    double start = seconds();
+
+    for (long pass = 0; pass < nPasses; pass++)
+    {
+        // each pass starts from the same state
+        restart = true;
+        decoder.reset();
+        decoder.decode(recording, size);
+    }
+
+    double elapsed = seconds() - start;
+
+    if (output.file)
+        fclose(output.file);
+    free(recording);
+
+    TMF882XStreamStats stats;
+    decoder.getStreamStats(stats);
+
+    fprintf(stderr, "records: %u, replay errors: %u, results: %u, histograms: %u, stats: %u\n", nRecords,
+            nReplayErrors, nResults, nHistograms, nStats);
+    fprintf(stderr, "frames: %u, CRC errors: %u, bad frames: %u, skipped bytes: %u\n", stats.frames, stats.crcErrors,
+            stats.badFrames, stats.skippedBytes);
+    if (elapsed > 0)
+        fprintf(stderr, "%.3f s, %.0f records/s, %.2f MB/s\n", elapsed, nRecords / elapsed,
+                (double)size * nPasses / elapsed / 1e6);
+
+    return nReplayErrors ? 1 : 0;
+}
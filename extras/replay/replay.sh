@@ -0,0 +1,35 @@
+#!/bin/sh
+#
+# replay.sh
+#
+# Build the replay tool on the host, and run it - replays a recording of raw
+# TMF882X messages (see QwDevTMF882X::setI2CRecorder()) through the library
+# decoders, and reports the throughput.
+#
+# Usage:
+#    ./replay.sh [-8] [-r passes] [-o output.bin] recording.bin
+#
+# The decoded messages written with -o can be converted with stream2csv:
+#
+#    ./replay.sh -o decoded.bin recording.bin
+#    ../stream/stream2csv.sh -t results decoded.bin > results.csv
+
+CC=${CC:-gcc}
+CXX=${CXX:-g++}
+CFLAGS=${CFLAGS:--O2}
+
+HERE=$(cd "$(dirname "$0")" && pwd)
+SRC="$HERE/../../src"
+BUILD=$(mktemp -d)
+trap 'rm -rf "$BUILD"' EXIT
+
+for f in "$SRC"/*.c; do
+    $CC $CFLAGS -I"$SRC" -I"$SRC/inc" -c "$f" -o "$BUILD/$(basename "$f").o" || exit 1
+done
+for f in "$SRC"/*.cpp "$HERE/replay.cpp"; do
+    $CXX $CFLAGS -I"$SRC" -I"$SRC/inc" -c "$f" -o "$BUILD/$(basename "$f").o" || exit 1
+done
+
+$CXX "$BUILD"/*.o -o "$BUILD/replay" || exit 1
+
+"$BUILD/replay" "$@"
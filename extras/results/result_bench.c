@@ -0,0 +1,274 @@
+// result_bench.c
+//
+// This is a library written for SparkFun Qwiic TMF882X boards
+//
+// SparkFun sells these bpards at its website: www.sparkfun.com
+//
+// Do you like this library? Help support SparkFun. Buy a board!
+//
+//  SparkFun Qwiic dToF Imager - TMF8820        https://www.sparkfun.com/products/19036
+//  SparkFun Qwiic Mini dToF Imager - TMF8820   https://www.sparkfun.com/products/19218
+//  SparkFun Qwiic Mini dToF Imager - TMF8821   https://www.sparkfun.com/products/19451
+//  SparkFun Qwiic dToF Imager - TMF8821        https://www.sparkfun.com/products/19037
+//
+// Written by Kirk Benell @ SparkFun Electronics, April 2022
+//
+// This library provides an abstract interface to the underlying TMF882X
+// SDK that is provided by AMS.
+//
+// Repository:
+//     https://github.com/sparkfun/SparkFun_Qwiic_TMF882X_Arduino_Library
+//
+//
+// SparkFun code, firmware, and software is released under the MIT
+// License(http://opensource.org/licenses/MIT).
+//
+// SPDX-License-Identifier: MIT
+//
+//    The MIT License (MIT)
+//
+//    Copyright (c) 2022 SparkFun Electronics
+//    Permission is hereby granted, free of charge, to any person obtaining a
+//    copy of this software and associated documentation files (the "Software"),
+//    to deal in the Software without restriction, including without limitation
+//    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//    and/or sell copies of the Software, and to permit persons to whom the
+//    Software is furnished to do so, subject to the following conditions: The
+//    above copyright notice and this permission notice shall be included in all
+//    copies or substantial portions of the Software. THE SOFTWARE IS PROVIDED
+//    "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+//    NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+//    PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+//    ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+//    CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+// Result list unpack check and benchmark - built and run on the host by
+// result_bench.sh.
+//
+// The kernel in src/tmf882x_result_unpack.c is checked, field for field, against
+// the original decoder of the SDK - a loop that divides each slot index into its
+// channel, sub capture and target, and searches the results already decoded for
+// the target index of the channel. The check covers random occupancy, from empty
+// to full lists. The decoders are then timed on dense frames - every zone with
+// two targets - of each layout:
+//
+//    3x3   9 channels of sub capture 0             18 results
+//    4x4   8 channels of both sub captures         32 results
+//    8x8   four 4x4 captures make a frame          128 results
+//
+// Cycle counts are read from the time stamp counter on x86 hosts.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HAVE_CYCLES
+#endif
+
+#include "inc/tmf882x.h"
+#include "inc/tmf882x_result_unpack.h"
+
+#define kIterations 200000
+
+// The result slot layout, and index macros of the original decoder
+#define RESULT_IDX_TO_CHANNEL(idx) (((idx) % ((TMF882X_HIST_NUM_TDC * 2) - 1)) + 1)
+#define RESULT_IDX_TO_SUB_CAPTURE(idx) (((idx) / ((TMF882X_HIST_NUM_TDC * 2) - 1)) % TMF882X_NUM_SUB_CAPTURES)
+#define RESULT_IDX_TO_TARGET(idx) ((idx) / (((TMF882X_HIST_NUM_TDC * 2) - 1) * TMF882X_NUM_SUB_CAPTURES))
+
+typedef uint32_t (*unpack_fn)(struct tmf882x_msg_meas_results *results, struct tmf882x_meas_compact *compact,
+                              const uint8_t *data);
+
+// The original decoder
+static uint32_t unpack_reference(struct tmf882x_msg_meas_results *results, struct tmf882x_meas_compact *compact,
+                                 const uint8_t *data)
+{
+    uint32_t obj_cnt = 0;
+
+    for (uint32_t i = 0; i < TMF882X_MAX_MEAS_RESULTS; ++i, data += 3)
+    {
+        uint8_t confidence = data[0];
+        uint16_t distance_mm = data[1] | (data[2] << 8);
+
+        if (confidence != 0 || distance_mm != 0)
+        {
+            uint32_t channel = RESULT_IDX_TO_CHANNEL(i);
+            uint32_t sub_capture = RESULT_IDX_TO_SUB_CAPTURE(i);
+            uint32_t ch_target_idx = 0;
+
+            for (uint32_t j = 0; j < obj_cnt; ++j)
+                if (results->results[j].channel == channel && results->results[j].sub_capture == sub_capture)
+                    ch_target_idx++;
+
+            results->results[obj_cnt].confidence = confidence;
+            results->results[obj_cnt].distance_mm = distance_mm;
+            results->results[obj_cnt].channel = channel;
+            results->results[obj_cnt].sub_capture = sub_capture;
+            results->results[obj_cnt].ch_target_idx = ch_target_idx;
+            obj_cnt++;
+
+            compact->distance_mm[sub_capture][channel - 1][RESULT_IDX_TO_TARGET(i)] = distance_mm;
+            compact->confidence[sub_capture][channel - 1][RESULT_IDX_TO_TARGET(i)] = confidence;
+        }
+    }
+    return obj_cnt;
+}
+
+static const struct
+{
+    const char *name;
+    unpack_fn fn;
+} kDecoders[] = {
+    {"reference", unpack_reference},
+    {"kernel", tmf882x_result_unpack},
+};
+
+#define kNumDecoders (sizeof(kDecoders) / sizeof(kDecoders[0]))
+
+static uint8_t data[TMF882X_RESULT_LIST_SIZE];
+static struct tmf882x_msg_meas_results expected, results;
+static struct tmf882x_meas_compact expectedCompact, compact;
+
+static double nowSecs(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static uint64_t nowCycles(void)
+{
+#ifdef HAVE_CYCLES
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+// Fill a slot of the result list
+static void setSlot(uint32_t target, uint32_t sub_capture, uint32_t channel, uint8_t confidence, uint16_t distance)
+{
+    uint8_t *slot = data + 3 * (channel + TMF882X_NUM_RESULT_CH * (sub_capture + TMF882X_NUM_SUB_CAPTURES * target));
+
+    slot[0] = confidence;
+    slot[1] = distance & 0xFF;
+    slot[2] = distance >> 8;
+}
+
+// Check the kernel against the reference - each slot is occupied with the given odds
+static int check(int percent)
+{
+    for (uint32_t i = 0; i < TMF882X_MAX_MEAS_RESULTS; i++)
+    {
+        int occupied = rand() % 100 < percent;
+
+        // a target with a zero confidence, or zero distance, is still a target
+        data[3 * i] = occupied ? rand() % 3 == 0 ? 0 : (uint8_t)rand() : 0;
+        data[3 * i + 1] = occupied ? (uint8_t)rand() : 0;
+        data[3 * i + 2] = occupied ? (uint8_t)rand() : 0;
+        if (occupied && !data[3 * i] && !data[3 * i + 1] && !data[3 * i + 2])
+            data[3 * i + 1] = 1;
+    }
+
+    memset(&expected, 0, sizeof(expected));
+    memset(&expectedCompact, 0, sizeof(expectedCompact));
+    uint32_t nExpected = unpack_reference(&expected, &expectedCompact, data);
+
+    memset(&results, 0xA5, sizeof(results));
+    memset(&compact, 0, sizeof(compact));
+    uint32_t nResults = tmf882x_result_unpack(&results, &compact, data);
+
+    // results past the count aren't written
+    if (nResults != nExpected || memcmp(results.results, expected.results, nResults * sizeof(results.results[0])) ||
+        (nResults < TMF882X_MAX_MEAS_RESULTS && results.results[nResults].channel != 0xA5A5A5A5) ||
+        memcmp(&compact, &expectedCompact, sizeof(compact)))
+    {
+        printf("FAIL: %d%% occupied - %u results, expected %u\n", percent, nResults, nExpected);
+        return 1;
+    }
+    return 0;
+}
+
+// Dense frame of a layout - every channel used with two targets
+static void denseFrame(uint32_t nChannels, uint32_t nSubCaptures)
+{
+    memset(data, 0, sizeof(data));
+
+    for (uint32_t target = 0; target < TMF882X_NUM_CH_TARGETS; target++)
+        for (uint32_t sub_capture = 0; sub_capture < nSubCaptures; sub_capture++)
+            for (uint32_t channel = 0; channel < nChannels; channel++)
+                setSlot(target, sub_capture, channel, 200 - target, 500 + 100 * target + channel);
+}
+
+int main(void)
+{
+    static const struct
+    {
+        const char *name;
+        uint32_t nChannels;
+        uint32_t nSubCaptures;
+        uint32_t nCaptures; // captures in a frame
+    } kLayouts[] = {
+        {"3x3", 9, 1, 1},
+        {"4x4", 8, 2, 1},
+        {"8x8", 8, 2, 4},
+    };
+    int failed = 0;
+    int checks = 0;
+
+    srand(882);
+
+    for (int percent = 0; percent <= 100; percent += 10)
+    {
+        for (int i = 0; i < 100; i++)
+        {
+            failed += check(percent);
+            checks++;
+        }
+    }
+    printf("Checks: %d, failed: %d\n\n", checks, failed);
+
+    printf("| Layout | Decoder | Results | ns per frame | cycles per frame |\n");
+    printf("| :--- | :--- | ---: | ---: | ---: |\n");
+
+    for (uint32_t l = 0; l < sizeof(kLayouts) / sizeof(kLayouts[0]); l++)
+    {
+        denseFrame(kLayouts[l].nChannels, kLayouts[l].nSubCaptures);
+
+        for (uint32_t d = 0; d < kNumDecoders; d++)
+        {
+            uint32_t nResults = 0;
+            double start = nowSecs();
+            uint64_t startCycles = nowCycles();
+
+            for (int i = 0; i < kIterations; i++)
+            {
+                for (uint32_t c = 0; c < kLayouts[l].nCaptures; c++)
+                {
+                    nResults = kDecoders[d].fn(&results, &compact, data);
+                    // keep the compiler from dropping the unused results
+                    __asm__ __volatile__("" : : "r"(&results), "r"(&compact) : "memory");
+                }
+            }
+
+            double ns = (nowSecs() - start) * 1e9 / kIterations;
+            double cycles = (double)(nowCycles() - startCycles) / kIterations;
+
+            printf("| %s | %s | %u | %.0f | ", kLayouts[l].name, kDecoders[d].name,
+                   nResults * kLayouts[l].nCaptures, ns);
+#ifdef HAVE_CYCLES
+            printf("%.0f |\n", cycles);
+#else
+            (void)cycles;
+            printf("- |\n");
+#endif
+        }
+    }
+
+    return failed ? 1 : 0;
+}
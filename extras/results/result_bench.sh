@@ -0,0 +1,27 @@
+#!/bin/sh
+#
+# result_bench.sh
+#
+# Check the result list unpack kernel of the SDK against the original decoder,
+# bit for bit, and time it. See result_bench.c
+#
+# Usage:
+#    ./result_bench.sh
+#
+# Set CFLAGS to try other compiler options - the default is -O2.
+#
+#    CFLAGS="-O3 -march=native" ./result_bench.sh
+#
+# Returns non-zero if a check fails.
+
+CC=${CC:-gcc}
+CFLAGS="${CFLAGS:--O2}"
+
+HERE=$(cd "$(dirname "$0")" && pwd)
+SRC="$HERE/../../src"
+BUILD=$(mktemp -d)
+trap 'rm -rf "$BUILD"' EXIT
+
+$CC $CFLAGS -I"$SRC" -I"$SRC/inc" "$HERE/result_bench.c" "$SRC/tmf882x_result_unpack.c" -o "$BUILD/result_bench" || exit 1
+
+"$BUILD/result_bench"
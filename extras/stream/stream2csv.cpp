@@ -0,0 +1,175 @@
+// stream2csv.cpp
+//
+// This is a library written for SparkFun Qwiic TMF882X boards
+//
+// SparkFun sells these bpards at its website: www.sparkfun.com
+//
+// Do you like this library? Help support SparkFun. Buy a board!
+//
+//  SparkFun Qwiic dToF Imager - TMF8820        https://www.sparkfun.com/products/19036
+//  SparkFun Qwiic Mini dToF Imager - TMF8820   https://www.sparkfun.com/products/19218
+//  SparkFun Qwiic Mini dToF Imager - TMF8821   https://www.sparkfun.com/products/19451
+//  SparkFun Qwiic dToF Imager - TMF8821        https://www.sparkfun.com/products/19037
+//
+// Written by Kirk Benell @ SparkFun Electronics, April 2022
+//
+// This library provides an abstract interface to the underlying TMF882X
+// SDK that is provided by AMS.
+//
+// Repository:
+//     https://github.com/sparkfun/SparkFun_Qwiic_TMF882X_Arduino_Library
+//
+//
+// SparkFun code, firmware, and software is released under the MIT
+// License(http://opensource.org/licenses/MIT).
+//
+// SPDX-License-Identifier: MIT
+//
+//    The MIT License (MIT)
+//
+//    Copyright (c) 2022 SparkFun Electronics
+//    Permission is hereby granted, free of charge, to any person obtaining a
+//    copy of this software and associated documentation files (the "Software"),
+//    to deal in the Software without restriction, including without limitation
+//    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//    and/or sell copies of the Software, and to permit persons to whom the
+//    Software is furnished to do so, subject to the following conditions: The
+//    above copyright notice and this permission notice shall be included in all
+//    copies or substantial portions of the Software. THE SOFTWARE IS PROVIDED
+//    "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+//    NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+//    PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+//    ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+//    CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Convert a TMF882X binary stream to CSV - built and run on the host by
+// stream2csv.sh.
+//
+// The stream is decoded with TMF882XStreamDecoder from the library, so the
+// format is always the one the library writes. One type of frame is output
+// per run:
+//
+//    results     one row per target
+//    histogram   one row per TDC, with a column per bin
+//    stats       one row per set of statistics
+//
+// The decode counts are written to stderr at the end.
+
+#include <stdio.h>
+#include <string.h>
+
+#include "qwiic_tmf882x_stream.h"
+
+static TMF882XStreamDecoder decoder;
+
+static void onResults(struct tmf882x_msg_meas_results *results)
+{
+    for (uint32_t i = 0; i < results->num_results; i++)
+    {
+        struct tmf882x_meas_result *result = &results->results[i];
+
+        printf("%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u\n", results->result_num, results->host_time_us,
+               results->sys_ticks, results->temperature, results->ambient_light, results->photon_count,
+               results->ref_photon_count, result->channel, result->sub_capture, result->ch_target_idx,
+               result->confidence, result->distance_mm);
+    }
+}
+
+static void onHistogram(struct tmf882x_msg_histogram *histogram)
+{
+    for (uint32_t tdc = 0; tdc < histogram->num_tdc; tdc++)
+    {
+        printf("%u,%u,%u,%u", histogram->capture_num, histogram->sub_capture, histogram->histogram_type, tdc);
+
+        for (uint32_t bin = 0; bin < histogram->num_bins; bin++)
+            printf(",%u", histogram->bins[tdc][bin]);
+        printf("\n");
+    }
+}
+
+static void onStats(struct tmf882x_msg_meas_stats *stats)
+{
+    printf("%u,%u,%u,%u,%u,%u", stats->capture_num, stats->sub_capture, stats->tdcif_status,
+           stats->iterations_configured, stats->remaining_iterations, stats->accumulated_hits);
+
+    for (int i = 0; i < TMF882X_HIST_NUM_TDC; i++)
+        printf(",%u", stats->raw_hits[i]);
+    for (int i = 0; i < TMF882X_HIST_NUM_TDC; i++)
+        printf(",%u", stats->saturation_cnt[i]);
+    printf("\n");
+}
+
+static int usage(void)
+{
+    fprintf(stderr, "Usage: stream2csv [-t results|histogram|stats] [file]\n"
+                    "Reads the stream from stdin if no file is given.\n");
+    return 2;
+}
+
+int main(int argc, char **argv)
+{
+    const char *type = "results";
+    const char *path = nullptr;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "-t") && i + 1 < argc)
+            type = argv[++i];
+        else if (argv[i][0] == '-')
+            return usage();
+        else
+            path = argv[i];
+    }
+
+    if (!strcmp(type, "results"))
+    {
+        printf("result_num,host_time_us,sys_ticks,temperature,ambient_light,photon_count,ref_photon_count,"
+               "channel,sub_capture,ch_target_idx,confidence,distance_mm\n");
+        decoder.setMeasurementHandler(onResults);
+    }
+    else if (!strcmp(type, "histogram"))
+    {
+        printf("capture_num,sub_capture,histogram_type,tdc");
+        for (int bin = 0; bin < TMF882X_HIST_NUM_BINS; bin++)
+            printf(",bin%d", bin);
+        printf("\n");
+        decoder.setHistogramHandler(onHistogram);
+    }
+    else if (!strcmp(type, "stats"))
+    {
+        printf("capture_num,sub_capture,tdcif_status,iterations_configured,remaining_iterations,accumulated_hits");
+        for (int i = 0; i < TMF882X_HIST_NUM_TDC; i++)
+            printf(",raw_hits%d", i);
+        for (int i = 0; i < TMF882X_HIST_NUM_TDC; i++)
+            printf(",saturation_cnt%d", i);
+        printf("\n");
+        decoder.setStatsHandler(onStats);
+    }
+    else
+        return usage();
+
+    FILE *input = path ? fopen(path, "rb") : stdin;
+    if (!input)
+    {
+        perror(path);
+        return 1;
+    }
+
+    uint8_t buffer[4096];
+    size_t nRead;
+
+    while ((nRead = fread(buffer, 1, sizeof(buffer), input)) > 0)
+        decoder.decode(buffer, nRead);
+
+    if (input != stdin)
+        fclose(input);
+
+    TMF882XStreamStats stats;
+    decoder.getStreamStats(stats);
+
+    fprintf(stderr, "frames: %u, CRC errors: %u, bad frames: %u, skipped bytes: %u\n", stats.frames, stats.crcErrors,
+            stats.badFrames, stats.skippedBytes);
+
+    return 0;
+}
@@ -0,0 +1,25 @@
+#!/bin/sh
+#
+# stream2csv.sh
+#
+# Build the stream2csv tool on the host, and run it - converts a TMF882X binary
+# stream (see src/qwiic_tmf882x_stream.h) to CSV.
+#
+# Usage:
+#    ./stream2csv.sh [-t results|histogram|stats] [file] > output.csv
+#
+# To capture a stream from a serial port on Linux:
+#
+#    stty -F /dev/ttyACM0 115200 raw
+#    cat /dev/ttyACM0 > capture.bin
+
+CXX=${CXX:-g++}
+
+HERE=$(cd "$(dirname "$0")" && pwd)
+SRC="$HERE/../../src"
+BUILD=$(mktemp -d)
+trap 'rm -rf "$BUILD"' EXIT
+
+$CXX -O2 -I"$SRC" -I"$SRC/inc" "$HERE/stream2csv.cpp" "$SRC/qwiic_tmf882x_stream.cpp" -o "$BUILD/stream2csv" || exit 1
+
+"$BUILD/stream2csv" "$@"
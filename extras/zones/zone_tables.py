@@ -0,0 +1,95 @@
+#!/usr/bin/env python3
+#
+# zone_tables.py
+#
+# Generate the zone ray tables of the predefined SPAD maps, used in
+# src/qwiic_tmf882x_zones.cpp.
+#
+# Usage:
+#    ./zone_tables.py > tables.txt
+#
+# Each zone of a SPAD map is a cell of a grid that covers the field of view of
+# the map. The ray of a zone is the unit vector from the sensor through the
+# center of the zone - x right, y up and z out along the optical axis - in
+# Q14 fixed point.
+#
+# Zones are numbered from the top left of the grid, row by row. Sub-capture 0
+# holds the first zones of a time-multiplexed map, sub-capture 1 the rest.
+#
+# The grid and field of view of each map are from the SPAD map ID list in
+# src/inc/tmf8x2x_config_page_common.h. Maps with the same grid and field of
+# view share one table.
+#
+# Only the maps that list is clear about are here. Maps 8 and 9 are "9 zones"
+# maps, not 3x3 grids, and the zones of the checkerboard maps 11 and 12 aren't
+# laid out row by row - the list doesn't give their zone positions, so they have
+# no table. getZoneMap() derives their zone maps from the SPAD configuration.
+
+import math
+
+RAY_ONE = 1 << 14
+
+MAX_SPAD_MAP_ID = 13
+
+# (columns, rows, channels per sub-capture, horizontal FoV, vertical FoV): map IDs
+GEOMETRIES = {
+    (3, 3, 9, 29.0, 29.0): (1,),
+    (3, 3, 9, 29.0, 43.5): (2, 3),
+    (4, 4, 8, 29.0, 43.5): (4, 5),
+    (3, 3, 9, 44.0, 48.0): (6,),
+    (4, 4, 8, 44.0, 48.0): (7,),
+    (3, 6, 9, 29.0, 57.0): (10,),
+    (4, 4, 8, 29.0, 39.0): (13,),
+}
+
+NUM_SUB_CAPTURES = 2
+NUM_RESULT_CH = 9
+
+
+def zone_ray(cols, rows, hfov, vfov, zone):
+    col = zone % cols
+    row = zone // cols
+
+    ax = math.radians(((col + 0.5) / cols - 0.5) * hfov)
+    ay = math.radians((0.5 - (row + 0.5) / rows) * vfov)
+
+    x, y, z = math.tan(ax), math.tan(ay), 1.0
+    norm = math.sqrt(x * x + y * y + z * z)
+
+    return tuple(int(round(v / norm * RAY_ONE)) for v in (x, y, z))
+
+
+def main():
+    tables = [None] * (MAX_SPAD_MAP_ID + 1)
+
+    for (cols, rows, n_ch, hfov, vfov), ids in GEOMETRIES.items():
+        name = "kZoneMap%u" % ids[0]
+        maps = ", ".join("%u" % i for i in ids)
+        print("// Map%s %s - %ux%u, %g x %g degrees" % ("s" if len(ids) > 1 else "", maps, cols, rows, hfov, vfov))
+        print("static constexpr TMF882XZoneMap %s = {{" % name)
+        for sub in range(NUM_SUB_CAPTURES):
+            rays = []
+            for ch in range(NUM_RESULT_CH):
+                zone = sub * n_ch + ch
+                if ch < n_ch and zone < cols * rows:
+                    rays.append("{%d, %d, %d}" % zone_ray(cols, rows, hfov, vfov, zone))
+                else:
+                    rays.append("{0, 0, 0}")
+            print("    {%s," % ", ".join(rays[:5]))
+            print("     %s}," % ", ".join(rays[5:]))
+        print("}};")
+        print()
+        for i in ids:
+            tables[i] = name
+
+    print("// Tables by SPAD map ID - nullptr for the maps without one, and the test (0)")
+    print("// and user defined (14, 15) maps")
+    print("static constexpr const TMF882XZoneMap *kZoneMaps[] = {")
+    entries = [("&" + t) if t else "nullptr" for t in tables]
+    for i in range(0, len(entries), 4):
+        print("    %s," % ", ".join(entries[i:i + 4]))
+    print("};")
+
+
+if __name__ == "__main__":
+    main()
@@ -50,7 +50,13 @@
 // the underlying C++/C implementation
 
 // Include our implementation class
+#include "qwiic_i2c.h"
 #include "qwiic_tmf882x.h"
+#include "qwiic_tmf882x_array.h"
+#include "qwiic_tmf882x_calibration.h"
+#include "qwiic_tmf882x_filter.h"
+#include "qwiic_tmf882x_governor.h"
+#include "qwiic_tmf882x_stream.h"
 #include "sfe_arduino.h"
 
 // Arduino things
@@ -128,3 +134,150 @@ class SparkFun_TMF882X : public QwDevTMF882X
   private:
     sfe_TMF882X::QwI2C _i2cBus;
 };
+
+// Stream output that writes to an Arduino Stream - a Serial port..etc.
+
+class SparkFun_TMF882X_StreamOutput : public TMF882XStreamOutput
+{
+  public:
+    SparkFun_TMF882X_StreamOutput() : _stream{nullptr} {};
+
+    void init(Stream &theStream)
+    {
+        _stream = &theStream;
+    }
+
+    bool write(const uint8_t *data, uint16_t length)
+    {
+        return _stream && _stream->write(data, length) == length;
+    }
+
+  private:
+    Stream *_stream;
+};
+
+class SparkFun_TMF882X_Stream : public TMF882XStreamEncoder
+{
+  public:
+    // Default noop constructor
+    SparkFun_TMF882X_Stream(){};
+
+    ///////////////////////////////////////////////////////////////////////
+    // begin()
+    //
+    // Set the Arduino Stream the binary stream frames are written to. See
+    // qwiic_tmf882x_stream.h for the format.
+    //
+    //  Parameter   Description
+    //  ---------   ----------------------------
+    //  theStream   The output stream device - normally a Serial port.
+    //  retval      true on success
+
+    bool begin(Stream &theStream)
+    {
+        _output.init(theStream);
+        setOutput(_output);
+        return true;
+    }
+
+  private:
+    SparkFun_TMF882X_StreamOutput _output;
+};
+
+// The platforms with an EEPROM library. On the ESP32, ESP8266 and RP2040, the EEPROM
+// is emulated in flash - it is started with a size, and written on a commit.
+#if defined(__AVR__) || defined(ESP8266) || defined(ESP32) || defined(ARDUINO_ARCH_RP2040)
+#define SFE_TMF882X_HAS_EEPROM
+#if !defined(__AVR__)
+#define SFE_TMF882X_EMULATED_EEPROM
+#endif
+#endif
+
+#ifdef SFE_TMF882X_HAS_EEPROM
+
+#include <EEPROM.h>
+
+// Calibration store in the EEPROM of the board. See qwiic_tmf882x_calibration.h
+
+class SparkFun_TMF882X_CalibrationEEPROM : public TMF882XCalibrationStore
+{
+  public:
+    SparkFun_TMF882X_CalibrationEEPROM() : _start{0}, _size{0} {};
+
+    ///////////////////////////////////////////////////////////////////////
+    // begin()
+    //
+    // Set the part of the EEPROM used by the store. A record takes 211 bytes,
+    // 775 bytes for the calibration of 8x8 mode.
+    //
+    // On the ESP32, ESP8266 and RP2040, the EEPROM is started with the size
+    // start + size - if the sketch uses the EEPROM too, start it with the size
+    // it needs, and the same size here.
+    //
+    //  Parameter   Description
+    //  ---------   ----------------------------
+    //  start       Offset of the store in the EEPROM
+    //  size        Size of the store, in bytes
+    //  retval      true on success, false on error
+
+    bool begin(uint16_t start, uint16_t size)
+    {
+#ifdef SFE_TMF882X_EMULATED_EEPROM
+        EEPROM.begin(start + size);
+#endif
+        if (!size || (uint32_t)start + size > EEPROM.length())
+            return false;
+
+        _start = start;
+        _size = size;
+
+        return true;
+    }
+
+  protected:
+    uint32_t size(void)
+    {
+        return _size;
+    }
+
+    bool read(uint32_t offset, uint8_t *data, uint16_t length)
+    {
+        if (offset > _size || length > _size - offset)
+            return false;
+
+        for (uint16_t i = 0; i < length; i++)
+            data[i] = EEPROM.read(_start + offset + i);
+
+        return true;
+    }
+
+    bool write(uint32_t offset, const uint8_t *data, uint16_t length)
+    {
+        if (offset > _size || length > _size - offset)
+            return false;
+
+        // On AVR, only the bytes that change are written - saves EEPROM wear
+        for (uint16_t i = 0; i < length; i++)
+#ifdef SFE_TMF882X_EMULATED_EEPROM
+            EEPROM.write(_start + offset + i, data[i]);
+#else
+            EEPROM.update(_start + offset + i, data[i]);
+#endif
+        return true;
+    }
+
+    bool commit(void)
+    {
+#ifdef SFE_TMF882X_EMULATED_EEPROM
+        return EEPROM.commit();
+#else
+        return true;
+#endif
+    }
+
+  private:
+    uint16_t _start;
+    uint16_t _size;
+};
+
+#endif
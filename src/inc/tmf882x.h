@@ -30,6 +30,7 @@
 #define __TMF882X_H
 
 #include <stdint.h>
+#include "tmf882x_profile.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -47,9 +48,17 @@ extern "C" {
 #define TMF882X_NUM_CH_PER_TDC   2
 /** @brief Total Number of channels */
 #define TMF882X_NUM_CH           ((TMF882X_HIST_NUM_TDC)*(TMF882X_NUM_CH_PER_TDC))
+/** @brief Number of result channels (zones) per sub-capture */
+#define TMF882X_NUM_RESULT_CH    ((TMF882X_NUM_CH) - 1)
+/** @brief Number of time-multiplexed sub-captures */
+#define TMF882X_NUM_SUB_CAPTURES 2
+/** @brief Number of targets reported per result channel */
+#define TMF882X_NUM_CH_TARGETS   ((TMF882X_MAX_MEAS_RESULTS) / \
+                                  ((TMF882X_NUM_RESULT_CH)*(TMF882X_NUM_SUB_CAPTURES)))
 /* Max message size is a set of histograms + header info */
 #ifdef CONFIG_TMF882X_NO_HISTOGRAM_SUPPORT
-#define TMF882X_MAX_MSG_SIZE     (1024)
+/** @brief Maximum message size - results are the largest message */
+#define TMF882X_MAX_MSG_SIZE     (sizeof(struct tmf882x_msg_meas_results))
 #else
 /** @brief Maximum message size */
 #define TMF882X_MAX_MSG_SIZE     (64 + (TMF882X_HIST_NUM_TDC * \
@@ -264,12 +273,17 @@ struct tmf882x_meas_result {
  *      This is the system tick counter (5MHz counter) reported by the device.
  *      This is used by the core driver to perform clock compensation
  *      correction on the measurement results.
+ * @var tmf882x_msg_meas_results::host_time_us
+ *      This is the estimated host time (in microseconds) the results were
+ *      captured at. It is left zero by the core driver, and filled in by the
+ *      host from the sys_ticks value.
  * @var tmf882x_msg_meas_results::valid_results
  *      This is the number of targets reported by the device
  * @var tmf882x_msg_meas_results::num_results
  *      This is the number of non-zero targets counted by the core driver
  * @var tmf882x_msg_meas_results::results
  *      This is the list of measurement targets @ref struct tmf882x_meas_result
+ *      Only the first num_results entries are set.
  */
 struct tmf882x_msg_meas_results {
     struct tmf882x_msg_header hdr;
@@ -279,11 +293,63 @@ struct tmf882x_msg_meas_results {
     uint32_t photon_count;       /* photon count */
     uint32_t ref_photon_count;   /* reference photon count */
     uint32_t sys_ticks;          /* system ticks */
+    uint32_t host_time_us;       /* host capture time - set by the host */
     uint32_t valid_results;      /* number of valid results */
     uint32_t num_results;        /* number of results */
     struct tmf882x_meas_result results[TMF882X_MAX_MEAS_RESULTS];
 };
 
+/**
+ * @struct tmf882x_meas_compact
+ * @brief TMF882X compact measure results.
+ *      This is a dense, per-zone, layout of the same measurement results as
+ *      @ref struct tmf882x_msg_meas_results. Each zone has a fixed slot, so
+ *      the result of a zone is found without a search, and empty slots are
+ *      zero. It is filled by the core driver with each set of measurement
+ *      results, and is about 1/6th the size of the message.
+ *
+ *      Results are indexed [sub_capture][channel - 1][target slot], by the
+ *      device target slot (not ch_target_idx) - a zone whose only target is
+ *      in slot 1 has it at [..][1], with a ch_target_idx of 0. The distances
+ *      and confidences are kept in separate arrays.
+ * @var tmf882x_meas_compact::result_num
+ *      This is the result number reported by the device
+ * @var tmf882x_meas_compact::temperature
+ *      This is the temperature reported by the device (in Celsius)
+ * @var tmf882x_meas_compact::valid_results
+ *      This is the number of targets reported by the device
+ * @var tmf882x_meas_compact::num_results
+ *      This is the number of non-zero targets counted by the core driver
+ * @var tmf882x_meas_compact::ambient_light
+ *      This is the ambient light level reported by the device
+ * @var tmf882x_meas_compact::photon_count
+ *      This is the photon count reported by the device
+ * @var tmf882x_meas_compact::ref_photon_count
+ *      This is the reference channel photon count reported by the device
+ * @var tmf882x_meas_compact::sys_ticks
+ *      This is the system tick counter (5MHz counter) reported by the device.
+ * @var tmf882x_meas_compact::host_time_us
+ *      This is the estimated host time (in microseconds) the results were
+ *      captured at. Filled in by the host, zero if not.
+ * @var tmf882x_meas_compact::distance_mm
+ *      This is the distance, in millimeters, of each target
+ * @var tmf882x_meas_compact::confidence
+ *      This is the confidence level of each target. Zero if no target.
+ */
+struct tmf882x_meas_compact {
+    uint8_t result_num;
+    uint8_t temperature;
+    uint8_t valid_results;
+    uint8_t num_results;
+    uint32_t ambient_light;
+    uint32_t photon_count;
+    uint32_t ref_photon_count;
+    uint32_t sys_ticks;
+    uint32_t host_time_us;
+    uint16_t distance_mm[TMF882X_NUM_SUB_CAPTURES][TMF882X_NUM_RESULT_CH][TMF882X_NUM_CH_TARGETS];
+    uint8_t confidence[TMF882X_NUM_SUB_CAPTURES][TMF882X_NUM_RESULT_CH][TMF882X_NUM_CH_TARGETS];
+};
+
 /**
  * @struct tmf882x_msg_meas_stats
  * @brief TMF882X measure statistics message type.
@@ -324,6 +390,37 @@ struct tmf882x_msg_meas_stats {
     uint32_t saturation_cnt[TMF882X_HIST_NUM_TDC];
 };
 
+/**
+ * @struct tmf882x_capture
+ * @brief TMF882X fused capture.
+ *      This holds the measure results, the raw histograms and the measure
+ *      statistics of one capture. When a capture buffer is set with
+ *      @ref IOCAPP_SET_CAPTURE, the core driver decodes these messages directly
+ *      into it, joined by capture number, and the messages published point
+ *      into the buffer. The capture is complete once its results are published.
+ * @var tmf882x_capture::capture_num
+ *      This is the capture number of the data held. It matches the
+ *      @ref struct tmf882x_msg_meas_results::result_num
+ * @var tmf882x_capture::hist_mask
+ *      Bit n is set if the histograms of sub-capture n are held
+ * @var tmf882x_capture::stats_mask
+ *      Bit n is set if the statistics of sub-capture n are held
+ * @var tmf882x_capture::results
+ *      This is the results message of the capture
+ * @var tmf882x_capture::stats
+ *      These are the statistics messages, indexed by sub-capture
+ * @var tmf882x_capture::hist
+ *      These are the raw histogram messages, indexed by sub-capture
+ */
+struct tmf882x_capture {
+    uint32_t capture_num;
+    uint32_t hist_mask;
+    uint32_t stats_mask;
+    struct tmf882x_msg_meas_results results;
+    struct tmf882x_msg_meas_stats stats[TMF882X_NUM_SUB_CAPTURES];
+    struct tmf882x_msg_histogram hist[TMF882X_NUM_SUB_CAPTURES];
+};
+
 /**
  * @struct tmf882x_msg
  * @brief TMF882X message type.
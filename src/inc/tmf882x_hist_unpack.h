@@ -0,0 +1,113 @@
+// tmf882x_hist_unpack.h
+//
+// This is a library written for SparkFun Qwiic TMF882X boards
+//
+// SparkFun sells these bpards at its website: www.sparkfun.com
+//
+// Do you like this library? Help support SparkFun. Buy a board!
+//
+//  SparkFun Qwiic dToF Imager - TMF8820        https://www.sparkfun.com/products/19036
+//  SparkFun Qwiic Mini dToF Imager - TMF8820   https://www.sparkfun.com/products/19218
+//  SparkFun Qwiic Mini dToF Imager - TMF8821   https://www.sparkfun.com/products/19451
+//  SparkFun Qwiic dToF Imager - TMF8821        https://www.sparkfun.com/products/19037
+//
+// Written by Kirk Benell @ SparkFun Electronics, April 2022
+//
+// This library provides an abstract interface to the underlying TMF882X
+// SDK that is provided by AMS.
+//
+// Repository:
+//     https://github.com/sparkfun/SparkFun_Qwiic_TMF882X_Arduino_Library
+//
+//
+// SparkFun code, firmware, and software is released under the MIT
+// License(http://opensource.org/licenses/MIT).
+//
+// SPDX-License-Identifier: MIT
+//
+//    The MIT License (MIT)
+//
+//    Copyright (c) 2022 SparkFun Electronics
+//    Permission is hereby granted, free of charge, to any person obtaining a
+//    copy of this software and associated documentation files (the "Software"),
+//    to deal in the Software without restriction, including without limitation
+//    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//    and/or sell copies of the Software, and to permit persons to whom the
+//    Software is furnished to do so, subject to the following conditions: The
+//    above copyright notice and this permission notice shall be included in all
+//    copies or substantial portions of the Software. THE SOFTWARE IS PROVIDED
+//    "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+//    NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+//    PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+//    ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+//    CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Unpack kernels for the 24 bit histograms of the TMF882X.
+//
+// The device sends a histogram as three byte planes - the low byte of every bin
+// of every TDC, then the middle bytes, then the high bytes. The kernels build each
+// bin from the three planes in a single pass, with one store per bin, so the
+// output doesn't need to be cleared first.
+//
+//    tmf882x_hist_unpack24_bytes()   Portable - one byte load per plane and bin
+//    tmf882x_hist_unpack24_words()   Word at a time - four bins per step, for
+//                                    little endian hosts with unaligned loads.
+//
+// tmf882x_hist_unpack24() uses the portable version by default. Compilers
+// vectorize its loop, and on x86-64 it beats the word version at -O2 and -O3 -
+// see extras/histogram. Define TMF882X_HIST_UNPACK_WORDS to use the word version
+// on a target where the benchmark shows it's faster.
+//
+// The kernels are checked against the original decoder, and timed, by
+// extras/histogram.
+
+#ifndef __TMF882X_HIST_UNPACK_H
+#define __TMF882X_HIST_UNPACK_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ *  @brief
+ *       Unpack 24 bit histogram bins from three byte planes - portable version
+ *  @param[out] bins output bins - num_bins values
+ *  @param[in] data the byte planes, each num_bins bytes long
+ *  @param[in] num_bins number of bins, over all TDCs
+ */
+extern void tmf882x_hist_unpack24_bytes(uint32_t *bins, const uint8_t *data, uint32_t num_bins);
+
+/**
+ *  @brief
+ *       Unpack 24 bit histogram bins from three byte planes - word at a time.
+ *       Little endian hosts only.
+ *  @param[out] bins output bins - num_bins values
+ *  @param[in] data the byte planes, each num_bins bytes long
+ *  @param[in] num_bins number of bins, over all TDCs
+ */
+extern void tmf882x_hist_unpack24_words(uint32_t *bins, const uint8_t *data, uint32_t num_bins);
+
+/**
+ *  @brief
+ *       Unpack 24 bit histogram bins from three byte planes, with the kernel
+ *       selected for the host
+ *  @param[out] bins output bins - num_bins values
+ *  @param[in] data the byte planes, each num_bins bytes long
+ *  @param[in] num_bins number of bins, over all TDCs
+ */
+static inline void tmf882x_hist_unpack24(uint32_t *bins, const uint8_t *data, uint32_t num_bins)
+{
+#ifdef TMF882X_HIST_UNPACK_WORDS
+    tmf882x_hist_unpack24_words(bins, data, num_bins);
+#else
+    tmf882x_hist_unpack24_bytes(bins, data, num_bins);
+#endif
+}
+
+#ifdef __cplusplus
+}
+#endif
+#endif
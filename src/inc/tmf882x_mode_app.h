@@ -56,14 +56,21 @@ struct tmf882x_mode_app;
      (member_of(x, struct tmf882x_mode_app, mode)))
 
 /** @brief
- *      Max i2c payload message size
+ *      Number of bytes per histogram bin sent by the device
+ */
+#define APP_HIST_BYTES_PER_BIN  3
+
+/** @brief
+ *      Max i2c payload message size. Multi-packet messages are read a full
+ *      packet at a time, so there is room for one packet past the message.
  */
 #ifdef CONFIG_TMF882X_NO_HISTOGRAM_SUPPORT
 #define APP_MAX_MSG_SIZE        TMF8X2X_COM_HEADER_PLUS_PAYLOAD
 #else
 #define APP_MAX_MSG_SIZE        ((TMF882X_HIST_NUM_BINS * \
                                   TMF882X_HIST_NUM_TDC * \
-                                  TMF882X_BYTES_PER_BIN))
+                                  APP_HIST_BYTES_PER_BIN) + \
+                                 TMF8X2X_COM_HEADER_PLUS_PAYLOAD)
 #endif
 
 /**
@@ -150,9 +157,20 @@ struct tmf882x_mode_app_i2c_msg {
  *      This member is the cached IRQ status while servicing device interrupts
  * @var tmf882x_mode_app::volat_data::cr
  *      This member tracks the clock correction data @ref struct tmf882x_clk_corr
- * @var tmf882x_mode_app::volat_data::msg
- *      This member is the @ref tmf882x_msg for return data output
- *      from the device
+ * @var tmf882x_mode_app::volat_data::result_msg
+ *      This member is the @ref tmf882x_msg_meas_results output slot for
+ *      measurement results from the device
+ * @var tmf882x_mode_app::volat_data::stats_msg
+ *      This member is the @ref tmf882x_msg_meas_stats output slot for
+ *      measurement statistics from the device
+ * @var tmf882x_mode_app::volat_data::hist_msg
+ *      This member is the @ref tmf882x_msg_histogram output slot for
+ *      histograms from the device
+ * @var tmf882x_mode_app::volat_data::err_msg
+ *      This member is the @ref tmf882x_msg_error output slot for errors
+ * @var tmf882x_mode_app::volat_data::compact
+ *      This member is the @ref tmf882x_meas_compact per-zone copy of the
+ *      last measurement results
  * @var tmf882x_mode_app::volat_data::i2c_msg
  *      This member is the @ref tmf882x_mode_app_i2c_msg for sending/receiving
  *      i2c messages from the application mode
@@ -165,10 +183,17 @@ struct tmf882x_mode_app_i2c_msg {
  *      This member is the @ref tmf882x_mode_app_config configuration used
  *      for writing/reading configuration from the application mode. Two
  *      configuration structure tables are supported by the device
+ * @var tmf882x_mode_app::volat_data::cfg_valid
+ *      This member is whether the cached configuration matches the
+ *      configuration on the device
  * @var tmf882x_mode_app::volat_data::uid
  *      Buffer for reading out the Device UID
  * @var tmf882x_mode_app::volat_data::timestamp
  *      This member is the cached previous timestamp used in clock correction
+ * @var tmf882x_mode_app::capture
+ *      This member is the optional @ref tmf882x_capture buffer that results,
+ *      histograms and statistics are decoded into. It is kept when the
+ *      application mode is re-opened.
  */
 
 
@@ -194,8 +219,19 @@ struct tmf882x_mode_app {
         // clock correction
         struct tmf882x_clk_corr clk_cr;
 
-        // output data from app module
-        struct tmf882x_msg msg;
+        // output messages from app module - a slot of each type, sized for
+        // that type. Published as a struct tmf882x_msg, the header is common.
+        struct tmf882x_msg_meas_results result_msg;
+#ifndef CONFIG_TMF882X_NO_STATS_SUPPORT
+        struct tmf882x_msg_meas_stats stats_msg;
+#endif
+#ifndef CONFIG_TMF882X_NO_HISTOGRAM_SUPPORT
+        struct tmf882x_msg_histogram hist_msg;
+#endif
+        struct tmf882x_msg_error err_msg;
+
+        // compact, per-zone copy of the last results
+        struct tmf882x_meas_compact compact;
 
         // input/output from Chip
         struct tmf882x_mode_app_i2c_msg i2c_msg;
@@ -206,6 +242,9 @@ struct tmf882x_mode_app {
         // Application config type
         struct tmf882x_mode_app_config cfg;
 
+        // TRUE if cfg matches the config on the device
+        bool cfg_valid;
+
         // Device UID
         uint8_t uid[sizeof(uint32_t)];
 
@@ -214,6 +253,15 @@ struct tmf882x_mode_app {
 
     } volat_data;
 
+    // Fused capture buffer - NULL if not used
+    struct tmf882x_capture *capture;
+
+    // i2c message recorder - NULL callback if not used
+    struct tmf882x_mode_app_recorder recorder;
+
+    // Host time of the message being replayed - NULL if not replaying
+    const struct timespec *replay_ts;
+
 };
 
 /*****************************************************************************
@@ -72,6 +72,11 @@ enum _tmf882x_mode_app_iocnr{
     APP_SET_CLKADJ,
     APP_SET_8X8MODE,
     APP_IS_8X8MODE,
+    APP_SET_CAPTURE,
+    APP_SET_RECORDER,
+    APP_REPLAY_MSG,
+    APP_UPDATE_CFG,
+    APP_SET_SPADIMG,
     NUM_APP_IOCTL
 };
 
@@ -150,6 +155,18 @@ struct tmf882x_mode_app_config {
  */
 #define IOCAPP_GET_CFG   _IOCTL_R( TMF882X_IOCTL_APP_MODE, APP_GET_CFG, struct tmf882x_mode_app_config )
 
+/**
+ * @brief
+ *      IOCTL command code to Update the configuration of the application
+ *      mode. Only the bytes that differ from the cached configuration are
+ *      written, and the configuration page isn't read back. If the cached
+ *      configuration isn't valid, this is the same as IOCAPP_SET_CFG.
+ * @param[in] input type: struct tmf882x_mode_app_config *
+ * @param[out] output type: none
+ * @return zero for success, fail otherwise
+ */
+#define IOCAPP_UPDATE_CFG   _IOCTL_W( TMF882X_IOCTL_APP_MODE, APP_UPDATE_CFG, struct tmf882x_mode_app_config )
+
 /**
  * @struct tmf882x_mode_app_spad_config
  * @brief
@@ -209,6 +226,56 @@ struct tmf882x_mode_app_spad_config {
                                        APP_GET_SPADCFG, \
                                        struct tmf882x_mode_app_spad_config )
 
+/** @brief Size of the spad config page content written by @ref IOCAPP_SET_SPADIMG */
+#define TMF882X_SPAD_PAGE_SIZE  ((TMF8X2X_COM_SPAD_FLICKER_MAX_BIN) - \
+                                 (TMF8X2X_COM_SPAD_ENABLE_SPAD0_0) + 1)
+
+/**
+ * @struct tmf882x_mode_app_spad_image
+ * @brief
+ *      This is the Application mode spad image structure. It holds the
+ *      encoded spad config pages of a spad configuration, as written to the
+ *      device, so that they can be written again without reading the pages
+ *      for modification.
+ * @var tmf882x_mode_app_spad_image::spad_map_id
+ *      The spad map id the spad configuration was written for
+ * @var tmf882x_mode_app_spad_image::num_pages
+ *      The number of spad config pages in @ref tmf882x_mode_app_spad_image::pages
+ * @var tmf882x_mode_app_spad_image::pages
+ *      The spad config page content, starting at TMF8X2X_COM_SPAD_ENABLE_SPAD0_0
+ */
+struct tmf882x_mode_app_spad_image {
+    uint8_t spad_map_id;
+    uint8_t num_pages;
+    uint8_t pages[TMF8X2X_MAX_CONFIGURATIONS][TMF882X_SPAD_PAGE_SIZE];
+};
+
+/**
+ * @brief
+ *      IOCTL command code to Write a spad configuration to the application mode
+ *      and return the spad image written. Same as @ref IOCAPP_SET_SPADCFG.
+ * @param[in] input type: struct tmf882x_mode_app_spad_config *
+ * @param[out] output type: struct tmf882x_mode_app_spad_image *
+ * @return zero for success, fail otherwise
+ */
+#define IOCAPP_SET_SPADCFG_IMG   _IOCTL_RW( TMF882X_IOCTL_APP_MODE, \
+                                            APP_SET_SPADCFG, \
+                                            struct tmf882x_mode_app_spad_config, \
+                                            struct tmf882x_mode_app_spad_image )
+
+/**
+ * @brief
+ *      IOCTL command code to Write a spad image to the application mode. The
+ *      spad map id of the image is set, if it isn't the one in use, and the
+ *      spad config pages are written without being read first.
+ * @param[in] input type: struct tmf882x_mode_app_spad_image *
+ * @param[out] output type: none
+ * @return zero for success, fail otherwise
+ */
+#define IOCAPP_SET_SPADIMG   _IOCTL_W( TMF882X_IOCTL_APP_MODE, \
+                                       APP_SET_SPADIMG, \
+                                       struct tmf882x_mode_app_spad_image )
+
 #define TMF882X_MAX_CALIB_SIZE  (188 * 4) // 4x to handle 8x8
 /**
  * @struct tmf882x_mode_app_calib
@@ -336,6 +403,86 @@ struct tmf882x_mode_app_dev_UID {
                                         APP_IS_8X8MODE, \
                                         bool )
 
+/**
+ * @brief
+ *      IOCTL command code to Set the fused capture buffer
+ * @param[in] input type: struct tmf882x_capture ** (NULL to disable)
+ * @param[out] output type: none
+ * @return zero for success, fail otherwise
+ * @note Results, raw histograms and statistics are decoded directly into
+ *       the buffer, see @ref struct tmf882x_capture
+ */
+#define IOCAPP_SET_CAPTURE     _IOCTL_W( TMF882X_IOCTL_APP_MODE, \
+                                         APP_SET_CAPTURE, \
+                                         struct tmf882x_capture * )
+
+struct tmf882x_mode_app_i2c_msg;
+
+/**
+ * @brief
+ *      App mode i2c message recorder callback. Called with each i2c message
+ *      received from the device, before it is decoded.
+ */
+typedef void (*tmf882x_i2c_msg_recorder)(void *context,
+                                         const struct tmf882x_mode_app_i2c_msg *i2c_msg);
+
+/**
+ * @struct tmf882x_mode_app_recorder
+ * @brief
+ *      This is the Application mode i2c message recorder
+ * @var tmf882x_mode_app_recorder::record
+ *      Callback for each i2c message received - NULL to disable
+ * @var tmf882x_mode_app_recorder::context
+ *      Passed to the callback
+ */
+struct tmf882x_mode_app_recorder {
+    tmf882x_i2c_msg_recorder record;
+    void *context;
+};
+
+/**
+ * @brief
+ *      IOCTL command code to Set the i2c message recorder
+ * @param[in] input type: struct tmf882x_mode_app_recorder *
+ * @param[out] output type: none
+ * @return zero for success, fail otherwise
+ */
+#define IOCAPP_SET_RECORDER    _IOCTL_W( TMF882X_IOCTL_APP_MODE, \
+                                         APP_SET_RECORDER, \
+                                         struct tmf882x_mode_app_recorder )
+
+/**
+ * @struct tmf882x_mode_app_replay
+ * @brief
+ *      This is a recorded Application mode i2c message to replay
+ * @var tmf882x_mode_app_replay::i2c_msg
+ *      The recorded i2c message
+ * @var tmf882x_mode_app_replay::host_time_us
+ *      Host time the message was received (usec), used in place of the
+ *      host clock for clock skew correction
+ * @var tmf882x_mode_app_replay::restart
+ *      Reset the decoder state as a measurement start does, before the
+ *      message - set for the first message of a recording
+ */
+struct tmf882x_mode_app_replay {
+    const struct tmf882x_mode_app_i2c_msg *i2c_msg;
+    uint32_t host_time_us;
+    bool restart;
+};
+
+/**
+ * @brief
+ *      IOCTL command code to Replay a recorded i2c message through the
+ *      message decoders. The messages decoded are published as if they
+ *      came from the device.
+ * @param[in] input type: struct tmf882x_mode_app_replay *
+ * @param[out] output type: none
+ * @return zero for success, fail otherwise
+ */
+#define IOCAPP_REPLAY_MSG      _IOCTL_W( TMF882X_IOCTL_APP_MODE, \
+                                         APP_REPLAY_MSG, \
+                                         struct tmf882x_mode_app_replay )
+
 #ifdef __cplusplus
 }
 #endif
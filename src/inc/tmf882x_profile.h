@@ -0,0 +1,86 @@
+// tmf882x_profile.h
+//
+// This is a library written for SparkFun Qwiic TMF882X boards
+//
+// SparkFun sells these bpards at its website: www.sparkfun.com
+//
+// Do you like this library? Help support SparkFun. Buy a board!
+//
+//  SparkFun Qwiic dToF Imager - TMF8820        https://www.sparkfun.com/products/19036
+//  SparkFun Qwiic Mini dToF Imager - TMF8820   https://www.sparkfun.com/products/19218
+//  SparkFun Qwiic Mini dToF Imager - TMF8821   https://www.sparkfun.com/products/19451
+//  SparkFun Qwiic dToF Imager - TMF8821        https://www.sparkfun.com/products/19037
+//
+// Written by Kirk Benell @ SparkFun Electronics, April 2022
+//
+// This library provides an abstract interface to the underlying TMF882X
+// SDK that is provided by AMS.
+//
+// Repository:
+//     https://github.com/sparkfun/SparkFun_Qwiic_TMF882X_Arduino_Library
+//
+//
+// SparkFun code, firmware, and software is released under the MIT
+// License(http://opensource.org/licenses/MIT).
+//
+// SPDX-License-Identifier: MIT
+//
+//    The MIT License (MIT)
+//
+//    Copyright (c) 2022 SparkFun Electronics
+//    Permission is hereby granted, free of charge, to any person obtaining a
+//    copy of this software and associated documentation files (the "Software"),
+//    to deal in the Software without restriction, including without limitation
+//    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//    and/or sell copies of the Software, and to permit persons to whom the
+//    Software is furnished to do so, subject to the following conditions: The
+//    above copyright notice and this permission notice shall be included in all
+//    copies or substantial portions of the Software. THE SOFTWARE IS PROVIDED
+//    "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+//    NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+//    PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+//    ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+//    CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+// Memory profiles for the TMF882X SDK and library.
+//
+// Most of the RAM used by each device is in the message buffers of the SDK, which
+// by default are sized for histogram messages. A memory profile sizes these buffers
+// for the messages that are actually used:
+//
+//    TMF882X_PROFILE_FULL           Results, statistics and histograms (default)
+//    TMF882X_PROFILE_RESULTS_STATS  Results and statistics - no histograms
+//    TMF882X_PROFILE_RESULTS        Results only
+//
+// To select a profile, define TMF882X_MEMORY_PROFILE in the build flags of the
+// project, or change the default below. The same profile must be used for all files
+// of the library.
+//
+// The RAM and flash use of each profile is reported by extras/footprint.
+
+#pragma once
+
+#define TMF882X_PROFILE_RESULTS 1
+#define TMF882X_PROFILE_RESULTS_STATS 2
+#define TMF882X_PROFILE_FULL 3
+
+#ifndef TMF882X_MEMORY_PROFILE
+#define TMF882X_MEMORY_PROFILE TMF882X_PROFILE_FULL
+#endif
+
+#if TMF882X_MEMORY_PROFILE != TMF882X_PROFILE_FULL && TMF882X_MEMORY_PROFILE != TMF882X_PROFILE_RESULTS_STATS && \
+    TMF882X_MEMORY_PROFILE != TMF882X_PROFILE_RESULTS
+#error "TMF882X_MEMORY_PROFILE must be one of the TMF882X_PROFILE_* values"
+#endif
+
+// No histograms - the message buffers are sized for results
+#if TMF882X_MEMORY_PROFILE != TMF882X_PROFILE_FULL && !defined(CONFIG_TMF882X_NO_HISTOGRAM_SUPPORT)
+#define CONFIG_TMF882X_NO_HISTOGRAM_SUPPORT
+#endif
+
+// No statistics - statistics messages from the device are dropped
+#if TMF882X_MEMORY_PROFILE == TMF882X_PROFILE_RESULTS && !defined(CONFIG_TMF882X_NO_STATS_SUPPORT)
+#define CONFIG_TMF882X_NO_STATS_SUPPORT
+#endif
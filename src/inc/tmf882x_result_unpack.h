@@ -0,0 +1,94 @@
+// tmf882x_result_unpack.h
+//
+// This is a library written for SparkFun Qwiic TMF882X boards
+//
+// SparkFun sells these bpards at its website: www.sparkfun.com
+//
+// Do you like this library? Help support SparkFun. Buy a board!
+//
+//  SparkFun Qwiic dToF Imager - TMF8820        https://www.sparkfun.com/products/19036
+//  SparkFun Qwiic Mini dToF Imager - TMF8820   https://www.sparkfun.com/products/19218
+//  SparkFun Qwiic Mini dToF Imager - TMF8821   https://www.sparkfun.com/products/19451
+//  SparkFun Qwiic dToF Imager - TMF8821        https://www.sparkfun.com/products/19037
+//
+// Written by Kirk Benell @ SparkFun Electronics, April 2022
+//
+// This library provides an abstract interface to the underlying TMF882X
+// SDK that is provided by AMS.
+//
+// Repository:
+//     https://github.com/sparkfun/SparkFun_Qwiic_TMF882X_Arduino_Library
+//
+//
+// SparkFun code, firmware, and software is released under the MIT
+// License(http://opensource.org/licenses/MIT).
+//
+// SPDX-License-Identifier: MIT
+//
+//    The MIT License (MIT)
+//
+//    Copyright (c) 2022 SparkFun Electronics
+//    Permission is hereby granted, free of charge, to any person obtaining a
+//    copy of this software and associated documentation files (the "Software"),
+//    to deal in the Software without restriction, including without limitation
+//    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//    and/or sell copies of the Software, and to permit persons to whom the
+//    Software is furnished to do so, subject to the following conditions: The
+//    above copyright notice and this permission notice shall be included in all
+//    copies or substantial portions of the Software. THE SOFTWARE IS PROVIDED
+//    "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+//    NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+//    PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+//    ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+//    CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+// Unpack kernel for the object result list of the TMF882X.
+//
+// The device sends a fixed list of TMF8X2X_COM_MAX_MEASUREMENT_RESULTS result
+// slots - confidence (1 byte) and distance (2 bytes, little endian) - ordered by
+// channel, then sub capture, then target. Slots with a zero confidence and
+// distance are empty.
+//
+// The kernel walks the slots with running channel, sub capture and target
+// indexes, and keeps a count of the targets found in each channel, so each slot
+// costs the same - no divides, and no search of the results already decoded
+// for the target index of a channel.
+//
+// The kernel is checked against the original decoder, and timed, by
+// extras/results.
+
+#ifndef __TMF882X_RESULT_UNPACK_H
+#define __TMF882X_RESULT_UNPACK_H
+
+#include <stdint.h>
+
+#include "tmf882x.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief
+ *      Size of the object result list of a result message, in bytes
+ */
+#define TMF882X_RESULT_LIST_SIZE    (TMF882X_MAX_MEAS_RESULTS * 3)
+
+/**
+ *  @brief
+ *       Unpack the object result list of a result message
+ *  @param[out] results the results message - the results list is filled in
+ *  @param[out] compact the compact results - the slot of each target found is
+ *                      set. Must be cleared by the caller.
+ *  @param[in] data the result list - TMF882X_RESULT_LIST_SIZE bytes
+ *  @return the number of objects found
+ */
+extern uint32_t tmf882x_result_unpack(struct tmf882x_msg_meas_results *results,
+                                      struct tmf882x_meas_compact *compact,
+                                      const uint8_t *data);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
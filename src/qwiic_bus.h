@@ -0,0 +1,84 @@
+// qwiic_bus.h
+//
+// This is a library written for SparkFun Qwiic TMF882X boards
+//
+// SparkFun sells these bpards at its website: www.sparkfun.com
+//
+// Do you like this library? Help support SparkFun. Buy a board!
+//
+//  SparkFun Qwiic dToF Imager - TMF8820        https://www.sparkfun.com/products/19036
+//  SparkFun Qwiic Mini dToF Imager - TMF8820   https://www.sparkfun.com/products/19218
+//  SparkFun Qwiic Mini dToF Imager - TMF8821   https://www.sparkfun.com/products/19451
+//  SparkFun Qwiic dToF Imager - TMF8821        https://www.sparkfun.com/products/19037
+//
+// Written by Kirk Benell @ SparkFun Electronics, April 2022
+//
+// This library provides an abstract interface to the underlying TMF882X
+// SDK that is provided by AMS.
+//
+// Repository:
+//     https://github.com/sparkfun/SparkFun_Qwiic_TMF882X_Arduino_Library
+//
+//
+// SparkFun code, firmware, and software is released under the MIT
+// License(http://opensource.org/licenses/MIT).
+//
+// SPDX-License-Identifier: MIT
+//
+//    The MIT License (MIT)
+//
+//    Copyright (c) 2022 SparkFun Electronics
+//    Permission is hereby granted, free of charge, to any person obtaining a
+//    copy of this software and associated documentation files (the "Software"),
+//    to deal in the Software without restriction, including without limitation
+//    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//    and/or sell copies of the Software, and to permit persons to whom the
+//    Software is furnished to do so, subject to the following conditions: The
+//    above copyright notice and this permission notice shall be included in all
+//    copies or substantial portions of the Software. THE SOFTWARE IS PROVIDED
+//    "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+//    NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+//    PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+//    ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+//    CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+// Header for the abstract communication bus interface
+
+#pragma once
+
+// Abstract interface for the bus used to communicate with the TMF882X device.
+//
+// The library talks to the device through this interface, so different
+// transports can be used - the Arduino Wire port (QwI2C), a Linux i2c-dev
+// device, an in-memory fake or a bus multiplexer. A transport implements the
+// methods below.
+//
+// The methods follow the return conventions of the underlying SDK: the
+// region methods return 0 on success, -1 on error.
+
+#include <stdint.h>
+
+namespace sfe_TMF882X {
+
+class QwIDeviceBus {
+
+public:
+    virtual ~QwIDeviceBus(void) {}
+
+    // see if a device exists
+    virtual bool ping(uint8_t address) = 0;
+
+    // Write a single byte to a register
+    virtual bool writeRegisterByte(uint8_t address, uint8_t offset, uint8_t data) = 0;
+
+    // Write a block of bytes to the device, starting at the given register
+    virtual int writeRegisterRegion(uint8_t address, uint8_t offset, uint8_t* data, uint16_t length) = 0;
+
+    // Read a block of bytes from the device. The register is written, followed
+    // by a read of the data - a write-then-read operation.
+    virtual int readRegisterRegion(uint8_t addr, uint8_t reg, uint8_t* data, uint16_t numBytes) = 0;
+};
+
+};
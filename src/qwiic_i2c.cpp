@@ -45,6 +45,10 @@
 
 // Class provide an abstract interface to the I2C device
 
+// Only built for Arduino - see qwiic_linux_i2c.cpp for Linux hosts
+
+#if defined(ARDUINO)
+
 #include "qwiic_i2c.h"
 #include <Arduino.h>
 
@@ -233,4 +237,6 @@ int QwI2C::readRegisterRegion(uint8_t addr, uint8_t reg, uint8_t *data, uint16_t
     return 0; // Success
 }
 
-}
\ No newline at end of file
+}
+
+#endif
@@ -51,15 +51,18 @@
 //
 // This is following a pattern for future implementations
 //
-// This class is focused on Arduino..
+// This class is focused on Arduino, and implements the QwIDeviceBus
+// interface using a Wire port.
 
 #include "Arduino.h"
 #include <Wire.h>
 
+#include "qwiic_bus.h"
+
 namespace sfe_TMF882X {
 
 
-class QwI2C {
+class QwI2C : public QwIDeviceBus {
 
 public:
     QwI2C(void);
@@ -0,0 +1,216 @@
+// qwiic_linux_i2c.cpp
+//
+// This is a library written for SparkFun Qwiic TMF882X boards
+//
+// SparkFun sells these bpards at its website: www.sparkfun.com
+//
+// Do you like this library? Help support SparkFun. Buy a board!
+//
+//  SparkFun Qwiic dToF Imager - TMF8820        https://www.sparkfun.com/products/19036
+//  SparkFun Qwiic Mini dToF Imager - TMF8820   https://www.sparkfun.com/products/19218
+//  SparkFun Qwiic Mini dToF Imager - TMF8821   https://www.sparkfun.com/products/19451
+//  SparkFun Qwiic dToF Imager - TMF8821        https://www.sparkfun.com/products/19037
+//
+// Written by Kirk Benell @ SparkFun Electronics, April 2022
+//
+// This library provides an abstract interface to the underlying TMF882X
+// SDK that is provided by AMS.
+//
+// Repository:
+//     https://github.com/sparkfun/SparkFun_Qwiic_TMF882X_Arduino_Library
+//
+//
+// SparkFun code, firmware, and software is released under the MIT
+// License(http://opensource.org/licenses/MIT).
+//
+// SPDX-License-Identifier: MIT
+//
+//    The MIT License (MIT)
+//
+//    Copyright (c) 2022 SparkFun Electronics
+//    Permission is hereby granted, free of charge, to any person obtaining a
+//    copy of this software and associated documentation files (the "Software"),
+//    to deal in the Software without restriction, including without limitation
+//    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//    and/or sell copies of the Software, and to permit persons to whom the
+//    Software is furnished to do so, subject to the following conditions: The
+//    above copyright notice and this permission notice shall be included in all
+//    copies or substantial portions of the Software. THE SOFTWARE IS PROVIDED
+//    "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+//    NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+//    PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+//    ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+//    CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+// Implements the QwIDeviceBus interface using the Linux i2c-dev driver
+
+#if defined(__linux__) && !defined(ARDUINO)
+
+#include "qwiic_linux_i2c.h"
+
+#include <fcntl.h>
+#include <linux/i2c-dev.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+namespace sfe_TMF882X {
+//////////////////////////////////////////////////////////////////////////////////////////////////
+// Constructor
+
+QwLinuxI2C::QwLinuxI2C(void) : _fd{-1}, _ownsFD{false}
+{
+}
+
+QwLinuxI2C::~QwLinuxI2C(void)
+{
+    close();
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////
+// init()
+//
+// Open an i2c-dev device by path - "/dev/i2c-1" for example. This object owns the
+// descriptor, and closes it on close().
+
+bool QwLinuxI2C::init(const char *devicePath)
+{
+    // already have a device?
+    if (_fd >= 0)
+        return true;
+
+    if (!devicePath)
+        return false;
+
+    _fd = ::open(devicePath, O_RDWR);
+    if (_fd < 0)
+        return false;
+
+    _ownsFD = true;
+
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////
+// init()
+//
+// Use an i2c-dev file descriptor that is already open. The caller owns the descriptor - it
+// isn't closed by close().
+
+bool QwLinuxI2C::init(int fd)
+{
+    if (_fd >= 0)
+        return true;
+
+    if (fd < 0)
+        return false;
+
+    _fd = fd;
+    _ownsFD = false;
+
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////
+// close()
+//
+// Close the device - only if this object opened it
+
+void QwLinuxI2C::close(void)
+{
+    if (_fd >= 0 && _ownsFD)
+        ::close(_fd);
+
+    _fd = -1;
+    _ownsFD = false;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////
+// transfer()
+//
+// Send a set of messages to the bus as one combined transaction - a repeated start is
+// used between messages.
+
+int QwLinuxI2C::transfer(struct i2c_msg *msgs, uint32_t nMsgs)
+{
+    if (_fd < 0)
+        return -1;
+
+    struct i2c_rdwr_ioctl_data xfer;
+
+    xfer.msgs = msgs;
+    xfer.nmsgs = nMsgs;
+
+    // ioctl returns the number of messages transferred
+    return ioctl(_fd, I2C_RDWR, &xfer) == (int)nMsgs ? 0 : -1;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////
+// ping()
+//
+// Is a device connected? Try to read a byte from the device
+
+bool QwLinuxI2C::ping(uint8_t i2c_address)
+{
+    uint8_t data;
+    struct i2c_msg msg = {i2c_address, I2C_M_RD, 1, &data};
+
+    return transfer(&msg, 1) == 0;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////
+// writeRegisterByte()
+//
+// Write a byte to a register
+
+bool QwLinuxI2C::writeRegisterByte(uint8_t i2c_address, uint8_t offset, uint8_t dataToWrite)
+{
+    return writeRegisterRegion(i2c_address, offset, &dataToWrite, 1) == 0;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////
+// writeRegisterRegion()
+//
+// Write a block of data to a device.
+//
+// As with the Arduino implementation, the data is sent in one transaction - the
+// device validates the checksum of firmware download blocks on each transaction.
+
+int QwLinuxI2C::writeRegisterRegion(uint8_t i2c_address, uint8_t offset, uint8_t *data, uint16_t length)
+{
+    if (length > kMaxLinuxI2CWrite || (length && !data))
+        return -1;
+
+    // The register is the first byte of the message
+    _writeBuffer[0] = offset;
+    if (length)
+        memcpy(_writeBuffer + 1, data, length);
+
+    struct i2c_msg msg = {i2c_address, 0, (uint16_t)(length + 1), _writeBuffer};
+
+    return transfer(&msg, 1);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// readRegisterRegion()
+//
+// Reads a block of data from an i2c register on the devices.
+//
+// The register write and data read are one transaction, with a repeated start
+// between them. No chunking - the full block is read in one transfer.
+
+int QwLinuxI2C::readRegisterRegion(uint8_t addr, uint8_t reg, uint8_t *data, uint16_t numBytes)
+{
+    if (!data || !numBytes)
+        return -1;
+
+    struct i2c_msg msgs[2] = {{addr, 0, 1, &reg}, {addr, I2C_M_RD, numBytes, data}};
+
+    return transfer(msgs, 2);
+}
+
+};
+
+#endif
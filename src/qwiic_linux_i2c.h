@@ -0,0 +1,113 @@
+// qwiic_linux_i2c.h
+//
+// This is a library written for SparkFun Qwiic TMF882X boards
+//
+// SparkFun sells these bpards at its website: www.sparkfun.com
+//
+// Do you like this library? Help support SparkFun. Buy a board!
+//
+//  SparkFun Qwiic dToF Imager - TMF8820        https://www.sparkfun.com/products/19036
+//  SparkFun Qwiic Mini dToF Imager - TMF8820   https://www.sparkfun.com/products/19218
+//  SparkFun Qwiic Mini dToF Imager - TMF8821   https://www.sparkfun.com/products/19451
+//  SparkFun Qwiic dToF Imager - TMF8821        https://www.sparkfun.com/products/19037
+//
+// Written by Kirk Benell @ SparkFun Electronics, April 2022
+//
+// This library provides an abstract interface to the underlying TMF882X
+// SDK that is provided by AMS.
+//
+// Repository:
+//     https://github.com/sparkfun/SparkFun_Qwiic_TMF882X_Arduino_Library
+//
+//
+// SparkFun code, firmware, and software is released under the MIT
+// License(http://opensource.org/licenses/MIT).
+//
+// SPDX-License-Identifier: MIT
+//
+//    The MIT License (MIT)
+//
+//    Copyright (c) 2022 SparkFun Electronics
+//    Permission is hereby granted, free of charge, to any person obtaining a
+//    copy of this software and associated documentation files (the "Software"),
+//    to deal in the Software without restriction, including without limitation
+//    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//    and/or sell copies of the Software, and to permit persons to whom the
+//    Software is furnished to do so, subject to the following conditions: The
+//    above copyright notice and this permission notice shall be included in all
+//    copies or substantial portions of the Software. THE SOFTWARE IS PROVIDED
+//    "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+//    NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+//    PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+//    ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+//    CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+// Header for the Linux i2c-dev bus object
+
+#pragma once
+
+// Object that implements the QwIDeviceBus interface using the Linux i2c-dev
+// driver (/dev/i2c-N).
+//
+// Register reads are issued as a single I2C_RDWR transaction - the register
+// write and the data read are joined with a repeated start. Unlike the Arduino
+// QwI2C object, transfers are not chunked to fit a Wire buffer.
+//
+// Only built on Linux hosts - not when building for Arduino.
+
+#if defined(__linux__) && !defined(ARDUINO)
+
+#include <linux/i2c.h>
+#include <stdint.h>
+
+#include "qwiic_bus.h"
+
+// Max number of bytes written in one transaction - register address not included.
+#define kMaxLinuxI2CWrite 256
+
+namespace sfe_TMF882X {
+
+class QwLinuxI2C : public QwIDeviceBus {
+
+public:
+    QwLinuxI2C(void);
+    virtual ~QwLinuxI2C(void);
+
+    // Open the given i2c-dev device - "/dev/i2c-1" for example
+    bool init(const char* devicePath);
+
+    // Use an already open file descriptor. The caller owns the descriptor.
+    bool init(int fd);
+
+    // Close the device, if opened by this object
+    void close(void);
+
+    // see if a device exists
+    bool ping(uint8_t address);
+
+    bool writeRegisterByte(uint8_t address, uint8_t offset, uint8_t data);
+
+    // Write a block of bytes to the device --
+    int writeRegisterRegion(uint8_t address, uint8_t offset, uint8_t* data, uint16_t length);
+
+    int readRegisterRegion(uint8_t addr, uint8_t reg, uint8_t* data, uint16_t numBytes);
+
+protected:
+    // Issue the messages as one combined transaction. The default implementation
+    // calls ioctl(I2C_RDWR) - override to run against a loopback fake.
+    //
+    // Returns 0 on success, -1 on error
+    virtual int transfer(struct i2c_msg* msgs, uint32_t nMsgs);
+
+    int _fd;
+
+private:
+    bool _ownsFD;
+    uint8_t _writeBuffer[kMaxLinuxI2CWrite + 1];
+};
+
+};
+
+#endif
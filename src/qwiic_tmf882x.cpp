@@ -50,10 +50,77 @@
 
 #include "mcu_tmf882x_config.h"
 #include "qwiic_tmf882x.h"
+#include "qwiic_tmf882x_calibration.h"
+#include "qwiic_tmf882x_filter.h"
+#include "qwiic_tmf882x_governor.h"
+#include "qwiic_tmf882x_stream.h"
 #include "sfe_arduino.h"
 
 #include "inc/tmf882x_host_interface.h"
 
+// The sys_ticks counter of the TMF882X runs at 5 MHz
+#define kTMF882XSysTicksPerUS 5
+
+// For adaptive polling, the device is polled in steps of a fraction of the frame
+// period while waiting for a result.
+#define kPollStepDivisor 16
+#define kMinPollStepUS 1000
+
+// The capture time model measures the clock skew over windows of device time. A
+// result further than the max error from the model means the device clock jumped.
+#define kTimeSyncWindowUS 2000000
+#define kTimeSyncMaxErrorUS 1000000
+#define kTimeSyncMaxSkewPPM 50000
+
+// The skew is measured over at most this span - sys_ticks wraps every 859 secs
+#define kTimeSyncMaxSpanUS 400000000
+
+// Iterations of a factory calibration, in thousands - see the TMF882X datasheet
+#define kFactoryCalKiloIterations 4000
+
+// Time for the device to answer at a new I2C address
+#define kI2CAddressMoveTimeoutMS 10
+
+// 32 bit FNV-1a hash - SPAD cache keys and firmware image hashes
+#define kFNVOffsetBasis 2166136261UL
+#define kFNVPrime 16777619UL
+
+//////////////////////////////////////////////////////////////////////////////
+// fnvHash()
+//
+// Update a 32 bit FNV-1a hash with a block of data. Start with kFNVOffsetBasis.
+//
+//  Parameter   Description
+//  ---------   -----------------------------
+//  hash        The current hash value
+//  data        The data
+//  length      Length of the data
+//  retval      The updated hash value
+
+static uint32_t fnvHash(uint32_t hash, const uint8_t *data, uint32_t length)
+{
+    for (uint32_t i = 0; i < length; i++)
+        hash = (hash ^ data[i]) * kFNVPrime;
+
+    return hash;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// frameBufferBarrier()
+//
+// Memory barrier for the frame buffer. A slot must be fully written (or read)
+// before the index that hands it over is updated. On AVR there is one core, so
+// stopping the compiler from reordering is enough.
+
+static inline void frameBufferBarrier(void)
+{
+#if defined(__AVR__)
+    __asm__ __volatile__("" ::: "memory");
+#else
+    __sync_synchronize();
+#endif
+}
+
 //////////////////////////////////////////////////////////////////////////////
 // initializeTMF882x()
 //
@@ -77,9 +144,19 @@ bool QwDevTMF882X::initializeTMF882x(void)
         return false;
     }
 
+    _firmwareHash = 0;
+    _warmStarted = false;
+
+    // Warm start - if the device still runs the firmware image of this library,
+    // from before an MCU reset, the download is skipped.
+    if (_warmStartID && isFirmwareRunning(*_warmStartID))
+    {
+        _firmwareHash = _warmStartID->imageHash;
+        _warmStarted = true;
+    }
     // Load the firmware image that is part of the TMF882X SDK. Without
     // firware, the device won't work
-    if (!loadFirmware(tof_bin_image, tof_bin_image_length))
+    else if (!loadFirmware(tof_bin_image, tof_bin_image_length))
     {
         // Fallback:
         //    Firmware upload failed. See if the device can move to app
@@ -134,6 +211,11 @@ bool QwDevTMF882X::loadFirmware(const unsigned char *firmwareBinImage, unsigned
         return false;
     }
 
+    _firmwareHash = fnvHash(kFNVOffsetBasis, firmwareBinImage, length);
+
+    // The device starts over - kept SPAD pages are no longer known to match
+    clearSPADCache();
+
     return true;
 }
 
@@ -161,6 +243,13 @@ bool QwDevTMF882X::init(void)
 
     _isInitialized = true;
 
+    // Set the calibration of this device, if a store is in use
+    if (_calStore && !restoreCalibration())
+    {
+        _isInitialized = false;
+        return false;
+    }
+
     return true;
 }
 
@@ -184,7 +273,8 @@ bool QwDevTMF882X::isConnected()
 //
 // Set/Change the address of the connected device.
 //
-// Called after the device has been initialized.
+// Called after the device has been initialized. In a config transaction,
+// the device moves to the address when the transaction is committed.
 //
 //  Parameter   Description
 //  ---------   -----------------------------
@@ -197,34 +287,35 @@ bool QwDevTMF882X::setI2CAddress(uint8_t address)
     if (!_isInitialized || address < 0x08 || address > 0x77)
         return false;
 
+    // In a transaction, the move waits for the commit
+    if (_inConfig)
+    {
+        // back to the current address? Drop the pending move
+        if (address == _i2cAddress)
+        {
+            _pendingConfig.i2c_slave_addr = _TOF.app.volat_data.cfg.i2c_slave_addr;
+            _pendingI2CAddress = 0;
+        }
+        else
+        {
+            _pendingConfig.i2c_slave_addr = address;
+            _pendingI2CAddress = address;
+        }
+        return true;
+    }
+
     // is the address the same as already set?
     if (address == _i2cAddress)
         return true;
 
-    // Okay, go time -- get the config
-    struct tmf882x_mode_app_config tofConfig;
-
-    // Get the config struct from the underlying SDK
-    if (tmf882x_ioctl(&_TOF, IOCAPP_GET_CFG, NULL, &tofConfig))
-        return false;
-
-    // change the address in the config
-    tofConfig.i2c_slave_addr = address;
-
-    // set it.
-    if (tmf882x_ioctl(&_TOF, IOCAPP_SET_CFG, &tofConfig, NULL))
-        return false;
-
-    // Now tell the device to switch to the address in the config page.
-    uint8_t cmdCode = TMF8X2X_COM_CMD_STAT__cmd_stat__CMD_I2C_SLAVE_ADDRESS;
-    if (_i2cBus->writeRegisterRegion(_i2cAddress, TMF8X2X_COM_CMD_STAT, &cmdCode, sizeof(uint8_t)))
+    // Okay, go time -- change the address in the config.
+    if (!beginConfig())
         return false;
 
-    // Potential TODO - check status register... .. need to test.
+    _pendingConfig.i2c_slave_addr = address;
+    _pendingI2CAddress = address;
 
-    // If we are here, the address should of been changed
-    _i2cAddress = address;
-    return true;
+    return commitConfig();
 }
 
 ///////////////////////////////////////////////////////////////////////
@@ -256,6 +347,63 @@ bool QwDevTMF882X::getApplicationVersion(char *pVersion, uint8_t vlen)
     return true;
 }
 
+///////////////////////////////////////////////////////////////////////
+// getFirmwareID()
+//
+// Returns the ID of the firmware running on the device - the version it
+// reports, and the hash of the firmware image the library downloaded. Keep
+// it across an MCU reset, and pass it to setWarmStart().
+//
+//  Parameter   Description
+//  ---------   -----------------------------
+//  firmwareID  The firmware ID
+//  retval      true on success, false on failure or if the library didn't
+//              download the firmware
+
+bool QwDevTMF882X::getFirmwareID(TMF882XFirmwareID &firmwareID)
+{
+    if (!_isInitialized || !_firmwareHash)
+        return false;
+
+    memset(&firmwareID, 0, sizeof(firmwareID));
+
+    if (!getApplicationVersion(firmwareID.version, sizeof(firmwareID.version)))
+        return false;
+
+    firmwareID.imageHash = _firmwareHash;
+
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////
+// isFirmwareRunning()
+//
+// Internal, private method. Returns true if the device is in application
+// mode, running the firmware of a firmware ID - and the ID is of the firmware
+// image of the library.
+//
+//  Parameter   Description
+//  ---------   -----------------------------
+//  firmwareID  The firmware ID
+//  retval      true if the firmware is running
+
+bool QwDevTMF882X::isFirmwareRunning(const TMF882XFirmwareID &firmwareID)
+{
+    if (tmf882x_get_mode(&_TOF) != TMF882X_MODE_APP)
+        return false;
+
+    // an ID of another image - the library was updated since the ID was kept
+    if (firmwareID.imageHash != fnvHash(kFNVOffsetBasis, tof_bin_image, tof_bin_image_length))
+        return false;
+
+    char version[kFirmwareVersionSize];
+
+    if (tmf882x_get_firmware_ver(&_TOF, version, sizeof(version)) <= 0)
+        return false;
+
+    return strncmp(version, firmwareID.version, sizeof(version)) == 0;
+}
+
 ///////////////////////////////////////////////////////////////////////
 // getDeviceUniqueID()
 //
@@ -329,6 +477,29 @@ bool QwDevTMF882X::getCalibration(struct tmf882x_mode_app_calib &tofCalib)
     return true;
 }
 
+///////////////////////////////////////////////////////////////////////
+// setCalibrationStore()
+//
+// Set a store of calibrations, keyed by the device unique ID. When the device
+// is initialized, or its 8x8 mode is changed, the calibration kept for it is
+// set on the device. If the store has none, a factory calibration is run and
+// saved to the store.
+//
+//  Parameter    Description
+//  ---------    -----------------------------
+//  store        The calibration store. nullptr to not use a store
+//  retval       True on success, false on error
+
+bool QwDevTMF882X::setCalibrationStore(TMF882XCalibrationStore *store)
+{
+    _calStore = store;
+
+    if (!_isInitialized || !_calStore)
+        return true;
+
+    return restoreCalibration();
+}
+
 ///////////////////////////////////////////////////////////////////////
 // factoryCalibration()
 //
@@ -395,6 +566,38 @@ int QwDevTMF882X::startMeasuring(struct tmf882x_msg_meas_results &results, uint3
     return 1;
 }
 
+///////////////////////////////////////////////////////////////////////
+// startMeasuring()
+//
+// Start measuring distance/data on the TMF882X device. This method
+// returns after one measurement is performed.
+//
+// Measurement data is returned in the provided compact results struct.
+//
+//  Parameter         Description
+//  ---------         -----------------------------
+//  results           The results of the mesurement, in the compact layout
+//  timeout           The time, in milliseconds, to take measurements. A
+//                    value of zero indicates no timeout set.
+//  retval            The number of measurements taken (1), or -1 on error.
+
+int QwDevTMF882X::startMeasuring(struct tmf882x_meas_compact &results, uint32_t timeout)
+{
+    if (!_isInitialized)
+        return -1;
+
+    if (!measurementLoop(1, timeout) || !_lastMeasurement)
+    {
+        memset(&results, 0, sizeof(tmf882x_meas_compact));
+        return -1;
+    }
+
+    // The SDK fills in the compact results with each measurement
+    memcpy(&results, &_TOF.app.volat_data.compact, sizeof(tmf882x_meas_compact));
+
+    return 1;
+}
+
 ///////////////////////////////////////////////////////////////////////
 // startMeasuring()
 //
@@ -434,6 +637,100 @@ int QwDevTMF882X::startMeasuring(uint32_t reqMeasurements, uint32_t timeout)
     return measurementLoop(reqMeasurements, timeout);
 }
 
+///////////////////////////////////////////////////////////////////////
+// beginContinuous()
+//
+// Start continuous, non-blocking, measurements on the TMF882X device.
+//
+// Unlike startMeasuring(), this method returns right away. The device is
+// then serviced by calling service() from the main loop of the caller.
+//
+//  Parameter         Description
+//  ---------         -----------------------------
+//  retval            true on success, false on error
+
+bool QwDevTMF882X::beginContinuous(void)
+{
+    if (!_isInitialized)
+        return false;
+
+    if (_isContinuous) // already running
+        return true;
+
+    // Setup for the measurement session
+    _stopMeasuring = false;
+    _lastMeasurement = nullptr;
+    _nMeasurements = 0;
+
+    _irqPending = false;
+    _irqStamped = false;
+
+    if (tmf882x_start(&_TOF))
+        return false;
+
+    // Make sure the first call to service() does a pass
+    resetPollSchedule();
+    resetDepthFrame();
+    resetFilter();
+    resetGovernor();
+    _isContinuous = true;
+
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////
+// service()
+//
+// Called from the main loop of the caller to service the TMF882X device
+// while in continuous mode. Does at most one processing pass of the device,
+// and returns at once if nothing is pending.
+//
+//  Parameter         Description
+//  ---------         -----------------------------
+//  retval            The number of measurements delivered in this call, or -1 on error
+
+int QwDevTMF882X::service(void)
+{
+    if (!_isInitialized || !_isContinuous)
+        return -1;
+
+    // Anything to do? In interrupt mode, the ISR tells us. Otherwise, is the next
+    // scheduled poll due - this is the backstop in interrupt mode.
+    if (!(_interruptMode && _irqPending) && (int32_t)(sfe_micros() - _nextPollUS) < 0)
+        return 0;
+
+    uint16_t nStart = _nMeasurements;
+
+    if (serviceDevice())
+        return -1;
+
+    int nDelivered = (uint16_t)(_nMeasurements - nStart);
+
+    // stop requested in a handler?
+    if (_stopMeasuring)
+        endContinuous();
+
+    return nDelivered;
+}
+
+///////////////////////////////////////////////////////////////////////
+// endContinuous()
+//
+// Stop continuous measurements on the TMF882X device.
+//
+//  Parameter         Description
+//  ---------         -----------------------------
+//  None
+
+void QwDevTMF882X::endContinuous(void)
+{
+    if (!_isContinuous)
+        return;
+
+    tmf882x_stop(&_TOF);
+    _isContinuous = false;
+}
+
 ///////////////////////////////////////////////////////////////////////
 // stopMeasuring()
 //
@@ -475,7 +772,8 @@ void QwDevTMF882X::stopMeasuring(void)
 int QwDevTMF882X::measurementLoop(uint16_t reqMeasurements, uint32_t timeout)
 {
 
-    if (!_isInitialized)
+    // The blocking loop can't run while in continuous mode
+    if (!_isInitialized || _isContinuous)
         return -1;
 
     // Setup for the measurement internval
@@ -483,8 +781,18 @@ int QwDevTMF882X::measurementLoop(uint16_t reqMeasurements, uint32_t timeout)
     _lastMeasurement = nullptr;
     _nMeasurements = 0; // internal counter
 
+    // Any interrupt seen before now is stale
+    _irqPending = false;
+    _irqStamped = false;
+
+    resetPollSchedule();
+    resetDepthFrame();
+    resetFilter();
+    resetGovernor();
+
     // if you want to measure forever, you need CB function, or a timeout set
-    if (reqMeasurements == 0 && !(_measurementHandlerCB || _histogramHandlerCB || _messageHandlerCB || timeout))
+    if (reqMeasurements == 0 && !(_measurementHandlerCB || _compactHandlerCB || _depthFrameHandlerCB ||
+                                  _captureHandlerCB || _histogramHandlerCB || _messageHandlerCB || timeout))
         return -1;
 
     if (tmf882x_start(&_TOF))
@@ -500,7 +808,7 @@ int QwDevTMF882X::measurementLoop(uint16_t reqMeasurements, uint32_t timeout)
     do
     {
         // data collection/process pump for SDK
-        if (tmf882x_process_irq(&_TOF)) // something went wrong
+        if (serviceDevice()) // something went wrong
             break;
 
         if (_stopMeasuring) // caller set the stop flag
@@ -514,8 +822,8 @@ int QwDevTMF882X::measurementLoop(uint16_t reqMeasurements, uint32_t timeout)
         if (timeout && sfe_millis() - startTime >= timeout)
             break;
 
-        // yield
-        sfe_msleep(_sampleDelayMS); // milli sec poll period
+        // yield - until the INT pin signals, or the next poll is due
+        waitForNextPoll();
 
     } while (true);
 
@@ -525,83 +833,1206 @@ int QwDevTMF882X::measurementLoop(uint16_t reqMeasurements, uint32_t timeout)
 }
 
 //////////////////////////////////////////////////////////////////////////////
-// sdk_msg_handler()
-//
-// "Internal" method used to process messages from the SDK
+// serviceDevice()
 //
-// The methods in the sfe_shim call this, passing in the message structure from
-// the SDK.
+// Internal, private method. Performs one processing pass of the device - used
+// by the measurement loop and service().
 //
-// This method processes the message and dispatches to registered callback functions
+//  Parameter           Description
+//  ---------           -----------------------------
+//  retval              0 on success, -1 on error
 
-int32_t QwDevTMF882X::sdkMessageHandler(struct tmf882x_msg *msg)
+int32_t QwDevTMF882X::serviceDevice(void)
 {
-    if (!msg || !_isInitialized)
-        return false;
+    // In interrupt mode, clear the ready flag before servicing the device. If
+    // the ISR fires while we are processing, the flag is set again.
+    if (_interruptMode)
+        _irqPending = false;
 
-    // Do we have a general handler set
-    if (_messageHandlerCB)
-        _messageHandlerCB(msg);
+    uint16_t nMessages = _nMessages;
 
-    // Check the message type - call type handler methods if we have one
-    switch (msg->hdr.msg_id)
+    int32_t rc = tmf882x_process_irq(&_TOF) ? -1 : 0;
+
+    // Apply a step of the governor, now the SDK is done with the message. A step
+    // waits while a config transaction is open.
+    if (_governorPending && !rc && !_stopMeasuring && !_inConfig && !applyGovernor())
+        rc = -1;
+
+    // Did this pass find anything to read?
+    _pollStats.polls++;
+    if (nMessages == _nMessages)
     {
+        _pollStats.wastedPolls++;
+        _emptyPollThisFrame = true;
+    }
 
-    case ID_MEAS_RESULTS:
+    scheduleNextPoll();
 
-        _nMeasurements++;
-        _lastMeasurement = &msg->meas_result_msg;
+    return rc;
+}
 
-        if (_measurementHandlerCB)
-            _measurementHandlerCB(_lastMeasurement);
-        break;
+//////////////////////////////////////////////////////////////////////////////
+// resetPollSchedule()
+//
+// Internal, private method. Resets the poll scheduler at the start of a
+// measurement session - the first poll takes place right away.
 
-    case ID_HISTOGRAM:
+void QwDevTMF882X::resetPollSchedule(void)
+{
+    _nextPollUS = sfe_micros();
+    _emptyPollThisFrame = false;
+    _haveSysTicks = false;
+    _lastSysTicks = 0;
+    _lastResultNum = 0;
+    _framePeriodUS = 0;
+    _haveNextFrame = false;
+    _nextFrameUS = 0;
+}
 
-        if (_histogramHandlerCB)
-            _histogramHandlerCB(&msg->hist_msg);
-        break;
+//////////////////////////////////////////////////////////////////////////////
+// framePeriodUS()
+//
+// Internal, private method. Returns the frame period of the device. If not
+// measured yet, the report period from the cached device config is used.
+//
+//  Parameter           Description
+//  ---------           -----------------------------
+//  retval              The frame period in micro-seconds, 0 if unknown
 
-    case ID_MEAS_STATS:
+uint32_t QwDevTMF882X::framePeriodUS(void)
+{
+    if (_framePeriodUS)
+        return _framePeriodUS;
 
-        if (_statsHandlerCB)
-            _statsHandlerCB(&msg->meas_stat_msg);
-        break;
+    return (uint32_t)_TOF.app.volat_data.cfg.report_period_ms * 1000;
+}
 
-    case ID_ERROR:
+//////////////////////////////////////////////////////////////////////////////
+// scheduleNextPoll()
+//
+// Internal, private method. Called after each processing pass of the device
+// to set the time of the next pass.
+//
+// With a fixed poll period (or in interrupt mode, as a backstop), this is the
+// sample delay. With adaptive polling, the next pass is just before the next
+// result is due. If the result isn't there yet, the device is polled in small
+// steps until it arrives.
 
-        if (_errorHandlerCB)
-            _errorHandlerCB(&msg->err_msg);
-        break;
+void QwDevTMF882X::scheduleNextPoll(void)
+{
+    uint32_t now = sfe_micros();
+    uint32_t period = framePeriodUS();
 
-    default:
-        break;
+    if (!_adaptivePolling || _interruptMode || !period)
+    {
+        _nextPollUS = now + (uint32_t)_sampleDelayMS * 1000;
+        return;
     }
 
-    return 0;
+    uint32_t step = period / kPollStepDivisor;
+    if (step < kMinPollStepUS)
+        step = kMinPollStepUS;
+
+    // Wake up a step before the next result is due. If that time has passed, or we
+    // haven't locked on to the device cadence yet, poll again in a step.
+    uint32_t wakeUS = _nextFrameUS - step;
+
+    _nextPollUS = (_haveNextFrame && (int32_t)(wakeUS - now) > 0) ? wakeUS : now + step;
 }
 
-///////////////////////////////////////////////////////////////////////
-// setMeasurementHandler()
-//
-// Data values from the TMF882X are sent from the AMS SDK using a
-// callback/message pattern.
+//////////////////////////////////////////////////////////////////////////////
+// waitForNextPoll()
 //
-// Call this method with a function to call when measurement data is
-// sent from the AMS sdk.
+// Internal, private method. Waits until the next poll of the device is due.
 //
-//  Parameter   Description
-//  ---------   -----------------------------
-//  handler     The function to call when measurement data is sent from the SDK
+// In interrupt mode, the wait ends as soon as the host ISR signals an interrupt
+// from the TMF882X INT pin. The scheduled poll is a backstop - if an interrupt
+// edge is missed, the device is still serviced.
 
-void QwDevTMF882X::setMeasurementHandler(TMF882XMeasurementHandler handler)
+void QwDevTMF882X::waitForNextPoll(void)
 {
-    if (handler)
-        _measurementHandlerCB = handler;
+    int32_t remaining;
+
+    while (!(_interruptMode && _irqPending) && (remaining = (int32_t)(_nextPollUS - sfe_micros())) > 0)
+    {
+        // Sleep when not waiting on the INT pin - yield for any sub milli-sec remainder
+        if (!_interruptMode && remaining >= 1000)
+            sfe_msleep(remaining / 1000);
+        else
+            sfe_yield();
+    }
 }
 
-///////////////////////////////////////////////////////////////////////
-// setHistogramHandler()
+//////////////////////////////////////////////////////////////////////////////
+// updateFrameCadence()
+//
+// Internal, private method. Called for each measurement result to track the
+// cadence of the device, and predict when the next result is due.
+//
+// The frame period is measured using the sys_ticks value of the results, which
+// come from the 5 MHz clock of the device.
+//
+//  Parameter           Description
+//  ---------           -----------------------------
+//  results             The measurement results
+
+void QwDevTMF882X::updateFrameCadence(struct tmf882x_msg_meas_results *results)
+{
+    uint32_t now = sfe_micros();
+
+    _pollStats.frames++;
+
+    // How far off was the prediction for this result?
+    if (_haveNextFrame)
+    {
+        int32_t delta = (int32_t)(now - _nextFrameUS);
+        uint32_t jitter = delta < 0 ? -delta : delta;
+
+        if (jitter > _pollStats.jitterMaxUS)
+            _pollStats.jitterMaxUS = jitter;
+
+        _jitterTotalUS += jitter;
+        _jitterCount++;
+    }
+
+    // Measure the device frame period. The LSB of sys_ticks must be set for
+    // the value to be valid.
+    if (results->sys_ticks & 0x01)
+    {
+        uint8_t nFrames = (uint8_t)(results->result_num - _lastResultNum);
+
+        if (_haveSysTicks && nFrames)
+        {
+            uint32_t period = (results->sys_ticks - _lastSysTicks) / kTMF882XSysTicksPerUS / nFrames;
+            uint32_t cfgPeriod = (uint32_t)_TOF.app.volat_data.cfg.report_period_ms * 1000;
+
+            // sanity check against the configured period - ignore gaps from a restart..etc
+            if (!cfgPeriod || (period >= cfgPeriod / 8 && period <= cfgPeriod * 4))
+                _framePeriodUS = period;
+        }
+        _lastSysTicks = results->sys_ticks;
+        _lastResultNum = (uint8_t)results->result_num;
+        _haveSysTicks = true;
+    }
+
+    uint32_t period = framePeriodUS();
+    if (!period)
+    {
+        _haveNextFrame = false;
+        return;
+    }
+
+    uint32_t step = period / kPollStepDivisor;
+    if (step < kMinPollStepUS)
+        step = kMinPollStepUS;
+
+    // When did this result become ready? If an empty poll came first, it was
+    // within the last poll step. If not, it could of been waiting - so assume
+    // a step earlier, and the next wait will start earlier.
+    uint32_t readyUS = now - (_emptyPollThisFrame ? step / 2 : step);
+
+    _nextFrameUS = readyUS + period;
+    _haveNextFrame = true;
+    _emptyPollThisFrame = false;
+    _pollStats.periodUS = period;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// getPollStats()
+//
+// Returns statistics on how the device was polled.
+//
+//  Parameter    Description
+//  ---------    -----------------------------
+//  stats        Struct to hold the poll stats
+
+void QwDevTMF882X::getPollStats(TMF882XPollStats &stats)
+{
+    stats = _pollStats;
+    stats.jitterAvgUS = _jitterCount ? (uint32_t)(_jitterTotalUS / _jitterCount) : 0;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// resetPollStats()
+//
+// Clear the collected poll stats
+
+void QwDevTMF882X::resetPollStats(void)
+{
+    memset(&_pollStats, 0, sizeof(_pollStats));
+    _jitterTotalUS = 0;
+    _jitterCount = 0;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// resetTimeSync()
+//
+// Restart the device clock model used to stamp results with a capture time.
+
+void QwDevTMF882X::resetTimeSync(void)
+{
+    _tsHaveAnchor = false;
+    _tsAnchorTicks = 0;
+    _tsAnchorUS = 0;
+    _tsSkewPPM = 0;
+    _tsHaveBase = false;
+    _tsBaseTicks = 0;
+    _tsBaseUS = 0;
+    _tsWindowTicks = 0;
+    _tsWindowMinUS = INT32_MAX;
+    _tsWindowMinTicks = 0;
+    _tsWindowMinArrivalUS = 0;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// stampCaptureTime()
+//
+// Internal, private method. Called for each measurement result to estimate the
+// host time it was captured at, from its sys_ticks value.
+//
+// The arrival of a result on the host is its capture time plus some latency.
+// The model is anchored to the result with the least latency - the lower
+// envelope of the arrivals. A result that arrives before its estimate shows
+// the anchor had latency, so it becomes the anchor. Each window, the anchor
+// moves to the result with the least latency in the window, and the skew of
+// the device clock is measured from the first anchor to it.
+//
+//  Parameter           Description
+//  ---------           -----------------------------
+//  results             The measurement results
+//  arrivalUS           Host time the results arrived at
+
+void QwDevTMF882X::stampCaptureTime(struct tmf882x_msg_meas_results *results, uint32_t arrivalUS)
+{
+    uint32_t captureUS = arrivalUS;
+
+    // The LSB of sys_ticks must be set for the value to be valid - if not, all
+    // there is to go on is the arrival time.
+    if (results->sys_ticks & 0x01)
+    {
+        uint32_t ticks = results->sys_ticks;
+        int32_t latency = 0;
+
+        if (_tsHaveAnchor)
+        {
+            uint32_t sinceUS = (ticks - _tsAnchorTicks) / kTMF882XSysTicksPerUS;
+
+            captureUS = _tsAnchorUS + sinceUS + (int32_t)((int64_t)sinceUS * _tsSkewPPM / 1000000);
+            latency = (int32_t)(arrivalUS - captureUS);
+
+            // Did the device clock jump? Start over, keeping the skew
+            if (latency > kTimeSyncMaxErrorUS || latency < -kTimeSyncMaxErrorUS)
+            {
+                _tsHaveAnchor = false;
+                _tsHaveBase = false;
+            }
+        }
+
+        if (!_tsHaveAnchor || latency < 0)
+        {
+            if (!_tsHaveAnchor)
+            {
+                _tsWindowTicks = ticks;
+                _tsWindowMinUS = INT32_MAX;
+                _tsHaveAnchor = true;
+            }
+            _tsAnchorTicks = ticks;
+            _tsAnchorUS = arrivalUS;
+            captureUS = arrivalUS;
+            latency = 0;
+        }
+
+        if (latency < _tsWindowMinUS)
+        {
+            _tsWindowMinUS = latency;
+            _tsWindowMinTicks = ticks;
+            _tsWindowMinArrivalUS = arrivalUS;
+        }
+
+        // End of the window? The best result of the window becomes the anchor, and
+        // the skew is measured from the base - the first anchor - to it. The longer
+        // the span, the less the latency of the two results matters.
+        if ((ticks - _tsWindowTicks) / kTMF882XSysTicksPerUS >= kTimeSyncWindowUS)
+        {
+            uint32_t deviceUS = (_tsWindowMinTicks - _tsBaseTicks) / kTMF882XSysTicksPerUS;
+
+            if (_tsHaveBase && deviceUS >= kTimeSyncWindowUS)
+            {
+                int32_t hostUS = (int32_t)(_tsWindowMinArrivalUS - _tsBaseUS);
+                int32_t skew = (int32_t)(((int64_t)hostUS - deviceUS) * 1000000 / deviceUS);
+
+                if (skew <= kTimeSyncMaxSkewPPM && skew >= -kTimeSyncMaxSkewPPM)
+                    _tsSkewPPM = skew;
+            }
+
+            // Move the base before the sys_ticks span gets too long
+            if (!_tsHaveBase || deviceUS >= kTimeSyncMaxSpanUS)
+            {
+                _tsBaseTicks = _tsWindowMinTicks;
+                _tsBaseUS = _tsWindowMinArrivalUS;
+                _tsHaveBase = true;
+            }
+
+            _tsAnchorTicks = _tsWindowMinTicks;
+            _tsAnchorUS = _tsWindowMinArrivalUS;
+            _tsWindowTicks = ticks;
+            _tsWindowMinUS = INT32_MAX;
+        }
+    }
+
+    results->host_time_us = captureUS;
+    _TOF.app.volat_data.compact.host_time_us = captureUS;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// signalInterrupt()
+//
+// Called from the host ISR attached to the INT pin of the TMF882X. Only records
+// the time of the interrupt and sets a ready flag - it is safe to call from an ISR.
+
+void QwDevTMF882X::signalInterrupt(void)
+{
+    _irqTimeUS = sfe_micros();
+    _irqStamped = true;
+    _irqPending = true;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// getInterruptTime()
+//
+// Internal, private method. Reads the time of the last interrupt, and if one
+// was recorded, with the ISR held off - on 8 bit boards a 32 bit read isn't
+// a single instruction, and an interrupt in the middle of it tears the value.
+//
+//  Parameter   Description
+//  ---------   -----------------------------
+//  timeUS      The interrupt time
+//  clear       Use up the interrupt time
+//  retval      true if an interrupt time was recorded
+
+bool QwDevTMF882X::getInterruptTime(uint32_t &timeUS, bool clear)
+{
+    sfe_disable_interrupts();
+
+    bool stamped = _irqStamped;
+    timeUS = _irqTimeUS;
+
+    if (clear)
+        _irqStamped = false;
+
+    sfe_enable_interrupts();
+
+    return stamped;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// getLatencyStats()
+//
+// Returns the latency, from interrupt to measurement callback dispatch, of
+// the results taken.
+//
+//  Parameter    Description
+//  ---------    -----------------------------
+//  stats        Struct to hold the latency stats
+
+void QwDevTMF882X::getLatencyStats(TMF882XLatencyStats &stats)
+{
+    stats = _latency;
+    stats.avgUS = _latency.count ? (uint32_t)(_latencyTotalUS / _latency.count) : 0;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// resetLatencyStats()
+//
+// Clear the collected latency stats
+
+void QwDevTMF882X::resetLatencyStats(void)
+{
+    memset(&_latency, 0, sizeof(_latency));
+    _latencyTotalUS = 0;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// setFrameBuffer()
+//
+// Set the buffer used to queue measurement results for the application. The
+// buffer is provided by the caller - nullptr disables the frame buffer.
+//
+//  Parameter    Description
+//  ---------    -----------------------------
+//  frames       Array of result slots, or nullptr to disable
+//  nSlots       Number of slots in the array - 2 to kMaxFrameBufferSlots
+//  retval       true on success, false on error
+
+bool QwDevTMF882X::setFrameBuffer(struct tmf882x_msg_meas_results *frames, uint16_t nSlots)
+{
+    return setupFrameBuffer((uint8_t *)frames, nSlots, sizeof(tmf882x_msg_meas_results), false);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// setFrameBuffer()
+//
+// Set a frame buffer that holds results in the compact layout.
+//
+//  Parameter    Description
+//  ---------    -----------------------------
+//  frames       Array of compact result slots, or nullptr to disable
+//  nSlots       Number of slots in the array - 2 to kMaxFrameBufferSlots
+//  retval       true on success, false on error
+
+bool QwDevTMF882X::setFrameBuffer(struct tmf882x_meas_compact *frames, uint16_t nSlots)
+{
+    return setupFrameBuffer((uint8_t *)frames, nSlots, sizeof(tmf882x_meas_compact), true);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// setupFrameBuffer()
+//
+// Internal, private method. Setup the frame buffer for slots of the given size.
+
+bool QwDevTMF882X::setupFrameBuffer(uint8_t *frames, uint16_t nSlots, uint16_t frameSize, bool isCompact)
+{
+    // can't swap the buffer out from under the producer
+    if (_isContinuous)
+        return false;
+
+    if (frames && (nSlots < 2 || nSlots > kMaxFrameBufferSlots))
+        return false;
+
+    _frameBuffer = frames;
+    _frameSlots = frames ? nSlots : 0;
+    _frameSize = frameSize;
+    _frameCompact = isCompact;
+    _frameHead = 0;
+    _frameTail = 0;
+    _frameOverruns = 0;
+
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// framesAvailable()
+//
+// Returns the number of results waiting in the frame buffer
+
+uint16_t QwDevTMF882X::framesAvailable(void)
+{
+    if (!_frameBuffer)
+        return 0;
+
+    uint8_t head = _frameHead;
+    uint8_t tail = _frameTail;
+
+    return head >= tail ? head - tail : _frameSlots - tail + head;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// peekSlot()
+//
+// Internal, private method. Returns the slot of the oldest result in the frame
+// buffer, or nullptr if the buffer is empty. Consumer side.
+
+uint8_t *QwDevTMF882X::peekSlot(void)
+{
+    if (!_frameBuffer || _frameTail == _frameHead)
+        return nullptr;
+
+    // make sure the slot contents are read after the head index
+    frameBufferBarrier();
+
+    return _frameBuffer + (uint32_t)_frameTail * _frameSize;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// peekFrame()
+//
+// Returns a pointer to the oldest result in the frame buffer, or nullptr if
+// the buffer is empty or holds compact results.
+
+struct tmf882x_msg_meas_results *QwDevTMF882X::peekFrame(void)
+{
+    return _frameCompact ? nullptr : (struct tmf882x_msg_meas_results *)peekSlot();
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// peekCompactFrame()
+//
+// Returns a pointer to the oldest compact result in the frame buffer, or
+// nullptr if the buffer is empty or holds full results.
+
+struct tmf882x_meas_compact *QwDevTMF882X::peekCompactFrame(void)
+{
+    return _frameCompact ? (struct tmf882x_meas_compact *)peekSlot() : nullptr;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// releaseFrame()
+//
+// Free the slot of the oldest result in the frame buffer. Consumer side.
+
+void QwDevTMF882X::releaseFrame(void)
+{
+    if (!_frameBuffer || _frameTail == _frameHead)
+        return;
+
+    uint8_t next = _frameTail + 1;
+
+    // done with the slot before handing it back to the producer
+    frameBufferBarrier();
+
+    _frameTail = next == _frameSlots ? 0 : next;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// readFrame()
+//
+// Copy the oldest result out of the frame buffer, and free its slot.
+//
+//  Parameter    Description
+//  ---------    -----------------------------
+//  results      Struct to hold the result
+//  retval       true if a result was returned, false if the buffer is empty
+
+bool QwDevTMF882X::readFrame(struct tmf882x_msg_meas_results &results)
+{
+    struct tmf882x_msg_meas_results *frame = peekFrame();
+
+    if (!frame)
+        return false;
+
+    memcpy(&results, frame, sizeof(tmf882x_msg_meas_results));
+
+    releaseFrame();
+
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// readFrame()
+//
+// Copy the oldest compact result out of the frame buffer, and free its slot.
+//
+//  Parameter    Description
+//  ---------    -----------------------------
+//  results      Struct to hold the result
+//  retval       true if a result was returned, false if the buffer is empty
+
+bool QwDevTMF882X::readFrame(struct tmf882x_meas_compact &results)
+{
+    struct tmf882x_meas_compact *frame = peekCompactFrame();
+
+    if (!frame)
+        return false;
+
+    memcpy(&results, frame, sizeof(tmf882x_meas_compact));
+
+    releaseFrame();
+
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// queueFrame()
+//
+// Internal, private method. Copy a received result into the next free slot of
+// the frame buffer. Producer side - if the buffer is full, the result is dropped.
+
+void QwDevTMF882X::queueFrame(struct tmf882x_msg_meas_results *results)
+{
+    if (!_frameBuffer)
+        return;
+
+    uint8_t head = _frameHead;
+    uint8_t next = head + 1 == _frameSlots ? 0 : head + 1;
+
+    if (next == _frameTail)
+    {
+        _frameOverruns++;
+        return;
+    }
+
+    // make sure the consumer is done with the slot before writing it
+    frameBufferBarrier();
+
+    // compact results are kept by the SDK with each result
+    memcpy(_frameBuffer + (uint32_t)head * _frameSize,
+           _frameCompact ? (void *)&_TOF.app.volat_data.compact : (void *)results, _frameSize);
+
+    // the slot is written before it's published
+    frameBufferBarrier();
+
+    _frameHead = next;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// resetDepthFrame()
+//
+// Internal, private method. Resets depth frame assembly at the start of a
+// measurement session, and picks up the number of captures in a frame from the
+// mode of the device.
+
+void QwDevTMF882X::resetDepthFrame(void)
+{
+    _depthLastCapture = 0;
+    _depthFrameCount = 0;
+
+    // picked up with or without a handler - one can be set while measuring
+    _depthCaptures = get8x8Mode() ? kMaxDepthFrameCaptures : 1;
+
+    if (!_depthFrameHandlerCB)
+        return;
+
+    _depthFrame->captureMask = 0;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// resetFilter()
+//
+// Internal, private method. Resets the zones of the filter, and picks up the
+// number of captures in a frame from the mode of the device.
+
+void QwDevTMF882X::resetFilter(void)
+{
+    if (!_filter)
+        return;
+
+    _filter->reset();
+
+    _filterCaptures = get8x8Mode() ? kMaxDepthFrameCaptures : 1;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// resetGovernor()
+//
+// Internal, private method. Resets the frame counts of the governor, and picks
+// up the number of captures in a frame from the mode of the device.
+
+void QwDevTMF882X::resetGovernor(void)
+{
+    _governorPending = false;
+
+    if (!_governor)
+        return;
+
+    _governor->reset();
+
+    _governorCaptures = get8x8Mode() ? kMaxDepthFrameCaptures : 1;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// applyGovernor()
+//
+// Internal, private method. Applies the step the governor asked for to the
+// cached config of the device, and writes the fields that change. The device
+// restarts measuring, with a new period.
+//
+//  Parameter           Description
+//  ---------           -----------------------------
+//  retval              true on success, false on error
+
+bool QwDevTMF882X::applyGovernor(void)
+{
+    _governorPending = false;
+
+    struct tmf882x_mode_app_config tofConfig = _TOF.app.volat_data.cfg;
+
+    if (!_governor->adjust(tofConfig))
+        return true;
+
+    if (tmf882x_ioctl(&_TOF, IOCAPP_UPDATE_CFG, &tofConfig, NULL))
+        return false;
+
+    // A new cadence, and the frame in progress is dropped
+    resetPollSchedule();
+    resetDepthFrame();
+
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// restoreCalibration()
+//
+// Internal, private method. Sets the calibration kept in the calibration store
+// for the device and its mode. If there is none, runs a factory calibration
+// and saves it - a failed save doesn't fail this call, the device is calibrated.
+//
+//  Parameter           Description
+//  ---------           -----------------------------
+//  retval              true on success, false on error
+
+bool QwDevTMF882X::restoreCalibration(void)
+{
+    struct tmf882x_mode_app_dev_UID devUID;
+
+    if (!getDeviceUniqueID(devUID))
+        return false;
+
+    bool is8x8 = get8x8Mode();
+    struct tmf882x_mode_app_calib tofCalib;
+
+    if (_calStore->load(devUID, is8x8, tofCalib))
+        return setCalibration(tofCalib);
+
+    // Not in the store - calibrate with the iterations the calibration needs
+    struct tmf882x_mode_app_config tofConfig;
+
+    if (!getTMF882XConfig(tofConfig))
+        return false;
+
+    uint16_t kiloIterations = tofConfig.kilo_iterations;
+    tofConfig.kilo_iterations = kFactoryCalKiloIterations;
+
+    if (tmf882x_ioctl(&_TOF, IOCAPP_UPDATE_CFG, &tofConfig, NULL))
+        return false;
+
+    bool calibrated = factoryCalibration(tofCalib);
+
+    tofConfig.kilo_iterations = kiloIterations;
+    if (tmf882x_ioctl(&_TOF, IOCAPP_UPDATE_CFG, &tofConfig, NULL) || !calibrated)
+        return false;
+
+    if (!_calStore->save(devUID, is8x8, tofCalib))
+        tof_err((void *)this, "ERROR - Unable to save the TMF882X calibration");
+
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// clearSPADCache()
+//
+// Internal, private method. Marks all the entries of the SPAD cache as empty.
+
+void QwDevTMF882X::clearSPADCache(void)
+{
+    for (uint8_t i = 0; i < _spadCacheSize; i++)
+        _spadCache[i].lastUsed = 0;
+
+    _spadCacheUses = 0;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// spadConfigKey()
+//
+// Internal, private method. Returns the SPAD cache key of a SPAD configuration -
+// a 32 bit FNV-1a hash of the SPAD map id and the parts of the configuration
+// that are in use.
+//
+//  Parameter           Description
+//  ---------           -----------------------------
+//  idSPAD              The SPAD map id in use on the device
+//  spadConfig          The SPAD configuration
+//  retval              The key
+
+uint32_t QwDevTMF882X::spadConfigKey(uint8_t idSPAD, const struct tmf882x_mode_app_spad_config &spadConfig)
+{
+    uint32_t nConfigs = spadConfig.num_spad_configs;
+
+    if (nConfigs > TMF8X2X_MAX_CONFIGURATIONS)
+        nConfigs = TMF8X2X_MAX_CONFIGURATIONS;
+
+    uint32_t hash = fnvHash(kFNVOffsetBasis, &idSPAD, 1);
+    hash = fnvHash(hash, (const uint8_t *)&nConfigs, sizeof(nConfigs));
+
+    for (uint32_t i = 0; i < nConfigs; i++)
+    {
+        const struct tmf882x_mode_app_spad_config::tmf882x_mode_app_single_spad_config &single =
+            spadConfig.spad_configs[i];
+
+        uint16_t nSPADs = single.xsize * single.ysize;
+        if (nSPADs > TMF8X2X_COM_MAX_SPAD_SIZE)
+            nSPADs = TMF8X2X_COM_MAX_SPAD_SIZE;
+
+        // offsets and sizes, then the mask and map
+        hash = fnvHash(hash, (const uint8_t *)&single, 4);
+        hash = fnvHash(hash, single.spad_mask, nSPADs);
+        hash = fnvHash(hash, single.spad_map, nSPADs);
+    }
+
+    return hash;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// assembleDepthFrame()
+//
+// Internal, private method. Add a received result to the depth frame being
+// assembled. The frame is sent to the handler once all of its captures are
+// received, or when a capture of a later frame arrives.
+
+void QwDevTMF882X::assembleDepthFrame(struct tmf882x_meas_compact *results)
+{
+    if (!_depthFrameHandlerCB)
+        return;
+
+    // The result number counts captures, so the frame ID is the same for all
+    // the captures of a frame. The result number is 8 bits and wraps on a frame.
+    uint8_t capture = results->result_num % _depthCaptures;
+    uint8_t frameID = results->result_num / _depthCaptures;
+
+    // A capture of a new frame - send the pending frame, it's missing captures
+    if (_depthFrame->captureMask && frameID != _depthFrameID)
+        sendDepthFrame();
+
+    if (!_depthFrame->captureMask)
+    {
+        _depthFrameID = frameID;
+        _depthFrame->outOfOrder = false;
+    }
+    else if (capture <= _depthLastCapture)
+        _depthFrame->outOfOrder = true;
+
+    memcpy(&_depthFrame->captures[capture], results, sizeof(struct tmf882x_meas_compact));
+
+    _depthFrame->captureMask |= 1 << capture;
+    _depthLastCapture = capture;
+
+    if (_depthFrame->captureMask == (1 << _depthCaptures) - 1)
+        sendDepthFrame();
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// sendDepthFrame()
+//
+// Internal, private method. Pass the depth frame to the handler, and start the
+// next frame.
+
+void QwDevTMF882X::sendDepthFrame(void)
+{
+    _depthFrame->nCaptures = _depthCaptures;
+    _depthFrame->complete = _depthFrame->captureMask == (1 << _depthCaptures) - 1;
+    _depthFrame->frameNum = _depthFrameCount++;
+
+    _depthFrameHandlerCB(_depthFrame);
+
+    _depthFrame->captureMask = 0;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// sdk_msg_handler()
+//
+// "Internal" method used to process messages from the SDK
+//
+// The methods in the sfe_shim call this, passing in the message structure from
+// the SDK.
+//
+// This method processes the message and dispatches to registered callback functions
+
+int32_t QwDevTMF882X::sdkMessageHandler(struct tmf882x_msg *msg)
+{
+    if (!msg || !_isInitialized)
+        return false;
+
+    _nMessages++;
+
+    // When did the results arrive? The recorded time if replayed, the interrupt
+    // time if the INT pin signaled them. The stamp is used up by results.
+    uint32_t irqTimeUS = 0;
+    bool irqStamped = !_replayActive && getInterruptTime(irqTimeUS, msg->hdr.msg_id == ID_MEAS_RESULTS);
+    uint32_t arrivalUS = _replayActive ? _replayTimeUS : irqStamped ? irqTimeUS : sfe_micros();
+
+    // If the INT pin signaled these results, track the latency from the
+    // interrupt to the callback dispatch
+    if (msg->hdr.msg_id == ID_MEAS_RESULTS && irqStamped)
+    {
+        uint32_t latency = sfe_micros() - irqTimeUS;
+
+        if (!_latency.count || latency < _latency.minUS)
+            _latency.minUS = latency;
+        if (latency > _latency.maxUS)
+            _latency.maxUS = latency;
+
+        _latency.lastUS = latency;
+        _latency.count++;
+        _latencyTotalUS += latency;
+    }
+
+    // Stamp and filter results before any handler sees them
+    if (msg->hdr.msg_id == ID_MEAS_RESULTS)
+    {
+        stampCaptureTime(&msg->meas_result_msg, arrivalUS);
+
+        if (_filter)
+            _filter->filter(&msg->meas_result_msg, &_TOF.app.volat_data.compact,
+                            msg->meas_result_msg.result_num % _filterCaptures);
+    }
+
+    // Do we have a general handler set
+    if (_messageHandlerCB)
+        _messageHandlerCB(msg);
+
+    // Check the message type - call type handler methods if we have one
+    switch (msg->hdr.msg_id)
+    {
+
+    case ID_MEAS_RESULTS:
+
+        _nMeasurements++;
+        _lastMeasurement = &msg->meas_result_msg;
+
+        updateFrameCadence(_lastMeasurement);
+
+        // The governor sees each frame - the last capture of the frame ends it
+        if (_governor && !_replayActive)
+        {
+            uint8_t capture = _lastMeasurement->result_num % _governorCaptures;
+
+            if (_governor->update(_lastMeasurement, capture == _governorCaptures - 1))
+                _governorPending = true;
+        }
+
+        queueFrame(_lastMeasurement);
+
+        if (_measurementHandlerCB)
+            _measurementHandlerCB(_lastMeasurement);
+
+        if (_compactHandlerCB)
+            _compactHandlerCB(&_TOF.app.volat_data.compact);
+
+        assembleDepthFrame(&_TOF.app.volat_data.compact);
+
+        // The results complete the capture
+        if (_captureHandlerCB && _TOF.app.capture)
+            _captureHandlerCB(_TOF.app.capture);
+        break;
+
+    case ID_HISTOGRAM:
+
+        if (_histogramHandlerCB)
+            _histogramHandlerCB(&msg->hist_msg);
+        break;
+
+    case ID_MEAS_STATS:
+
+        if (_statsHandlerCB)
+            _statsHandlerCB(&msg->meas_stat_msg);
+        break;
+
+    case ID_ERROR:
+
+        if (_errorHandlerCB)
+            _errorHandlerCB(&msg->err_msg);
+        break;
+
+    default:
+        break;
+    }
+
+    return 0;
+}
+
+///////////////////////////////////////////////////////////////////////
+// setMeasurementHandler()
+//
+// Data values from the TMF882X are sent from the AMS SDK using a
+// callback/message pattern.
+//
+// Call this method with a function to call when measurement data is
+// sent from the AMS sdk.
+//
+//  Parameter   Description
+//  ---------   -----------------------------
+//  handler     The function to call when measurement data is sent from the SDK
+
+void QwDevTMF882X::setMeasurementHandler(TMF882XMeasurementHandler handler)
+{
+    if (handler)
+        _measurementHandlerCB = handler;
+}
+
+///////////////////////////////////////////////////////////////////////
+// setCompactHandler()
+//
+// Call this method with a function to call when measurement data is
+// sent from the AMS sdk, in the compact, per-zone, layout.
+//
+//  Parameter   Description
+//  ---------   -----------------------------
+//  handler     The function to call when measurement data is sent from the SDK
+
+void QwDevTMF882X::setCompactHandler(TMF882XCompactHandler handler)
+{
+    if (handler)
+        _compactHandlerCB = handler;
+}
+
+///////////////////////////////////////////////////////////////////////
+// setDepthFrameHandler()
+//
+// Call this method with a function to call when a depth frame is
+// assembled from the measurement results.
+//
+//  Parameter   Description
+//  ---------   -----------------------------
+//  handler     The function to call when a depth frame is assembled
+//  frame       The depth frame to assemble results into
+
+void QwDevTMF882X::setDepthFrameHandler(TMF882XDepthFrameHandler handler, struct TMF882XDepthFrame *frame)
+{
+    if (!handler || !frame)
+        return;
+
+    // start assembly over, with the captures in a frame of the current mode
+    frame->captureMask = 0;
+    _depthLastCapture = 0;
+    _depthCaptures = get8x8Mode() ? kMaxDepthFrameCaptures : 1;
+
+    _depthFrame = frame;
+    _depthFrameHandlerCB = handler;
+}
+
+///////////////////////////////////////////////////////////////////////
+// setCaptureHandler()
+//
+// Call this method with a function to call when all the data of a
+// capture - the results, the raw histograms and the stats - is received.
+//
+//  Parameter   Description
+//  ---------   -----------------------------
+//  handler     The function to call when a capture is received
+//  capture     The buffer to decode capture data into
+//  retval      true on success, false on error
+
+bool QwDevTMF882X::setCaptureHandler(TMF882XCaptureHandler handler, struct tmf882x_capture *capture)
+{
+    if (!_isInitialized || !handler || !capture)
+        return false;
+
+    if (tmf882x_ioctl(&_TOF, IOCAPP_SET_CAPTURE, &capture, NULL))
+        return false;
+
+    _captureHandlerCB = handler;
+
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////
+// setI2CRecorder()
+//
+// Record the raw messages read from the device to a stream encoder.
+//
+//  Parameter   Description
+//  ---------   -----------------------------
+//  encoder     The stream encoder to write to - nullptr to stop recording
+//  retval      true on success, false on error
+
+bool QwDevTMF882X::setI2CRecorder(TMF882XStreamEncoder *encoder)
+{
+    if (!_isInitialized)
+        return false;
+
+    struct tmf882x_mode_app_recorder recorder = {encoder ? recordI2CMessage : nullptr, this};
+
+    if (tmf882x_ioctl(&_TOF, IOCAPP_SET_RECORDER, &recorder, NULL))
+        return false;
+
+    _i2cRecorder = encoder;
+
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////
+// recordI2CMessage()
+//
+// Internal, private method. Called from the SDK with each raw message
+// read from the device.
+//
+//  Parameter   Description
+//  ---------   -----------------------------
+//  context     The device object
+//  i2c_msg     The message read
+
+void QwDevTMF882X::recordI2CMessage(void *context, const struct tmf882x_mode_app_i2c_msg *i2c_msg)
+{
+    QwDevTMF882X *device = (QwDevTMF882X *)context;
+
+    if (!device || !device->_i2cRecorder)
+        return;
+
+    // Same arrival time the capture time is stamped from
+    uint32_t irqTimeUS;
+    device->_i2cRecorder->writeI2CMessage(device->getInterruptTime(irqTimeUS, false) ? irqTimeUS : sfe_micros(),
+                                          i2c_msg);
+}
+
+///////////////////////////////////////////////////////////////////////
+// replayI2CMessage()
+//
+// Pass a recorded raw message through the SDK decoders.
+//
+//  Parameter   Description
+//  ---------   -----------------------------
+//  i2c_msg     The recorded message
+//  timeUS      The host time the message arrived at
+//  restart     Reset the decoder state before the message
+//  retval      true on success, false on error
+
+bool QwDevTMF882X::replayI2CMessage(const struct tmf882x_mode_app_i2c_msg *i2c_msg, uint32_t timeUS, bool restart)
+{
+    if (!_isInitialized || !i2c_msg)
+        return false;
+
+    struct tmf882x_mode_app_replay replay = {i2c_msg, timeUS, restart};
+
+    if (restart)
+    {
+        resetTimeSync();
+        resetFilter();
+    }
+
+    _replayActive = true;
+    _replayTimeUS = timeUS;
+
+    int32_t rc = tmf882x_ioctl(&_TOF, IOCAPP_REPLAY_MSG, &replay, NULL);
+
+    _replayActive = false;
+
+    return rc == 0;
+}
+
+///////////////////////////////////////////////////////////////////////
+// setFilter()
+//
+// Set the filter run on the distances of each zone of the results.
+//
+//  Parameter   Description
+//  ---------   -----------------------------
+//  filter      The filter - nullptr for no filtering
+//  retval      true on success, false on error
+
+bool QwDevTMF882X::setFilter(TMF882XZoneFilter *filter)
+{
+    if (!_isInitialized)
+        return false;
+
+    _filter = filter;
+    resetFilter();
+
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////
+// setGovernor()
+//
+// Adjust the iterations and period of the device to the signal it sees,
+// within the limits of the governor.
+//
+//  Parameter   Description
+//  ---------   -----------------------------
+//  governor    The governor - nullptr for none
+//  retval      true on success, false on error
+
+bool QwDevTMF882X::setGovernor(TMF882XGovernor *governor)
+{
+    if (!_isInitialized)
+        return false;
+
+    _governor = governor;
+    resetGovernor();
+
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////
+// setHistogramHandler()
 //
 // Data values from the TMF882X are sent from the AMS SDK using a
 // callback/message pattern.
@@ -677,10 +2108,88 @@ void QwDevTMF882X::setMessageHandler(TMF882XMessageHandler handler)
         _messageHandlerCB = handler;
 }
 
+//////////////////////////////////////////////////////////////////////////////////
+// beginConfig()
+//
+// Start a config transaction - the changes of the set methods are made to a
+// copy of the cached config, until commitConfig() is called.
+//
+//  Parameter    Description
+//  ---------    -----------------------------
+//  retval       True on success, false on error
+
+bool QwDevTMF882X::beginConfig(void)
+{
+    if (!_isInitialized || _inConfig)
+        return false;
+
+    // The transaction starts from the cached config - read it if it isn't valid
+    if (!_TOF.app.volat_data.cfg_valid && tmf882x_ioctl(&_TOF, IOCAPP_GET_CFG, NULL, &_pendingConfig))
+        return false;
+
+    _pendingConfig = _TOF.app.volat_data.cfg;
+    _pendingI2CAddress = 0;
+    _inConfig = true;
+
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////////
+// commitConfig()
+//
+// Write the config changes of the transaction to the device, and end the
+// transaction. The fields that differ from the cached config are written in
+// one page write - nothing is written if none differ.
+//
+//  Parameter    Description
+//  ---------    -----------------------------
+//  retval       True on success, false on error
+
+bool QwDevTMF882X::commitConfig(void)
+{
+    if (!_isInitialized || !_inConfig)
+        return false;
+
+    uint8_t address = _pendingI2CAddress;
+
+    _inConfig = false;
+    _pendingI2CAddress = 0;
+
+    if (tmf882x_ioctl(&_TOF, IOCAPP_UPDATE_CFG, &_pendingConfig, NULL))
+        return false;
+
+    if (!address || address == _i2cAddress)
+        return true;
+
+    // Now tell the device to switch to the address in the config page.
+    uint8_t cmdCode = TMF8X2X_COM_CMD_STAT__cmd_stat__CMD_I2C_SLAVE_ADDRESS;
+    if (_i2cBus->writeRegisterRegion(_i2cAddress, TMF8X2X_COM_CMD_STAT, &cmdCode, sizeof(uint8_t)))
+        return false;
+
+    // The device answers at the new address, with the command done, once it moved
+    uint32_t startMS = sfe_millis();
+    uint8_t status = 0xFF;
+
+    while (_i2cBus->readRegisterRegion(address, TMF8X2X_COM_CMD_STAT, &status, sizeof(uint8_t)) ||
+           status != TMF8X2X_COM_CMD_STAT__cmd_stat__STAT_OK)
+    {
+        if (sfe_millis() - startMS > kI2CAddressMoveTimeoutMS)
+        {
+            tof_err((void *)this, "ERROR - Device didn't move to I2C address 0x%x", address);
+            return false;
+        }
+        sfe_msleep(1);
+    }
+
+    _i2cAddress = address;
+    return true;
+}
+
 //////////////////////////////////////////////////////////////////////////////////
 // getTMF882XConfig()
 //
-// Get the current configuration settings on the connected TMF882X
+// Get the current configuration settings on the connected TMF882X. The device
+// is only read if the cached config isn't valid.
 //
 //  Parameter    Description
 //  ---------    -----------------------------
@@ -692,6 +2201,20 @@ bool QwDevTMF882X::getTMF882XConfig(struct tmf882x_mode_app_config &tofConfig)
     if (!_isInitialized)
         return false;
 
+    // In a transaction, the config includes the changes made so far
+    if (_inConfig)
+    {
+        tofConfig = _pendingConfig;
+        return true;
+    }
+
+    // The cached config matches the device
+    if (_TOF.app.volat_data.cfg_valid)
+    {
+        tofConfig = _TOF.app.volat_data.cfg;
+        return true;
+    }
+
     // Get the config struct from the underlying SDK
     if (tmf882x_ioctl(&_TOF, IOCAPP_GET_CFG, NULL, &tofConfig))
         return false;
@@ -702,7 +2225,12 @@ bool QwDevTMF882X::getTMF882XConfig(struct tmf882x_mode_app_config &tofConfig)
 //////////////////////////////////////////////////////////////////////////////////
 // setTMF882XConfig()
 //
-// Set the current configuration settings on the connected TMF882X
+// Set the current configuration settings on the connected TMF882X. Only the
+// fields that differ from the cached config are written.
+//
+// In a config transaction, an I2C address that differs from the one on the
+// device is a move to that address, made on commit. Otherwise the config keeps
+// the address move already pending, if any.
 //
 //  Parameter    Description
 //  ---------    -----------------------------
@@ -714,8 +2242,24 @@ bool QwDevTMF882X::setTMF882XConfig(struct tmf882x_mode_app_config &tofConfig)
     if (!_isInitialized)
         return false;
 
+    // In a transaction, the changes wait for the commit
+    if (_inConfig)
+    {
+        uint8_t address = tofConfig.i2c_slave_addr;
+
+        // Keep the pending address - the move goes through setI2CAddress()
+        _pendingConfig = tofConfig;
+        _pendingConfig.i2c_slave_addr =
+            _pendingI2CAddress ? _pendingI2CAddress : _TOF.app.volat_data.cfg.i2c_slave_addr;
+
+        if (address != _TOF.app.volat_data.cfg.i2c_slave_addr)
+            return setI2CAddress(address);
+
+        return true;
+    }
+
     // Set the config in the dvice
-    if (tmf882x_ioctl(&_TOF, IOCAPP_SET_CFG, &tofConfig, NULL))
+    if (tmf882x_ioctl(&_TOF, IOCAPP_UPDATE_CFG, &tofConfig, NULL))
         return false;
     return true;
 }
@@ -816,14 +2360,169 @@ bool QwDevTMF882X::setSPADConfig(struct tmf882x_mode_app_spad_config &spadConfig
     if (!_isInitialized)
         return false;
 
-    // Set the config in the dvice
-    if (tmf882x_ioctl(&_TOF, IOCAPP_SET_SPADCFG, &spadConfig, NULL))
+    if (!_spadCache)
+    {
+        // Set the config in the dvice
+        if (tmf882x_ioctl(&_TOF, IOCAPP_SET_SPADCFG, &spadConfig, NULL))
+            return false;
+
+        return true;
+    }
+
+    // The encoded pages depend on the SPAD map in use on the device
+    if (!_TOF.app.volat_data.cfg_valid)
+    {
+        struct tmf882x_mode_app_config tofConfig;
+
+        if (tmf882x_ioctl(&_TOF, IOCAPP_GET_CFG, NULL, &tofConfig))
+            return false;
+    }
+
+    uint32_t key = spadConfigKey(_TOF.app.volat_data.cfg.spad_map_id, spadConfig);
+
+    // In the cache? Write the kept pages. If not, use an empty entry or the
+    // least recently used one.
+    TMF882XSPADCacheEntry *entry = &_spadCache[0];
+
+    for (uint8_t i = 0; i < _spadCacheSize; i++)
+    {
+        if (_spadCache[i].lastUsed && _spadCache[i].key == key)
+        {
+            if (tmf882x_ioctl(&_TOF, IOCAPP_SET_SPADIMG, &_spadCache[i].image, NULL))
+                return false;
+
+            _spadCache[i].lastUsed = ++_spadCacheUses;
+            return true;
+        }
+        if (_spadCache[i].lastUsed < entry->lastUsed)
+            entry = &_spadCache[i];
+    }
+
+    entry->lastUsed = 0;
+
+    if (tmf882x_ioctl(&_TOF, IOCAPP_SET_SPADCFG_IMG, &spadConfig, &entry->image))
+        return false;
+
+    entry->key = key;
+    entry->lastUsed = ++_spadCacheUses;
+
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////////
+// setSPADCache()
+//
+// Set the SPAD cache used by setSPADConfig(). The first time a SPAD configuration
+// is set, its encoded SPAD config pages are kept in an entry. Setting it again
+// writes the kept pages without reading the device first. Pass nullptr to not
+// use a cache.
+//
+//  Parameter    Description
+//  ---------    -----------------------------
+//  entries      Array of cache entries - provided by the application.
+//  nEntries     Number of entries in the array
+//  retval       True on success, false on error
+
+bool QwDevTMF882X::setSPADCache(TMF882XSPADCacheEntry *entries, uint8_t nEntries)
+{
+    if (entries && !nEntries)
         return false;
 
+    _spadCache = entries;
+    _spadCacheSize = entries ? nEntries : 0;
+
+    clearSPADCache();
+
     return true;
 }
 
 ////////////////////////////////////////////////////////////////////////////////////
+// set8x8Mode()
+//
+// Enable or disable 8x8 mode - TMF8828 devices only.
+//
+//  Parameter    Description
+//  ---------    -----------------------------
+//  enable       true to enable 8x8 mode, false for 3x3/3x6 (TMF8821) mode
+//  retval       True on success, false on error
+
+bool QwDevTMF882X::set8x8Mode(bool enable)
+{
+    if (!_isInitialized)
+        return false;
+
+    if (tmf882x_ioctl(&_TOF, IOCAPP_SET_8X8MODE, &enable, NULL))
+        return false;
+
+    // the SDK restarts measurements after the switch - frames change size
+    resetDepthFrame();
+    resetFilter();
+    resetGovernor();
+    clearSPADCache();
+
+    // the calibration of the new mode
+    if (_calStore && !restoreCalibration())
+        return false;
+
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////////
+// get8x8Mode()
+//
+// Returns true if the device is in 8x8 mode
+//
+//  Parameter    Description
+//  ---------    -----------------------------
+//  retval       True if in 8x8 mode, false if not or on error
+
+bool QwDevTMF882X::get8x8Mode(void)
+{
+    if (!_isInitialized)
+        return false;
+
+    bool is8x8 = false;
+
+    if (tmf882x_ioctl(&_TOF, IOCAPP_IS_8X8MODE, NULL, &is8x8))
+        return false;
+
+    return is8x8;
+}
+
+//////////////////////////////////////////////////////////////////////////////////
+// getZoneMap()
+//
+// Get the zone map of the SPAD map in use.
+//
+//  Parameter    Description
+//  ---------    -----------------------------
+//  zoneMap      Struct to hold the zone map
+//  retval       True on success, false on error
+
+bool QwDevTMF882X::getZoneMap(TMF882XZoneMap &zoneMap)
+{
+    if (!_isInitialized)
+        return false;
+
+    const TMF882XZoneMap *predefined = getTMF882XZoneMap(getCurrentSPADMap());
+
+    if (predefined)
+    {
+        memcpy(&zoneMap, predefined, sizeof(TMF882XZoneMap));
+        return true;
+    }
+
+    // No table - a user defined map, or one that isn't a grid. Derive it from the
+    // SPAD configuration
+    struct tmf882x_mode_app_spad_config spadConfig;
+
+    if (!getSPADConfig(spadConfig))
+        return false;
+
+    return buildTMF882XZoneMap(spadConfig, zoneMap);
+}
+
+//////////////////////////////////////////////////////////////////////////////////
 // setCommunicationBus()
 //
 // Method to set the bus object that is used to communicate with the device
@@ -833,7 +2532,7 @@ bool QwDevTMF882X::setSPADConfig(struct tmf882x_mode_app_spad_config &spadConfig
 //  theBus       The communication bus object
 //  idBus        The id/address of the device on the bus
 
-void QwDevTMF882X::setCommunicationBus(sfe_TMF882X::QwI2C &theBus, uint8_t idBus)
+void QwDevTMF882X::setCommunicationBus(sfe_TMF882X::QwIDeviceBus &theBus, uint8_t idBus)
 {
     _i2cBus = &theBus;
     _i2cAddress = idBus;
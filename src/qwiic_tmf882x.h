@@ -50,13 +50,20 @@
 #include "inc/tmf882x.h"
 #include "tmf882x_interface.h"
 
-#include "qwiic_i2c.h"
+#include "qwiic_bus.h"
+#include "qwiic_tmf882x_zones.h"
 
 // Default I2C address for the device
 #define kDefaultTMF882XAddress 0x41
 
 #define kDefaultSampleDelayMS 500
 
+// Max number of slots in a frame buffer - the indexes are 8 bits
+#define kMaxFrameBufferSlots 255
+
+// Max number of captures in a depth frame - 4 in 8x8 (TMF8828) mode
+#define kMaxDepthFrameCaptures 4
+
 // Flags for enable/disable output messages from the underlying SDK
 
 #define TMF882X_MSG_INFO 0x01
@@ -71,7 +78,7 @@
 // The underlying SDK passes information back to the callee using a callback
 // message handler pattern. There are four types of messages:
 //
-//  - Measurement results
+//  - Measurement results (also available in a compact, per-zone layout)
 //  - Device statistics
 //  - Histogram results
 //  - Error messages
@@ -88,6 +95,9 @@
 // Measurement Handler Type
 typedef void (*TMF882XMeasurementHandler)(struct tmf882x_msg_meas_results *);
 
+// Compact Measurement Handler Type
+typedef void (*TMF882XCompactHandler)(struct tmf882x_meas_compact *);
+
 // Histogram Handler type
 typedef void (*TMF882XHistogramHandler)(struct tmf882x_msg_histogram *);
 
@@ -100,6 +110,121 @@ typedef void (*TMF882XErrorHandler)(struct tmf882x_msg_error *);
 // General Message Handler
 typedef void (*TMF882XMessageHandler)(struct tmf882x_msg *);
 
+// Capture Handler - results, histograms and stats of one capture
+typedef void (*TMF882XCaptureHandler)(struct tmf882x_capture *);
+
+//////////////////////////////////////////////////////////////////////////////
+// Interrupt Latency Stats
+//
+// When the INT pin of the TMF882X is connected to the host, and the host ISR
+// calls signalInterrupt(), the library tracks the time between the interrupt
+// and the dispatch of the measurement results to the callback handlers.
+//
+// All values are in micro-seconds.
+
+struct TMF882XLatencyStats
+{
+    uint32_t count;  // Number of results measured
+    uint32_t lastUS; // Latency of the last result
+    uint32_t minUS;  // Minimum latency
+    uint32_t maxUS;  // Maximum latency
+    uint32_t avgUS;  // Average latency
+};
+
+//////////////////////////////////////////////////////////////////////////////
+// Poll Stats
+//
+// Statistics on how the library polls the device for data. A "wasted" poll is
+// a processing pass of the device that found nothing to read. Jitter is how far
+// the arrival of a result was from the time predicted from the device cadence.
+//
+// Time values are in micro-seconds.
+
+struct TMF882XPollStats
+{
+    uint32_t polls;       // Number of processing passes of the device
+    uint32_t wastedPolls; // Passes that found nothing to read
+    uint32_t frames;      // Number of results received
+    uint32_t periodUS;    // Frame period of the device
+    uint32_t jitterAvgUS; // Average jitter of result arrivals
+    uint32_t jitterMaxUS; // Maximum jitter of result arrivals
+};
+
+//////////////////////////////////////////////////////////////////////////////
+// Depth Frame
+//
+// In 8x8 (TMF8828) mode, a full depth frame is sent by the device as 4 result
+// messages, one per capture. The low 2 bits of the result number give the
+// capture index. The library assembles these into a single frame, and passes
+// it to the depth frame handler. In the other modes, a frame is a single result
+// message - both sub-captures of a time-multiplexed SPAD map are in it.
+//
+// Only the captures with their bit set in captureMask hold results of this
+// frame. A frame with missing captures is sent once a capture of a later frame
+// arrives, with complete set to false.
+
+struct TMF882XDepthFrame
+{
+    uint32_t frameNum;   // Number of the frame, counted from the start of measuring
+    uint8_t nCaptures;   // Captures in a full frame - 4 in 8x8 mode, else 1
+    uint8_t captureMask; // Bit n is set if capture n was received
+    bool complete;       // All the captures of the frame were received
+    bool outOfOrder;     // Captures were received out of order, or more than once
+    struct tmf882x_meas_compact captures[kMaxDepthFrameCaptures];
+};
+
+// Depth Frame handler
+typedef void (*TMF882XDepthFrameHandler)(struct TMF882XDepthFrame *);
+
+//////////////////////////////////////////////////////////////////////////////
+// SPAD Cache
+//
+// Setting a custom SPAD configuration reads each SPAD config page from the device,
+// encodes the configuration into it and writes it back. With a SPAD cache, the
+// encoded pages are kept, keyed by a hash of the SPAD map id and the SPAD
+// configuration. Setting the same configuration again writes the kept pages,
+// without reading - this makes switching between a few SPAD configurations at
+// runtime fast.
+//
+// The entries are provided by the application - one per configuration to keep.
+// When the cache is full, the least recently used entry is replaced.
+
+struct TMF882XSPADCacheEntry
+{
+    uint32_t key;      // Hash of the SPAD map id and the SPAD configuration
+    uint32_t lastUsed; // Use count when the entry was last used - 0 if empty
+    struct tmf882x_mode_app_spad_image image;
+};
+
+//////////////////////////////////////////////////////////////////////////////
+// Firmware ID
+//
+// Identifies the firmware running on the device - the version it reports, and
+// a hash of the firmware image the library downloaded. Kept by the application
+// across an MCU reset (in RAM that isn't cleared on reset, EEPROM..etc), it lets
+// init() skip the firmware download while the device is still powered and
+// running the firmware image of the library. See setWarmStart().
+
+#define kFirmwareVersionSize 16
+
+struct TMF882XFirmwareID
+{
+    char version[kFirmwareVersionSize]; // Version reported by the device - "a.b.c.d"
+    uint32_t imageHash;                 // FNV-1a hash of the firmware image downloaded
+};
+
+// Stream encoder - used to record raw messages. See qwiic_tmf882x_stream.h
+class TMF882XStreamEncoder;
+
+// Zone filter - see qwiic_tmf882x_filter.h
+class TMF882XZoneFilter;
+
+// Frame rate governor - see qwiic_tmf882x_governor.h
+class TMF882XGovernor;
+
+// Calibration store - see qwiic_tmf882x_calibration.h
+class TMF882XCalibrationStore;
+
 class QwDevTMF882X
 {
 
@@ -108,7 +233,21 @@ class QwDevTMF882X
     QwDevTMF882X()
         : _isInitialized{false}, _sampleDelayMS{kDefaultSampleDelayMS}, _outputSettings{TMF882X_MSG_NONE},
           _debug{false}, _measurementHandlerCB{nullptr}, _histogramHandlerCB{nullptr}, _statsHandlerCB{nullptr},
-          _errorHandlerCB{nullptr}, _messageHandlerCB{nullptr}, _i2cBus{nullptr}, _i2cAddress{0} {};
+          _errorHandlerCB{nullptr}, _messageHandlerCB{nullptr}, _compactHandlerCB{nullptr}, _captureHandlerCB{nullptr}, _i2cBus{nullptr},
+          _i2cAddress{0}, _warmStartID{nullptr}, _firmwareHash{0}, _warmStarted{false}, _inConfig{false}, _pendingI2CAddress{0}, _spadCache{nullptr}, _spadCacheSize{0},
+          _spadCacheUses{0}, _calStore{nullptr}, _isContinuous{false}, _adaptivePolling{false}, _interruptMode{false}, _irqPending{false},
+          _irqStamped{false}, _irqTimeUS{0}, _i2cRecorder{nullptr}, _replayActive{false}, _replayTimeUS{0},
+          _filter{nullptr}, _filterCaptures{1}, _governor{nullptr}, _governorCaptures{1}, _governorPending{false},
+          _frameBuffer{nullptr}, _frameSize{0}, _frameCompact{false},
+          _frameSlots{0}, _frameHead{0}, _frameTail{0}, _frameOverruns{0},
+          _depthFrameHandlerCB{nullptr}, _depthFrame{nullptr}, _depthCaptures{1}, _depthFrameID{0},
+          _depthLastCapture{0}, _depthFrameCount{0}
+    {
+        resetPollSchedule();
+        resetPollStats();
+        resetLatencyStats();
+        resetTimeSync();
+    };
 
     ///////////////////////////////////////////////////////////////////////
     // init()
@@ -135,7 +274,8 @@ class QwDevTMF882X
     //
     // Set/Change the address of the connected device.
     //
-    // Called after the device has been initialized.
+    // Called after the device has been initialized. In a config transaction,
+    // the device moves to the address when the transaction is committed.
     //
     //  Parameter   Description
     //  ---------   -----------------------------
@@ -175,6 +315,55 @@ class QwDevTMF882X
 
     bool getApplicationVersion(char *pVersion, uint8_t vlen);
 
+    ///////////////////////////////////////////////////////////////////////
+    // getFirmwareID()
+    //
+    // Returns the ID of the firmware running on the device - the version it
+    // reports, and the hash of the firmware image the library downloaded. Keep
+    // it across an MCU reset, and pass it to setWarmStart().
+    //
+    //  Parameter   Description
+    //  ---------   -----------------------------
+    //  firmwareID  The firmware ID
+    //  retval      true on success, false on failure or if the library didn't
+    //              download the firmware
+
+    bool getFirmwareID(TMF882XFirmwareID &firmwareID);
+
+    ///////////////////////////////////////////////////////////////////////
+    // setWarmStart()
+    //
+    // Set the firmware ID kept from before an MCU reset. When init() is called,
+    // if the device is in application mode, reports the version of the ID, and
+    // the ID is of the firmware image of this library, the firmware download
+    // is skipped. The device keeps the configuration, and 8x8 mode, of before
+    // the reset.
+    //
+    // Call before init(). The ID must stay valid until init() is called.
+    //
+    //  Parameter   Description
+    //  ---------   -----------------------------
+    //  firmwareID  The kept firmware ID. nullptr to always download the firmware
+
+    void setWarmStart(const TMF882XFirmwareID *firmwareID)
+    {
+        _warmStartID = firmwareID;
+    }
+
+    ///////////////////////////////////////////////////////////////////////
+    // isWarmStart()
+    //
+    // Returns true if the firmware download was skipped by init()
+    //
+    //  Parameter   Description
+    //  ---------   -----------------------------
+    //  retval      true if warm started, false if the firmware was downloaded
+
+    bool isWarmStart(void)
+    {
+        return _warmStarted;
+    }
+
     ///////////////////////////////////////////////////////////////////////
     // getDeviceUniqueID()
     //
@@ -223,6 +412,20 @@ class QwDevTMF882X
 
     void setMeasurementHandler(TMF882XMeasurementHandler handler);
 
+    ///////////////////////////////////////////////////////////////////////
+    // setCompactHandler()
+    //
+    // Call this method with a function to call when measurement data is
+    // sent from the AMS sdk, in the compact, per-zone, layout. Each zone has
+    // a fixed slot in the compact results, indexed by sub-capture, channel
+    // and target.
+    //
+    //  Parameter   Description
+    //  ---------   -----------------------------
+    //  handler     The function to call when measurement data is sent from the SDK
+
+    void setCompactHandler(TMF882XCompactHandler handler);
+
     ///////////////////////////////////////////////////////////////////////
     // setHistogramHandler()
     //
@@ -284,6 +487,115 @@ class QwDevTMF882X
 
     void setMessageHandler(TMF882XMessageHandler handler);
 
+    ///////////////////////////////////////////////////////////////////////
+    // setDepthFrameHandler()
+    //
+    // Call this method with a function to call when a depth frame is
+    // assembled from the measurement results. In 8x8 mode, the four captures
+    // of a frame are collected and passed to the handler in one call.
+    //
+    // The frame is provided by the caller, and is filled in by the library.
+    //
+    //  Parameter   Description
+    //  ---------   -----------------------------
+    //  handler     The function to call when a depth frame is assembled
+    //  frame       The depth frame to assemble results into
+
+    void setDepthFrameHandler(TMF882XDepthFrameHandler handler, struct TMF882XDepthFrame *frame);
+
+    ///////////////////////////////////////////////////////////////////////
+    // setCaptureHandler()
+    //
+    // Call this method with a function to call when all the data of a
+    // capture - the results, the raw histograms and the stats - is received.
+    // The SDK decodes the messages directly into the capture buffer, joined by
+    // capture number, and the handler is called once the results arrive.
+    //
+    // The capture buffer is provided by the caller. The device must be
+    // initialized before calling this method.
+    //
+    //  Parameter   Description
+    //  ---------   -----------------------------
+    //  handler     The function to call when a capture is received
+    //  capture     The buffer to decode capture data into
+    //  retval      true on success, false on error
+
+    bool setCaptureHandler(TMF882XCaptureHandler handler, struct tmf882x_capture *capture);
+
+    ///////////////////////////////////////////////////////////////////////
+    // setI2CRecorder()
+    //
+    // Record the raw messages read from the device - each message is
+    // written to the stream encoder as a kStreamI2CMessage frame, with the
+    // host time it arrived at, before it is decoded. The recording can be
+    // replayed through the decoders with replayI2CMessage().
+    //
+    // The device must be initialized before calling this method.
+    //
+    //  Parameter   Description
+    //  ---------   -----------------------------
+    //  encoder     The stream encoder to write to - nullptr to stop recording
+    //  retval      true on success, false on error
+
+    bool setI2CRecorder(TMF882XStreamEncoder *encoder);
+
+    ///////////////////////////////////////////////////////////////////////
+    // replayI2CMessage()
+    //
+    // Pass a recorded raw message through the SDK decoders. The decoded
+    // messages are sent to the handlers as if they came from the device,
+    // with the recorded arrival time used for the capture time.
+    //
+    // Set restart for the first message of a recording - the decoder, capture
+    // time and filter state is reset, as it is when measurements start, so
+    // a recording always decodes to the same output.
+    //
+    // The device must be initialized, but needn't be measuring.
+    //
+    //  Parameter   Description
+    //  ---------   -----------------------------
+    //  i2c_msg     The recorded message
+    //  timeUS      The host time the message arrived at
+    //  restart     Reset the decoder state before the message
+    //  retval      true on success, false on error
+
+    bool replayI2CMessage(const struct tmf882x_mode_app_i2c_msg *i2c_msg, uint32_t timeUS, bool restart = false);
+
+    ///////////////////////////////////////////////////////////////////////
+    // setFilter()
+    //
+    // Filter the distances of each zone of the results, before they are
+    // passed to any handler. The filter is set up by the caller - see
+    // qwiic_tmf882x_filter.h. The zones are reset when measurements start,
+    // and when the 8x8 mode changes.
+    //
+    // The device must be initialized before calling this method.
+    //
+    //  Parameter   Description
+    //  ---------   -----------------------------
+    //  filter      The filter - nullptr for no filtering
+    //  retval      true on success, false on error
+
+    bool setFilter(TMF882XZoneFilter *filter);
+
+    ///////////////////////////////////////////////////////////////////////
+    // setGovernor()
+    //
+    // Adjust the iterations and period of the device to the signal it sees,
+    // within the limits of the governor - see qwiic_tmf882x_governor.h. The
+    // governor sees each frame of results, and a step it asks for is applied
+    // once the frame is processed. Each step is a config update - only the
+    // fields that change are written.
+    //
+    // The device must be initialized before calling this method.
+    //
+    //  Parameter   Description
+    //  ---------   -----------------------------
+    //  governor    The governor - nullptr for none
+    //  retval      true on success, false on error
+
+    bool setGovernor(TMF882XGovernor *governor);
+
     ///////////////////////////////////////////////////////////////////////
     // startMeasuring()
     //
@@ -331,6 +643,23 @@ class QwDevTMF882X
 
     int startMeasuring(struct tmf882x_msg_meas_results &results, uint32_t timeout = 0);
 
+    ///////////////////////////////////////////////////////////////////////
+    // startMeasuring()
+    //
+    // Start measuring distance/data on the TMF882X device. This method
+    // returns after one measurement is performed.
+    //
+    // Measurement data is returned in the provided compact results struct.
+    //
+    //  Parameter         Description
+    //  ---------         -----------------------------
+    //  results           The results of the mesurement, in the compact layout
+    //  timeout           The time, in milliseconds, to take measurements. A
+    //                    value of zero indicates no timeout set.
+    //  retval            The number of measurements taken (1), or -1 on error.
+
+    int startMeasuring(struct tmf882x_meas_compact &results, uint32_t timeout = 0);
+
     ///////////////////////////////////////////////////////////////////////
     // stopMeasuring()
     //
@@ -344,6 +673,69 @@ class QwDevTMF882X
 
     void stopMeasuring(void);
 
+    ///////////////////////////////////////////////////////////////////////
+    // beginContinuous()
+    //
+    // Start continuous, non-blocking, measurements on the TMF882X device.
+    //
+    // Unlike startMeasuring(), this method returns right away. The device is
+    // then serviced by calling service() from the main loop of the caller.
+    // Measurement data is passed to the library user via the callback functions,
+    // which are set using the set<type>Handler() methods on this object.
+    //
+    //  Parameter         Description
+    //  ---------         -----------------------------
+    //  retval            true on success, false on error
+
+    bool beginContinuous(void);
+
+    ///////////////////////////////////////////////////////////////////////
+    // service()
+    //
+    // Called from the main loop of the caller to service the TMF882X device
+    // while in continuous mode.
+    //
+    // Each call does at most one processing pass of the device, and returns
+    // at once if nothing is pending:
+    //
+    //  - Interrupt mode: A pass is made when the INT pin was signaled, or the
+    //    sample delay has passed since the last pass (backstop).
+    //  - Polling mode: A pass is made when the sample delay has passed since
+    //    the last pass.
+    //
+    // If stopMeasuring() is called in a Handler function, continuous mode is ended.
+    //
+    //  Parameter         Description
+    //  ---------         -----------------------------
+    //  retval            The number of measurements delivered in this call, or -1 on error
+
+    int service(void);
+
+    ///////////////////////////////////////////////////////////////////////
+    // endContinuous()
+    //
+    // Stop continuous measurements on the TMF882X device.
+    //
+    //  Parameter         Description
+    //  ---------         -----------------------------
+    //  None
+
+    void endContinuous(void);
+
+    ///////////////////////////////////////////////////////////////////////
+    // isContinuous()
+    //
+    // Returns true if the library is in continuous measurement mode
+    //
+    //  Parameter         Description
+    //  ---------         -----------------------------
+    //  retval            true if in continuous mode, false if not
+
+    bool isContinuous(void)
+    {
+        return _isContinuous;
+    }
+
     ///////////////////////////////////////////////////////////////////////
     // factoryCalibration()
     //
@@ -386,6 +778,24 @@ class QwDevTMF882X
 
     bool getCalibration(struct tmf882x_mode_app_calib &tofCalib);
 
+    ///////////////////////////////////////////////////////////////////////
+    // setCalibrationStore()
+    //
+    // Set a store of calibrations, keyed by the device unique ID - see
+    // qwiic_tmf882x_calibration.h. When the device is initialized, or its 8x8
+    // mode is changed, the calibration kept for it is set on the device. If
+    // the store has none, a factory calibration is run and saved to the store.
+    //
+    // Call before init() - if the device is initialized, the calibration is
+    // restored by this call.
+    //
+    //  Parameter    Description
+    //  ---------    -----------------------------
+    //  store        The calibration store. nullptr to not use a store
+    //  retval       True on success, false on error
+
+    bool setCalibrationStore(TMF882XCalibrationStore *store);
+
     //////////////////////////////////////////////////////////////////////////////////
     // setSampleDelay()
     //
@@ -417,10 +827,334 @@ class QwDevTMF882X
         return _sampleDelayMS;
     }
 
+    //////////////////////////////////////////////////////////////////////////////////
+    // setAdaptivePolling()
+    //
+    // Enable/Disable adaptive polling of the device.
+    //
+    // When enabled, the poll period isn't set by the sample delay. Instead, the library
+    // takes the report period from the device configuration, locks onto the cadence of
+    // the device using the sys_ticks value of each result, and polls just before the
+    // next result is due. The sample delay is used until a report period is known.
+    //
+    // Not used in interrupt mode.
+    //
+    //  Parameter    Description
+    //  ---------    -----------------------------
+    //  bEnable      To enable or disable adaptive polling
+
+    void setAdaptivePolling(bool bEnable)
+    {
+        _adaptivePolling = bEnable;
+    }
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // getAdaptivePolling()
+    //
+    // Returns the current adaptive polling setting of the library
+    //
+    //  Parameter    Description
+    //  ---------    -----------------------------
+    //  retval       True if adaptive polling is enabled
+
+    bool getAdaptivePolling(void)
+    {
+        return _adaptivePolling;
+    }
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // getPollStats()
+    //
+    // Returns statistics on how the device was polled - number of polls, wasted
+    // polls, the frame period of the device and the jitter of result arrivals.
+    //
+    //  Parameter    Description
+    //  ---------    -----------------------------
+    //  stats        Struct to hold the poll stats
+
+    void getPollStats(TMF882XPollStats &stats);
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // resetPollStats()
+    //
+    // Clear the collected poll stats
+    //
+    //  Parameter    Description
+    //  ---------    -----------------------------
+    //  None
+
+    void resetPollStats(void);
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // setInterruptMode()
+    //
+    // Enable/Disable interrupt (INT pin) driven measurements.
+    //
+    // When enabled, the measurement loop doesn't sleep for the sample delay between
+    // polls of the device. Instead, it waits for the host ISR attached to the INT pin
+    // of the TMF882X to call signalInterrupt(), and then services the device right
+    // away. The sample delay is used as the maximum wait time, in case an interrupt
+    // is missed.
+    //
+    //  Parameter    Description
+    //  ---------    -----------------------------
+    //  bEnable      To enable or disable interrupt mode
+
+    void setInterruptMode(bool bEnable)
+    {
+        _interruptMode = bEnable;
+    }
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // getInterruptMode()
+    //
+    // Returns the current interrupt mode setting of the library
+    //
+    //  Parameter    Description
+    //  ---------    -----------------------------
+    //  retval       True if in interrupt mode, false if polling.
+
+    bool getInterruptMode(void)
+    {
+        return _interruptMode;
+    }
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // signalInterrupt()
+    //
+    // Called from the host ISR attached to the INT pin of the TMF882X. Only records
+    // the time of the interrupt and sets a ready flag - it is safe to call from an ISR.
+    //
+    //  Parameter    Description
+    //  ---------    -----------------------------
+    //  None
+
+    void signalInterrupt(void);
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // getLatencyStats()
+    //
+    // Returns the latency, from interrupt to measurement callback dispatch, of
+    // the results taken. Requires the host ISR to call signalInterrupt(). Stats
+    // are collected in both interrupt and polling mode, allowing them to be compared.
+    //
+    //  Parameter    Description
+    //  ---------    -----------------------------
+    //  stats        Struct to hold the latency stats
+
+    void getLatencyStats(TMF882XLatencyStats &stats);
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // resetLatencyStats()
+    //
+    // Clear the collected latency stats
+    //
+    //  Parameter    Description
+    //  ---------    -----------------------------
+    //  None
+
+    void resetLatencyStats(void);
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // getClockSkew()
+    //
+    // Each set of results is stamped with an estimate of the host time it was
+    // captured at - the host_time_us field of the results. The estimate is made
+    // from the sys_ticks value of the results, using a model of the device clock
+    // kept by the library. The model is anchored to the result arrivals with the
+    // least latency, and tracks the skew between the device and host clocks.
+    //
+    // Returns the measured skew of the device clock. Positive if the device clock
+    // is slow compared to the host clock.
+    //
+    //  Parameter    Description
+    //  ---------    -----------------------------
+    //  retval       The clock skew - in parts per million
+
+    int32_t getClockSkew(void)
+    {
+        return _tsSkewPPM;
+    }
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // resetTimeSync()
+    //
+    // Restart the device clock model used to stamp results with a capture time.
+    // The model restarts on its own if the device clock jumps - after a reset of
+    // the device..etc.
+    //
+    //  Parameter    Description
+    //  ---------    -----------------------------
+    //  None
+
+    void resetTimeSync(void);
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // setFrameBuffer()
+    //
+    // Set a buffer used to queue measurement results between the device service path
+    // and the application. Each result is copied into the next free slot of the buffer
+    // when it's received, and the application takes results out at its own pace, using
+    // readFrame() or peekFrame()/releaseFrame(). A slow consumer doesn't lose results
+    // until the buffer is full - then new results are counted as overruns and dropped.
+    //
+    // The buffer is a single producer, single consumer queue - the results can be taken
+    // out in a different task/thread to the one that calls service(), without locks.
+    //
+    // One slot is kept free, so the buffer holds nSlots - 1 results. The buffer is
+    // provided by the caller. Pass in nullptr to disable the frame buffer. The buffer
+    // can't be changed while in continuous mode.
+    //
+    //  Parameter    Description
+    //  ---------    -----------------------------
+    //  frames       Array of result slots, or nullptr to disable
+    //  nSlots       Number of slots in the array - 2 to kMaxFrameBufferSlots
+    //  retval       true on success, false on error
+
+    bool setFrameBuffer(struct tmf882x_msg_meas_results *frames, uint16_t nSlots);
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // setFrameBuffer()
+    //
+    // Set a frame buffer of compact results - about 1/6th the size of a full
+    // result. Results are taken out with the compact versions of readFrame()
+    // and peekCompactFrame().
+    //
+    //  Parameter    Description
+    //  ---------    -----------------------------
+    //  frames       Array of compact result slots, or nullptr to disable
+    //  nSlots       Number of slots in the array - 2 to kMaxFrameBufferSlots
+    //  retval       true on success, false on error
+
+    bool setFrameBuffer(struct tmf882x_meas_compact *frames, uint16_t nSlots);
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // framesAvailable()
+    //
+    // Returns the number of results waiting in the frame buffer
+    //
+    //  Parameter    Description
+    //  ---------    -----------------------------
+    //  retval       The number of results in the buffer
+
+    uint16_t framesAvailable(void);
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // readFrame()
+    //
+    // Copy the oldest result out of the frame buffer, and free its slot.
+    //
+    //  Parameter    Description
+    //  ---------    -----------------------------
+    //  results      Struct to hold the result
+    //  retval       true if a result was returned, false if the buffer is empty
+
+    bool readFrame(struct tmf882x_msg_meas_results &results);
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // readFrame()
+    //
+    // Copy the oldest compact result out of the frame buffer, and free its slot.
+    //
+    //  Parameter    Description
+    //  ---------    -----------------------------
+    //  results      Struct to hold the result
+    //  retval       true if a result was returned, false if the buffer is empty
+    //               or doesn't hold compact results
+
+    bool readFrame(struct tmf882x_meas_compact &results);
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // peekFrame()
+    //
+    // Returns a pointer to the oldest result in the frame buffer, without copying
+    // it. The slot isn't reused until releaseFrame() is called.
+    //
+    //  Parameter    Description
+    //  ---------    -----------------------------
+    //  retval       Pointer to the result, or nullptr if the buffer is empty
+
+    struct tmf882x_msg_meas_results *peekFrame(void);
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // peekCompactFrame()
+    //
+    // Returns a pointer to the oldest compact result in the frame buffer, without
+    // copying it. The slot isn't reused until releaseFrame() is called.
+    //
+    //  Parameter    Description
+    //  ---------    -----------------------------
+    //  retval       Pointer to the result, or nullptr if the buffer is empty
+
+    struct tmf882x_meas_compact *peekCompactFrame(void);
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // releaseFrame()
+    //
+    // Free the slot of the oldest result in the frame buffer - after peekFrame()
+    //
+    //  Parameter    Description
+    //  ---------    -----------------------------
+    //  None
+
+    void releaseFrame(void);
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // getFrameOverruns()
+    //
+    // Returns the number of results dropped because the frame buffer was full
+    //
+    //  Parameter    Description
+    //  ---------    -----------------------------
+    //  retval       The number of dropped results
+
+    uint32_t getFrameOverruns(void)
+    {
+        return _frameOverruns;
+    }
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // beginConfig()
+    //
+    // Start a config transaction. The config changes made by the set methods -
+    // setTMF882XConfig(), setCurrentSPADMap() and setI2CAddress() - are made to a
+    // copy of the cached config, and written to the device by commitConfig().
+    //
+    //  Parameter    Description
+    //  ---------    -----------------------------
+    //  retval       True on success, false on error, or if a transaction is open
+
+    bool beginConfig(void);
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // commitConfig()
+    //
+    // Write the config changes of the transaction to the device, and end the
+    // transaction. Only the fields that changed are written, in one page write.
+    //
+    //  Parameter    Description
+    //  ---------    -----------------------------
+    //  retval       True on success, false on error, or if no transaction is open
+
+    bool commitConfig(void);
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // cancelConfig()
+    //
+    // Drop the config changes of the transaction, and end the transaction.
+
+    void cancelConfig(void)
+    {
+        _inConfig = false;
+        _pendingI2CAddress = 0;
+    }
+
     //////////////////////////////////////////////////////////////////////////////////
     // getTMF882XConfig()
     //
-    // Get the current configuration settings on the connected TMF882X
+    // Get the current configuration settings on the connected TMF882X. The
+    // cached config is returned if it is valid - in a config transaction, the
+    // config with the changes of the transaction.
     //
     //  Parameter    Description
     //  ---------    -----------------------------
@@ -432,7 +1166,8 @@ class QwDevTMF882X
     //////////////////////////////////////////////////////////////////////////////////
     // setTMF882XConfig()
     //
-    // Set the current configuration settings on the connected TMF882X
+    // Set the current configuration settings on the connected TMF882X. Only
+    // the fields that differ from the cached config are written.
     //
     //  Parameter    Description
     //  ---------    -----------------------------
@@ -499,6 +1234,65 @@ class QwDevTMF882X
 
     bool setSPADConfig(struct tmf882x_mode_app_spad_config &tofSpad);
 
+    //////////////////////////////////////////////////////////////////////////////////
+    // setSPADCache()
+    //
+    // Set the SPAD cache used by setSPADConfig(). The first time a SPAD configuration
+    // is set, its encoded SPAD config pages are kept in an entry. Setting it again
+    // writes the kept pages without reading the device first. Pass nullptr to not
+    // use a cache.
+    //
+    // The entries are cleared by this call, and when the device mode or firmware
+    // changes.
+    //
+    //  Parameter    Description
+    //  ---------    -----------------------------
+    //  entries      Array of cache entries - provided by the application.
+    //  nEntries     Number of entries in the array
+    //  retval       True on success, false on error
+
+    bool setSPADCache(TMF882XSPADCacheEntry *entries, uint8_t nEntries);
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // set8x8Mode()
+    //
+    // Enable or disable 8x8 mode - TMF8828 devices only. Switching the mode resets
+    // the device, so the configuration and calibration should be set after this call.
+    //
+    //  Parameter    Description
+    //  ---------    -----------------------------
+    //  enable       true to enable 8x8 mode, false for 3x3/3x6 (TMF8821) mode
+    //  retval       True on success, false on error
+
+    bool set8x8Mode(bool enable);
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // get8x8Mode()
+    //
+    // Returns true if the device is in 8x8 mode
+    //
+    //  Parameter    Description
+    //  ---------    -----------------------------
+    //  retval       True if in 8x8 mode, false if not or on error
+
+    bool get8x8Mode(void);
+
+    //////////////////////////////////////////////////////////////////////////////////
+    // getZoneMap()
+    //
+    // Get the zone map of the SPAD map in use - used to turn results into a point
+    // cloud with getTMF882XPointCloud(). Predefined grid SPAD maps use compile time
+    // tables, the map of other SPAD maps is derived from the SPAD configuration.
+    //
+    // Call once, after the SPAD map is set - not for each result.
+    //
+    //  Parameter    Description
+    //  ---------    -----------------------------
+    //  zoneMap      Struct to hold the zone map
+    //  retval       True on success, false on error
+
+    bool getZoneMap(TMF882XZoneMap &zoneMap);
+
     //////////////////////////////////////////////////////////////////////////////////
     // getTMF882XContext()
     //
@@ -663,19 +1457,59 @@ class QwDevTMF882X
     //
     //  Parameter    Description
     //  ---------    -----------------------------
-    //  theBus       The Bus object to use
+    //  theBus       The Bus object to use - any transport that implements QwIDeviceBus
     //  idBus        The bus ID for the target device.
     //
 
-    void setCommunicationBus(sfe_TMF882X::QwI2C &theBus, uint8_t idBus);
+    void setCommunicationBus(sfe_TMF882X::QwIDeviceBus &theBus, uint8_t idBus);
 
   private:
     // The internal method to initialize the device
     bool initializeTMF882x(void);
+    bool isFirmwareRunning(const TMF882XFirmwareID &firmwareID);
 
     // The actual measurment loop method
     int measurementLoop(uint16_t nMeasurements, uint32_t timeout);
 
+    // One processing pass of the device - shared by the loop and service()
+    int32_t serviceDevice(void);
+
+    // Poll scheduling methods
+    void resetPollSchedule(void);
+    void scheduleNextPoll(void);
+    void waitForNextPoll(void);
+    void updateFrameCadence(struct tmf882x_msg_meas_results *results);
+    void stampCaptureTime(struct tmf882x_msg_meas_results *results, uint32_t arrivalUS);
+    uint32_t framePeriodUS(void);
+    bool getInterruptTime(uint32_t &timeUS, bool clear);
+
+    // Raw message recorder - called from the SDK
+    static void recordI2CMessage(void *context, const struct tmf882x_mode_app_i2c_msg *i2c_msg);
+
+    // Frame buffer methods
+    bool setupFrameBuffer(uint8_t *frames, uint16_t nSlots, uint16_t frameSize, bool isCompact);
+    uint8_t *peekSlot(void);
+    void queueFrame(struct tmf882x_msg_meas_results *results);
+
+    // Depth frame assembly methods
+    void resetDepthFrame(void);
+    void assembleDepthFrame(struct tmf882x_meas_compact *results);
+    void sendDepthFrame(void);
+
+    // Filter methods
+    void resetFilter(void);
+
+    // Governor methods
+    void resetGovernor(void);
+    bool applyGovernor(void);
+
+    // Calibration store methods
+    bool restoreCalibration(void);
+
+    // SPAD cache methods
+    void clearSPADCache(void);
+    static uint32_t spadConfigKey(uint8_t idSPAD, const struct tmf882x_mode_app_spad_config &spadConfig);
+
     // Library initialized flag
     bool _isInitialized;
 
@@ -692,14 +1526,34 @@ class QwDevTMF882X
     TMF882XStatsHandler _statsHandlerCB;
     TMF882XErrorHandler _errorHandlerCB;
     TMF882XMessageHandler _messageHandlerCB;
+    TMF882XCompactHandler _compactHandlerCB;
+    TMF882XCaptureHandler _captureHandlerCB;
 
     // I2C  things
-    sfe_TMF882X::QwI2C *_i2cBus;      // pointer to our i2c bus object
+    sfe_TMF882X::QwIDeviceBus *_i2cBus; // pointer to our bus object
     uint8_t _i2cAddress; // address of the device
 
     // Structure/state for the underlying TOF SDK
     tmf882x_tof _TOF;
 
+    // Warm start state
+    const TMF882XFirmwareID *_warmStartID;
+    uint32_t _firmwareHash; // hash of the firmware image downloaded - 0 if none
+    bool _warmStarted;
+
+    // Config transaction - the changes to write on commit
+    bool _inConfig;
+    uint8_t _pendingI2CAddress; // address to move to on commit - 0 if none
+    struct tmf882x_mode_app_config _pendingConfig;
+
+    // SPAD cache
+    TMF882XSPADCacheEntry *_spadCache;
+    uint8_t _spadCacheSize;
+    uint32_t _spadCacheUses; // use count - stamps the entries when used
+
+    // Calibration store
+    TMF882XCalibrationStore *_calStore;
+
     // for processing messages from SDK
     uint16_t _nMeasurements;
 
@@ -709,4 +1563,79 @@ class QwDevTMF882X
     // Flag to indicate to the system to stop measurements
     bool _stopMeasuring;
 
+    // Continuous (non-blocking) measurement state
+    bool _isContinuous;
+
+    // Poll scheduling state
+    bool _adaptivePolling;
+    uint32_t _nextPollUS;      // host time of the next processing pass
+    uint16_t _nMessages;       // messages from the SDK - used to detect wasted polls
+    bool _emptyPollThisFrame;  // a wasted poll took place since the last result
+    bool _haveSysTicks;
+    uint32_t _lastSysTicks;
+    uint8_t _lastResultNum;
+    uint32_t _framePeriodUS;   // measured from sys_ticks
+    bool _haveNextFrame;
+    uint32_t _nextFrameUS;     // predicted host time of the next result
+
+    TMF882XPollStats _pollStats;
+    uint64_t _jitterTotalUS;
+    uint32_t _jitterCount;
+
+    // Interrupt (INT pin) mode things. The volatile values are set from the ISR
+    bool _interruptMode;
+    volatile bool _irqPending;
+    volatile bool _irqStamped;
+    volatile uint32_t _irqTimeUS;
+
+    // Raw message recording and replay
+    TMF882XStreamEncoder *_i2cRecorder;
+    bool _replayActive;
+    uint32_t _replayTimeUS;   // arrival time of the message being replayed
+
+    // Zone filter
+    TMF882XZoneFilter *_filter;
+    uint8_t _filterCaptures;  // captures in a frame - 4 in 8x8 mode, else 1
+
+    // Frame rate governor
+    TMF882XGovernor *_governor;
+    uint8_t _governorCaptures; // captures in a frame - 4 in 8x8 mode, else 1
+    bool _governorPending;     // a step is due
+
+    // Capture time model - maps sys_ticks to host time. The anchor is the
+    // result with the least latency seen, the skew is measured from the base.
+    bool _tsHaveAnchor;
+    uint32_t _tsAnchorTicks;
+    uint32_t _tsAnchorUS;
+    bool _tsHaveBase;
+    uint32_t _tsBaseTicks;
+    uint32_t _tsBaseUS;
+    int32_t _tsSkewPPM;
+    uint32_t _tsWindowTicks;   // start of the current window
+    int32_t _tsWindowMinUS;    // least latency in the window
+    uint32_t _tsWindowMinTicks;
+    uint32_t _tsWindowMinArrivalUS;
+
+    // Interrupt to callback latency tracking
+    TMF882XLatencyStats _latency;
+    uint64_t _latencyTotalUS;
+
+    // Frame buffer - single producer/single consumer. The head is only written by the
+    // producer, the tail by the consumer. 8 bit indexes, so access is atomic.
+    uint8_t *_frameBuffer;
+    uint16_t _frameSize;   // size of a slot
+    bool _frameCompact;    // slots hold compact results
+    uint8_t _frameSlots;
+    volatile uint8_t _frameHead;
+    volatile uint8_t _frameTail;
+    volatile uint32_t _frameOverruns;
+
+    // Depth frame assembly
+    TMF882XDepthFrameHandler _depthFrameHandlerCB;
+    struct TMF882XDepthFrame *_depthFrame;
+    uint8_t _depthCaptures;     // captures in a full frame
+    uint8_t _depthFrameID;      // result number / captures of the frame being assembled
+    uint8_t _depthLastCapture;  // last capture received
+    uint32_t _depthFrameCount;
+
 };
@@ -0,0 +1,426 @@
+// qwiic_tmf882x_array.cpp
+//
+// This is a library written for SparkFun Qwiic TMF882X boards
+//
+// SparkFun sells these bpards at its website: www.sparkfun.com
+//
+// Do you like this library? Help support SparkFun. Buy a board!
+//
+//  SparkFun Qwiic dToF Imager - TMF8820        https://www.sparkfun.com/products/19036
+//  SparkFun Qwiic Mini dToF Imager - TMF8820   https://www.sparkfun.com/products/19218
+//  SparkFun Qwiic Mini dToF Imager - TMF8821   https://www.sparkfun.com/products/19451
+//  SparkFun Qwiic dToF Imager - TMF8821        https://www.sparkfun.com/products/19037
+//
+// Written by Kirk Benell @ SparkFun Electronics, April 2022
+//
+// This library provides an abstract interface to the underlying TMF882X
+// SDK that is provided by AMS.
+//
+// Repository:
+//     https://github.com/sparkfun/SparkFun_Qwiic_TMF882X_Arduino_Library
+//
+//
+// SparkFun code, firmware, and software is released under the MIT
+// License(http://opensource.org/licenses/MIT).
+//
+// SPDX-License-Identifier: MIT
+//
+//    The MIT License (MIT)
+//
+//    Copyright (c) 2022 SparkFun Electronics
+//    Permission is hereby granted, free of charge, to any person obtaining a
+//    copy of this software and associated documentation files (the "Software"),
+//    to deal in the Software without restriction, including without limitation
+//    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//    and/or sell copies of the Software, and to permit persons to whom the
+//    Software is furnished to do so, subject to the following conditions: The
+//    above copyright notice and this permission notice shall be included in all
+//    copies or substantial portions of the Software. THE SOFTWARE IS PROVIDED
+//    "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+//    NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+//    PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+//    ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+//    CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+
+// Manager for an array of TMF882X devices
+
+#include <string.h>
+
+#include "qwiic_tmf882x_array.h"
+#include "sfe_arduino.h"
+
+///////////////////////////////////////////////////////////////////////
+// addSensor()
+//
+// Add a device to the array.
+//
+//  Parameter   Description
+//  ---------   -----------------------------
+//  device      The device object
+//  theBus      The bus the device is on
+//  address     The I2C address to move the device to
+//  retval      true on success, false if the array is full
+
+bool TMF882XArray::addSensor(QwDevTMF882X &device, sfe_TMF882X::QwIDeviceBus &theBus, uint8_t address)
+{
+    if (_nSensors == kMaxArraySensors || _isContinuous)
+        return false;
+
+    TMF882XArraySensor *sensor = &_sensors[_nSensors++];
+
+    memset(sensor, 0, sizeof(TMF882XArraySensor));
+    sensor->device = &device;
+    sensor->bus = &theBus;
+    sensor->address = address;
+
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////
+// begin()
+//
+// Bring up the devices of the array, and move each to its address.
+//
+//  Parameter   Description
+//  ---------   -----------------------------
+//  retval      true on success, false on error
+
+bool TMF882XArray::begin(void)
+{
+    if (!_nSensors)
+        return false;
+
+    // Only one device at the default address at a time - disable them all
+    if (_enableHandlerCB)
+    {
+        for (uint8_t i = 0; i < _nSensors; i++)
+            _enableHandlerCB(i, false);
+    }
+
+    for (uint8_t i = 0; i < _nSensors; i++)
+    {
+        TMF882XArraySensor *sensor = &_sensors[i];
+
+        if (_enableHandlerCB)
+        {
+            _enableHandlerCB(i, true);
+            sfe_msleep(kArrayEnableDelayMS);
+        }
+
+        // Already at its address? This is the case after a host reset
+        sensor->device->setCommunicationBus(*sensor->bus, sensor->address);
+
+        if (!sensor->device->isConnected())
+            sensor->device->setCommunicationBus(*sensor->bus, kDefaultTMF882XAddress);
+
+        if (!sensor->device->init())
+            return false;
+
+        if (!sensor->device->setI2CAddress(sensor->address))
+            return false;
+    }
+
+    resetStats();
+
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////
+// beginContinuous()
+//
+// Start continuous measurements on all the devices, spread over one report
+// period if staggered.
+//
+//  Parameter   Description
+//  ---------   -----------------------------
+//  stagger     Spread the starts over one report period
+//  retval      true on success, false on error
+
+bool TMF882XArray::beginContinuous(bool stagger)
+{
+    if (!_nSensors)
+        return false;
+
+    if (_isContinuous)
+        return true;
+
+    // the report period of the devices sets the spacing of the starts
+    struct tmf882x_mode_app_config tofConfig;
+    uint32_t spacingUS = 0;
+
+    if (stagger && _sensors[0].device->getTMF882XConfig(tofConfig))
+        spacingUS = (uint32_t)tofConfig.report_period_ms * 1000 / _nSensors;
+
+    uint32_t startUS = sfe_micros();
+
+    for (uint8_t i = 0; i < _nSensors; i++)
+    {
+        while ((int32_t)(sfe_micros() - (startUS + i * spacingUS)) < 0)
+            sfe_yield();
+
+        if (!_sensors[i].device->beginContinuous())
+        {
+            // Stop the devices already started
+            while (i--)
+                _sensors[i].device->endContinuous();
+            return false;
+        }
+    }
+
+    _current = 0;
+    _next = 0;
+    _isContinuous = true;
+
+    resetStats();
+
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////
+// service()
+//
+// Service each device of the array.
+//
+//  Parameter   Description
+//  ---------   -----------------------------
+//  retval      The number of measurements delivered in this call, or -1 on error
+
+int TMF882XArray::service(void)
+{
+    if (!_isContinuous)
+        return -1;
+
+    int nTotal = 0;
+
+    for (uint8_t n = 0; n < _nSensors; n++)
+    {
+        _current = (_next + n) % _nSensors;
+        TMF882XArraySensor *sensor = &_sensors[_current];
+
+        // A device stopped in a handler returns an error - it's skipped
+        int nDelivered = sensor->device->service();
+        if (nDelivered <= 0)
+            continue;
+
+        sensor->frames += nDelivered;
+        sensor->windowFrames += nDelivered;
+        nTotal += nDelivered;
+    }
+
+    _next = (_next + 1) % _nSensors;
+
+    _frames += nTotal;
+    _windowFrames += nTotal;
+
+    updateFrameRates();
+
+    return nTotal;
+}
+
+///////////////////////////////////////////////////////////////////////
+// endContinuous()
+//
+// Stop continuous measurements on all the devices.
+
+void TMF882XArray::endContinuous(void)
+{
+    for (uint8_t i = 0; i < _nSensors; i++)
+        _sensors[i].device->endContinuous();
+
+    _isContinuous = false;
+}
+
+///////////////////////////////////////////////////////////////////////
+// updateFrameRates()
+//
+// Internal, private method. At the end of each rate window, compute the frame
+// rates of the window.
+
+void TMF882XArray::updateFrameRates(void)
+{
+    uint32_t elapsedMS = sfe_millis() - _rateStartMS;
+
+    if (elapsedMS < kArrayRateWindowMS)
+        return;
+
+    for (uint8_t i = 0; i < _nSensors; i++)
+    {
+        _sensors[i].frameRate = (uint64_t)_sensors[i].windowFrames * 100000 / elapsedMS;
+        _sensors[i].windowFrames = 0;
+    }
+
+    _frameRate = (uint64_t)_windowFrames * 100000 / elapsedMS;
+    _windowFrames = 0;
+
+    _rateStartMS += elapsedMS;
+}
+
+///////////////////////////////////////////////////////////////////////
+// getSensorStats()
+//
+// Returns the frame count and rate of a device
+//
+//  Parameter   Description
+//  ---------   -----------------------------
+//  sensor      Index of the device
+//  stats       Struct to hold the stats
+
+void TMF882XArray::getSensorStats(uint8_t sensor, TMF882XArrayStats &stats)
+{
+    if (sensor >= _nSensors)
+    {
+        memset(&stats, 0, sizeof(TMF882XArrayStats));
+        return;
+    }
+
+    stats.frames = _sensors[sensor].frames;
+    stats.frameRate = _sensors[sensor].frameRate;
+}
+
+///////////////////////////////////////////////////////////////////////
+// getArrayStats()
+//
+// Returns the frame count and rate of the whole array
+//
+//  Parameter   Description
+//  ---------   -----------------------------
+//  stats       Struct to hold the stats
+
+void TMF882XArray::getArrayStats(TMF882XArrayStats &stats)
+{
+    stats.frames = _frames;
+    stats.frameRate = _frameRate;
+}
+
+///////////////////////////////////////////////////////////////////////
+// resetStats()
+//
+// Reset the frame counts and rates
+
+void TMF882XArray::resetStats(void)
+{
+    for (uint8_t i = 0; i < _nSensors; i++)
+    {
+        _sensors[i].frames = 0;
+        _sensors[i].windowFrames = 0;
+        _sensors[i].frameRate = 0;
+    }
+
+    _frames = 0;
+    _windowFrames = 0;
+    _frameRate = 0;
+    _rateStartMS = sfe_millis();
+}
+
+///////////////////////////////////////////////////////////////////////
+// begin()
+//
+// Set up the frame aligner.
+//
+//  Parameter   Description
+//  ---------   -----------------------------
+//  nSensors    Number of sensors aligned
+//  toleranceUS Max time between the results of a set - in micro-seconds
+//  handler     The function called with each set
+//  frame       The set buffer
+//  retval      true on success, false on error
+
+bool TMF882XFrameAligner::begin(uint8_t nSensors, uint32_t toleranceUS, TMF882XAlignedFrameHandler handler,
+                                struct TMF882XAlignedFrame *frame)
+{
+    if (!nSensors || nSensors > kMaxArraySensors || !handler || !frame)
+        return false;
+
+    _nSensors = nSensors;
+    _toleranceUS = toleranceUS;
+    _alignedFrameHandlerCB = handler;
+    _frame = frame;
+    _pending = false;
+
+    resetStats();
+
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////
+// addFrame()
+//
+// Add a result of a sensor to the aligner. The result is copied into the
+// set being built, or starts a new set.
+//
+//  Parameter   Description
+//  ---------   -----------------------------
+//  sensor      Index of the sensor
+//  results     The compact results of the sensor
+//  retval      true if the result was added, false if dropped
+
+bool TMF882XFrameAligner::addFrame(uint8_t sensor, struct tmf882x_meas_compact *results)
+{
+    if (!_frame || !results || sensor >= _nSensors)
+        return false;
+
+    uint16_t bit = 1 << sensor;
+
+    if (_pending)
+    {
+        int32_t delta = (int32_t)(results->host_time_us - _frame->timeUS);
+
+        // Older than the set? The set it belonged to was already sent
+        if (delta < -(int32_t)_toleranceUS)
+        {
+            _stats.lateFrames++;
+            return false;
+        }
+
+        // Part of a later set
+        if (delta > (int32_t)_toleranceUS || (_frame->sensorMask & bit))
+            sendSet();
+    }
+
+    if (!_pending)
+    {
+        _frame->timeUS = results->host_time_us;
+        _frame->sensorMask = 0;
+        _frame->complete = false;
+        _pending = true;
+    }
+
+    memcpy(&_frame->frames[sensor], results, sizeof(struct tmf882x_meas_compact));
+    _frame->sensorMask |= bit;
+
+    if (_frame->sensorMask == (uint16_t)((1UL << _nSensors) - 1))
+        sendSet();
+
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////
+// flush()
+//
+// Send the set being built, if any.
+
+void TMF882XFrameAligner::flush(void)
+{
+    if (_pending)
+        sendSet();
+}
+
+///////////////////////////////////////////////////////////////////////
+// sendSet()
+//
+// Internal, private method. Sends the set being built to the handler.
+
+void TMF882XFrameAligner::sendSet(void)
+{
+    _frame->complete = _frame->sensorMask == (uint16_t)((1UL << _nSensors) - 1);
+    _pending = false;
+
+    _stats.sets++;
+    if (!_frame->complete)
+        _stats.incompleteSets++;
+
+    _alignedFrameHandlerCB(_frame);
+}
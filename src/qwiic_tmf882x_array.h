@@ -0,0 +1,408 @@
+// qwiic_tmf882x_array.h
+//
+// This is a library written for SparkFun Qwiic TMF882X boards
+//
+// SparkFun sells these bpards at its website: www.sparkfun.com
+//
+// Do you like this library? Help support SparkFun. Buy a board!
+//
+//  SparkFun Qwiic dToF Imager - TMF8820        https://www.sparkfun.com/products/19036
+//  SparkFun Qwiic Mini dToF Imager - TMF8820   https://www.sparkfun.com/products/19218
+//  SparkFun Qwiic Mini dToF Imager - TMF8821   https://www.sparkfun.com/products/19451
+//  SparkFun Qwiic dToF Imager - TMF8821        https://www.sparkfun.com/products/19037
+//
+// Written by Kirk Benell @ SparkFun Electronics, April 2022
+//
+// This library provides an abstract interface to the underlying TMF882X
+// SDK that is provided by AMS.
+//
+// Repository:
+//     https://github.com/sparkfun/SparkFun_Qwiic_TMF882X_Arduino_Library
+//
+//
+// SparkFun code, firmware, and software is released under the MIT
+// License(http://opensource.org/licenses/MIT).
+//
+// SPDX-License-Identifier: MIT
+//
+//    The MIT License (MIT)
+//
+//    Copyright (c) 2022 SparkFun Electronics
+//    Permission is hereby granted, free of charge, to any person obtaining a
+//    copy of this software and associated documentation files (the "Software"),
+//    to deal in the Software without restriction, including without limitation
+//    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//    and/or sell copies of the Software, and to permit persons to whom the
+//    Software is furnished to do so, subject to the following conditions: The
+//    above copyright notice and this permission notice shall be included in all
+//    copies or substantial portions of the Software. THE SOFTWARE IS PROVIDED
+//    "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+//    NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+//    PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+//    ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+//    CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+
+// Header for the TMF882X sensor array manager
+
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+
+#include "qwiic_bus.h"
+#include "qwiic_tmf882x.h"
+
+// Max number of sensors in an array
+#define kMaxArraySensors 16
+
+// Time for a sensor to boot after its enable (EN) pin is set
+#define kArrayEnableDelayMS 10
+
+// Window the frame rates are measured over
+#define kArrayRateWindowMS 1000
+
+//////////////////////////////////////////////////////////////////////////////
+// Enable Handler type
+//
+// Called to set the enable (EN) pin of a sensor, during address assignment.
+
+typedef void (*TMF882XEnableHandler)(uint8_t sensor, bool enable);
+
+//////////////////////////////////////////////////////////////////////////////
+// Array Stats
+//
+// Frame counts and rates, for a sensor or the whole array. The frame rate is
+// in frames per second, times 100 - measured over the last rate window.
+
+struct TMF882XArrayStats
+{
+    uint32_t frames;    // Number of results received
+    uint32_t frameRate; // Frames per second x 100
+};
+
+//////////////////////////////////////////////////////////////////////////////
+// TMF882XArray
+//
+// Manages a set of TMF882X devices, on one or more buses. At startup, each
+// device is moved to its own I2C address, and all devices are then serviced
+// from one non-blocking loop - call service() from the main loop of the
+// application.
+//
+// The devices, and the buses, are provided by the caller.
+
+class TMF882XArray
+{
+  public:
+    TMF882XArray(void)
+        : _nSensors{0}, _enableHandlerCB{nullptr}, _current{0}, _next{0}, _isContinuous{false},
+          _rateStartMS{0}, _frames{0}, _windowFrames{0}, _frameRate{0}
+    {
+    }
+
+    ///////////////////////////////////////////////////////////////////////
+    // addSensor()
+    //
+    // Add a device to the array. Devices are brought up in the order added.
+    //
+    //  Parameter   Description
+    //  ---------   -----------------------------
+    //  device      The device object
+    //  theBus      The bus the device is on
+    //  address     The I2C address to move the device to
+    //  retval      true on success, false if the array is full
+
+    bool addSensor(QwDevTMF882X &device, sfe_TMF882X::QwIDeviceBus &theBus, uint8_t address);
+
+    ///////////////////////////////////////////////////////////////////////
+    // setEnableHandler()
+    //
+    // Set the function called to set the enable (EN) pin of a sensor. All the
+    // sensors start at the default address, so only one can be enabled at a time
+    // while addresses are assigned. Not needed if each sensor is on its own bus.
+    //
+    //  Parameter   Description
+    //  ---------   -----------------------------
+    //  handler     The function that sets the enable pin of a sensor
+
+    void setEnableHandler(TMF882XEnableHandler handler)
+    {
+        _enableHandlerCB = handler;
+    }
+
+    ///////////////////////////////////////////////////////////////////////
+    // begin()
+    //
+    // Bring up the devices of the array. Each device is enabled in turn,
+    // initialized at the default address, and moved to its address using
+    // setI2CAddress(). A device already at its address is used as is.
+    //
+    //  Parameter   Description
+    //  ---------   -----------------------------
+    //  retval      true on success, false on error
+
+    bool begin(void);
+
+    ///////////////////////////////////////////////////////////////////////
+    // count()
+    //
+    // Returns the number of devices in the array
+
+    uint8_t count(void)
+    {
+        return _nSensors;
+    }
+
+    ///////////////////////////////////////////////////////////////////////
+    // getSensor()
+    //
+    // Returns a device of the array
+    //
+    //  Parameter   Description
+    //  ---------   -----------------------------
+    //  sensor      Index of the device
+    //  retval      The device, nullptr if the index is out of range
+
+    QwDevTMF882X *getSensor(uint8_t sensor)
+    {
+        return sensor < _nSensors ? _sensors[sensor].device : nullptr;
+    }
+
+    ///////////////////////////////////////////////////////////////////////
+    // getCurrentSensor()
+    //
+    // Returns the index of the device being serviced. Called in a message
+    // handler, this is the device that sent the message.
+
+    uint8_t getCurrentSensor(void)
+    {
+        return _current;
+    }
+
+    ///////////////////////////////////////////////////////////////////////
+    // beginContinuous()
+    //
+    // Start continuous measurements on all the devices. The starts are spread
+    // over one report period, so the results of the devices arrive - and are
+    // read out - interleaved, and not all at once. This method blocks for up to
+    // one report period.
+    //
+    // If the results of the devices are aligned (TMF882XFrameAligner), the starts
+    // shouldn't be spread - the devices are then started together.
+    //
+    //  Parameter   Description
+    //  ---------   -----------------------------
+    //  stagger     Spread the starts over one report period
+    //  retval      true on success, false on error
+
+    bool beginContinuous(bool stagger = true);
+
+    ///////////////////////////////////////////////////////////////////////
+    // service()
+    //
+    // Called from the main loop of the application. Services each device
+    // that has a poll due, or has signaled an interrupt. The first device
+    // serviced rotates on each call, so no device is always serviced last.
+    //
+    //  Parameter   Description
+    //  ---------   -----------------------------
+    //  retval      The number of measurements delivered in this call, or -1 on error
+
+    int service(void);
+
+    ///////////////////////////////////////////////////////////////////////
+    // endContinuous()
+    //
+    // Stop continuous measurements on all the devices.
+
+    void endContinuous(void);
+
+    ///////////////////////////////////////////////////////////////////////
+    // getSensorStats()
+    //
+    // Returns the frame count and rate of a device
+    //
+    //  Parameter   Description
+    //  ---------   -----------------------------
+    //  sensor      Index of the device
+    //  stats       Struct to hold the stats
+
+    void getSensorStats(uint8_t sensor, TMF882XArrayStats &stats);
+
+    ///////////////////////////////////////////////////////////////////////
+    // getArrayStats()
+    //
+    // Returns the frame count and rate of the whole array
+    //
+    //  Parameter   Description
+    //  ---------   -----------------------------
+    //  stats       Struct to hold the stats
+
+    void getArrayStats(TMF882XArrayStats &stats);
+
+    ///////////////////////////////////////////////////////////////////////
+    // resetStats()
+    //
+    // Reset the frame counts and rates
+
+    void resetStats(void);
+
+  private:
+    void updateFrameRates(void);
+
+    struct TMF882XArraySensor
+    {
+        QwDevTMF882X *device;
+        sfe_TMF882X::QwIDeviceBus *bus;
+        uint8_t address;
+        uint32_t frames;
+        uint32_t windowFrames; // frames in the current rate window
+        uint32_t frameRate;
+    };
+
+    TMF882XArraySensor _sensors[kMaxArraySensors];
+    uint8_t _nSensors;
+
+    TMF882XEnableHandler _enableHandlerCB;
+
+    // scheduler state
+    uint8_t _current; // device being serviced
+    uint8_t _next;    // device serviced first in the next call
+    bool _isContinuous;
+
+    // aggregate frame rate
+    uint32_t _rateStartMS;
+    uint32_t _frames;
+    uint32_t _windowFrames;
+    uint32_t _frameRate;
+};
+
+//////////////////////////////////////////////////////////////////////////////
+// Aligned Frame
+//
+// A set of results, one from each sensor of an array, captured at about the
+// same time. The time of the set is the capture time of its first result. If
+// a sensor has no result in the set, its bit in the mask is clear.
+
+struct TMF882XAlignedFrame
+{
+    uint32_t timeUS;     // host capture time of the set
+    uint16_t sensorMask; // bit n is set if sensor n has a result in the set
+    bool complete;       // every sensor has a result in the set
+    struct tmf882x_meas_compact frames[kMaxArraySensors];
+};
+
+//////////////////////////////////////////////////////////////////////////////
+// Aligned Frame Handler type
+//
+// Called when a set of aligned results is ready.
+
+typedef void (*TMF882XAlignedFrameHandler)(struct TMF882XAlignedFrame *);
+
+//////////////////////////////////////////////////////////////////////////////
+// Align Stats
+
+struct TMF882XAlignStats
+{
+    uint32_t sets;           // Number of sets sent
+    uint32_t incompleteSets; // Sets sent without a result from every sensor
+    uint32_t lateFrames;     // Results dropped - older than the set being built
+};
+
+//////////////////////////////////////////////////////////////////////////////
+// TMF882XFrameAligner
+//
+// Groups the results of several sensors into sets captured at the same time,
+// using the host capture time of the results (host_time_us). The results are
+// passed in by the application - call addFrame() from the compact handler of
+// each sensor. With a TMF882XArray, getCurrentSensor() gives the sensor index.
+//
+// A result joins the set being built if it is within the tolerance of the set
+// time. The set is sent when every sensor has a result in it, or when a result
+// from outside the tolerance - or a second result from a sensor - arrives.
+//
+// The set buffer is provided by the caller.
+
+class TMF882XFrameAligner
+{
+  public:
+    TMF882XFrameAligner(void)
+        : _nSensors{0}, _toleranceUS{0}, _alignedFrameHandlerCB{nullptr}, _frame{nullptr}, _pending{false}
+    {
+        resetStats();
+    }
+
+    ///////////////////////////////////////////////////////////////////////
+    // begin()
+    //
+    // Set up the aligner.
+    //
+    //  Parameter   Description
+    //  ---------   -----------------------------
+    //  nSensors    Number of sensors aligned
+    //  toleranceUS Max time between the results of a set - in micro-seconds
+    //  handler     The function called with each set
+    //  frame       The set buffer
+    //  retval      true on success, false on error
+
+    bool begin(uint8_t nSensors, uint32_t toleranceUS, TMF882XAlignedFrameHandler handler,
+               struct TMF882XAlignedFrame *frame);
+
+    ///////////////////////////////////////////////////////////////////////
+    // addFrame()
+    //
+    // Add a result of a sensor to the aligner
+    //
+    //  Parameter   Description
+    //  ---------   -----------------------------
+    //  sensor      Index of the sensor
+    //  results     The compact results of the sensor
+    //  retval      true if the result was added, false if dropped
+
+    bool addFrame(uint8_t sensor, struct tmf882x_meas_compact *results);
+
+    ///////////////////////////////////////////////////////////////////////
+    // flush()
+    //
+    // Send the set being built, if any - at the end of measurements.
+
+    void flush(void);
+
+    ///////////////////////////////////////////////////////////////////////
+    // getAlignStats()
+    //
+    // Returns the set counts of the aligner
+    //
+    //  Parameter   Description
+    //  ---------   -----------------------------
+    //  stats       Struct to hold the stats
+
+    void getAlignStats(TMF882XAlignStats &stats)
+    {
+        stats = _stats;
+    }
+
+    ///////////////////////////////////////////////////////////////////////
+    // resetStats()
+    //
+    // Reset the set counts
+
+    void resetStats(void)
+    {
+        memset(&_stats, 0, sizeof(_stats));
+    }
+
+  private:
+    void sendSet(void);
+
+    uint8_t _nSensors;
+    uint32_t _toleranceUS;
+
+    TMF882XAlignedFrameHandler _alignedFrameHandlerCB;
+    struct TMF882XAlignedFrame *_frame;
+    bool _pending; // a set is being built
+
+    TMF882XAlignStats _stats;
+};
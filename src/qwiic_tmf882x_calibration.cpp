@@ -0,0 +1,494 @@
+// qwiic_tmf882x_calibration.cpp
+//
+// This is a library written for SparkFun Qwiic TMF882X boards
+//
+// SparkFun sells these bpards at its website: www.sparkfun.com
+//
+// Do you like this library? Help support SparkFun. Buy a board!
+//
+//  SparkFun Qwiic dToF Imager - TMF8820        https://www.sparkfun.com/products/19036
+//  SparkFun Qwiic Mini dToF Imager - TMF8820   https://www.sparkfun.com/products/19218
+//  SparkFun Qwiic Mini dToF Imager - TMF8821   https://www.sparkfun.com/products/19451
+//  SparkFun Qwiic dToF Imager - TMF8821        https://www.sparkfun.com/products/19037
+//
+// Written by Kirk Benell @ SparkFun Electronics, April 2022
+//
+// This library provides an abstract interface to the underlying TMF882X
+// SDK that is provided by AMS.
+//
+// Repository:
+//     https://github.com/sparkfun/SparkFun_Qwiic_TMF882X_Arduino_Library
+//
+//
+// SparkFun code, firmware, and software is released under the MIT
+// License(http://opensource.org/licenses/MIT).
+//
+// SPDX-License-Identifier: MIT
+//
+//    The MIT License (MIT)
+//
+//    Copyright (c) 2022 SparkFun Electronics
+//    Permission is hereby granted, free of charge, to any person obtaining a
+//    copy of this software and associated documentation files (the "Software"),
+//    to deal in the Software without restriction, including without limitation
+//    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//    and/or sell copies of the Software, and to permit persons to whom the
+//    Software is furnished to do so, subject to the following conditions: The
+//    above copyright notice and this permission notice shall be included in all
+//    copies or substantial portions of the Software. THE SOFTWARE IS PROVIDED
+//    "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+//    NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+//    PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+//    ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+//    CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+// Calibration store for the TMF882X
+
+#include "qwiic_tmf882x_calibration.h"
+#include "qwiic_tmf882x_stream.h"
+
+#include <string.h>
+
+// Offsets of the record header fields
+#define kCalStoreFlagsOffset 2
+#define kCalStoreUIDOffset 3
+#define kCalStoreLengthOffset (kCalStoreUIDOffset + kCalStoreUIDSize)
+#define kCalStoreCRCOffset (kCalStoreLengthOffset + 2)
+
+// Size of the end of list marker
+#define kCalStoreEndSize 2
+
+// Size of the blocks records are moved in, when the store is compacted
+#define kCalStoreCopySize 32
+
+static_assert(sizeof("255.255.255.255") <= kCalStoreUIDSize, "kCalStoreUIDSize can't hold a device UID");
+
+//////////////////////////////////////////////////////////////////////////////
+// Build the record key of a device - the UID string, zero padded.
+
+static void calStoreKey(const struct tmf882x_mode_app_dev_UID &uid, char *key)
+{
+    memset(key, 0, kCalStoreUIDSize);
+    memcpy(key, uid.uid, strnlen(uid.uid, kCalStoreUIDSize - 1));
+}
+
+///////////////////////////////////////////////////////////////////////
+// find()
+//
+// Internal, private method. Walks the records of the store, looking for the
+// record of a key.
+//
+//  Parameter   Description
+//  ---------   -----------------------------
+//  key         The record key
+//  flags       The record flags - the mode
+//  offset      Offset of the record found
+//  length      Calibration data length of the record found
+//  end         Offset of the end of the record list
+//  retval      true if found, false if not
+
+bool TMF882XCalibrationStore::find(const char *key, uint8_t flags, uint32_t &offset, uint16_t &length, uint32_t &end)
+{
+    uint8_t header[kCalStoreHeaderSize];
+    uint32_t storeSize = size();
+    uint32_t pos = 0;
+    bool found = false;
+
+    while (pos + kCalStoreHeaderSize <= storeSize)
+    {
+        if (!read(pos, header, kCalStoreHeaderSize))
+            break;
+
+        if (header[0] != kCalStoreMagic0 || header[1] != kCalStoreMagic1)
+            break;
+
+        uint16_t recLength = header[kCalStoreLengthOffset] | (header[kCalStoreLengthOffset + 1] << 8);
+
+        // a record past the end of the storage isn't valid - the list ends
+        if (recLength > TMF882X_MAX_CALIB_SIZE || kCalStoreRecordSize(recLength) > storeSize - pos)
+            break;
+
+        if (!found && header[kCalStoreFlagsOffset] == flags &&
+            !memcmp(&header[kCalStoreUIDOffset], key, kCalStoreUIDSize))
+        {
+            found = true;
+            offset = pos;
+            length = recLength;
+        }
+        pos += kCalStoreRecordSize(recLength);
+    }
+    end = pos;
+
+    return found;
+}
+
+///////////////////////////////////////////////////////////////////////
+// writeEnd()
+//
+// Internal, private method. Writes the end of list marker, if there is room.
+//
+//  Parameter   Description
+//  ---------   -----------------------------
+//  offset      Offset of the end of the list
+//  retval      true on success, false on error
+
+bool TMF882XCalibrationStore::writeEnd(uint32_t offset)
+{
+    const uint8_t marker[kCalStoreEndSize] = {0, 0};
+
+    if (offset + kCalStoreEndSize > size())
+        return true;
+
+    return write(offset, marker, kCalStoreEndSize);
+}
+
+///////////////////////////////////////////////////////////////////////
+// compact()
+//
+// Internal, private method. Moves the live records of the list down over the
+// erased ones, and ends the list after them.
+//
+//  Parameter   Description
+//  ---------   -----------------------------
+//  end         Offset of the end of the list - the new end on return
+//  retval      true on success, false on error
+
+bool TMF882XCalibrationStore::compact(uint32_t &end)
+{
+    uint8_t header[kCalStoreHeaderSize];
+    uint8_t block[kCalStoreCopySize];
+    uint32_t pos = 0;
+    uint32_t to = 0;
+
+    // the records up to the end were checked by find()
+    while (pos < end)
+    {
+        if (!read(pos, header, kCalStoreHeaderSize))
+            return false;
+
+        uint32_t recSize =
+            kCalStoreRecordSize(header[kCalStoreLengthOffset] | (header[kCalStoreLengthOffset + 1] << 8));
+
+        if (!(header[kCalStoreFlagsOffset] & kCalStoreFlagErased))
+        {
+            // records only move down, so a forward copy is safe
+            for (uint32_t i = 0; to != pos && i < recSize; i += kCalStoreCopySize)
+            {
+                uint16_t n = recSize - i < kCalStoreCopySize ? recSize - i : kCalStoreCopySize;
+
+                if (!read(pos + i, block, n) || !write(to + i, block, n))
+                    return false;
+            }
+            to += recSize;
+        }
+        pos += recSize;
+    }
+    end = to;
+
+    return writeEnd(end);
+}
+
+///////////////////////////////////////////////////////////////////////
+// load()
+//
+// Load the calibration of a device from the store.
+//
+//  Parameter   Description
+//  ---------   -----------------------------
+//  uid         The device unique ID - from getDeviceUniqueID()
+//  is8x8       true for the calibration of 8x8 mode
+//  tofCalib    The calibration data loaded
+//  retval      true if found, false if not or on error
+
+bool TMF882XCalibrationStore::load(const struct tmf882x_mode_app_dev_UID &uid, bool is8x8,
+                                   struct tmf882x_mode_app_calib &tofCalib)
+{
+    char key[kCalStoreUIDSize];
+    uint32_t offset, end;
+    uint16_t length;
+    uint8_t crc[2];
+
+    calStoreKey(uid, key);
+
+    if (!find(key, is8x8 ? kCalStoreFlag8x8 : 0, offset, length, end))
+        return false;
+
+    if (!read(offset + kCalStoreCRCOffset, crc, sizeof(crc)) ||
+        !read(offset + kCalStoreHeaderSize, tofCalib.data, length))
+        return false;
+
+    // A damaged record isn't used - the device is calibrated again
+    if (tmf882xStreamCRC(0xFFFF, tofCalib.data, length) != (crc[0] | (crc[1] << 8)))
+        return false;
+
+    tofCalib.calib_len = length;
+
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////
+// save()
+//
+// Save the calibration of a device to the store.
+//
+//  Parameter   Description
+//  ---------   -----------------------------
+//  uid         The device unique ID - from getDeviceUniqueID()
+//  is8x8       true for the calibration of 8x8 mode
+//  tofCalib    The calibration data to save
+//  retval      true on success, false on error - or if the store is full
+
+bool TMF882XCalibrationStore::save(const struct tmf882x_mode_app_dev_UID &uid, bool is8x8,
+                                   const struct tmf882x_mode_app_calib &tofCalib)
+{
+    uint8_t header[kCalStoreHeaderSize];
+    uint8_t flags = is8x8 ? kCalStoreFlag8x8 : 0;
+    uint16_t length = tofCalib.calib_len;
+    uint32_t offset, end;
+    uint16_t oldLength;
+
+    if (!length || length > TMF882X_MAX_CALIB_SIZE || kCalStoreRecordSize(length) > size())
+        return false;
+
+    calStoreKey(uid, (char *)&header[kCalStoreUIDOffset]);
+
+    bool found = find((char *)&header[kCalStoreUIDOffset], flags, offset, oldLength, end);
+    bool isNew = !found || oldLength != length;
+
+    // Replace the record in place if it is the same size, else erase it and
+    // add a new one - compacting the list if the storage is full. The records
+    // of other devices are never dropped - if there still isn't room, the save
+    // fails.
+    if (isNew)
+    {
+        if (found)
+        {
+            uint8_t erased = flags | kCalStoreFlagErased;
+
+            if (!write(offset + kCalStoreFlagsOffset, &erased, 1))
+                return false;
+        }
+
+        if (kCalStoreRecordSize(length) > size() - end)
+        {
+            if (!compact(end))
+                return false;
+
+            if (kCalStoreRecordSize(length) > size() - end)
+            {
+                commit();
+                return false;
+            }
+        }
+        offset = end;
+    }
+
+    uint16_t crc = tmf882xStreamCRC(0xFFFF, tofCalib.data, length);
+
+    header[0] = kCalStoreMagic0;
+    header[1] = kCalStoreMagic1;
+    header[kCalStoreFlagsOffset] = flags;
+    header[kCalStoreLengthOffset] = length & 0xFF;
+    header[kCalStoreLengthOffset + 1] = length >> 8;
+    header[kCalStoreCRCOffset] = crc & 0xFF;
+    header[kCalStoreCRCOffset + 1] = crc >> 8;
+
+    if (!write(offset, header, kCalStoreHeaderSize) ||
+        !write(offset + kCalStoreHeaderSize, tofCalib.data, length))
+        return false;
+
+    // A new record is the last one
+    if (isNew)
+    {
+        if (!writeEnd(offset + kCalStoreRecordSize(length)))
+            return false;
+    }
+
+    return commit();
+}
+
+///////////////////////////////////////////////////////////////////////
+// erase()
+//
+// Erase the calibration of a device from the store, so the next init()
+// calibrates it again.
+//
+//  Parameter   Description
+//  ---------   -----------------------------
+//  uid         The device unique ID - from getDeviceUniqueID()
+//  is8x8       true for the calibration of 8x8 mode
+//  retval      true on success or if not found, false on error
+
+bool TMF882XCalibrationStore::erase(const struct tmf882x_mode_app_dev_UID &uid, bool is8x8)
+{
+    char key[kCalStoreUIDSize];
+    uint8_t flags = is8x8 ? kCalStoreFlag8x8 : 0;
+    uint32_t offset, end;
+    uint16_t length;
+
+    calStoreKey(uid, key);
+
+    if (!find(key, flags, offset, length, end))
+        return true;
+
+    flags |= kCalStoreFlagErased;
+
+    if (!write(offset + kCalStoreFlagsOffset, &flags, 1))
+        return false;
+
+    return commit();
+}
+
+///////////////////////////////////////////////////////////////////////
+// clear()
+//
+// Drop all the records of the store.
+//
+//  Parameter   Description
+//  ---------   -----------------------------
+//  retval      true on success, false on error
+
+bool TMF882XCalibrationStore::clear(void)
+{
+    if (!writeEnd(0))
+        return false;
+
+    return commit();
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// TMF882XCalibrationMemory
+
+bool TMF882XCalibrationMemory::begin(uint8_t *buffer, uint32_t size)
+{
+    if (!buffer || !size)
+        return false;
+
+    _buffer = buffer;
+    _size = size;
+
+    memset(_buffer, 0, _size);
+
+    return true;
+}
+
+uint32_t TMF882XCalibrationMemory::size(void)
+{
+    return _size;
+}
+
+bool TMF882XCalibrationMemory::read(uint32_t offset, uint8_t *data, uint16_t length)
+{
+    if (!_buffer || offset > _size || length > _size - offset)
+        return false;
+
+    memcpy(data, _buffer + offset, length);
+
+    return true;
+}
+
+bool TMF882XCalibrationMemory::write(uint32_t offset, const uint8_t *data, uint16_t length)
+{
+    if (!_buffer || offset > _size || length > _size - offset)
+        return false;
+
+    memcpy(_buffer + offset, data, length);
+
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// TMF882XCalibrationFlash
+
+bool TMF882XCalibrationFlash::begin(uint8_t *buffer, uint32_t size, TMF882XFlashRead readFn,
+                                    TMF882XFlashProgram programFn)
+{
+    if (!buffer || !size || !readFn || !programFn)
+        return false;
+
+    if (!readFn(buffer, size))
+        return false;
+
+    _buffer = buffer;
+    _size = size;
+    _program = programFn;
+
+    return true;
+}
+
+bool TMF882XCalibrationFlash::commit(void)
+{
+    return _program && _program(_buffer, _size);
+}
+
+#if defined(__linux__) && !defined(ARDUINO)
+
+//////////////////////////////////////////////////////////////////////////////
+// TMF882XCalibrationFile
+
+bool TMF882XCalibrationFile::begin(const char *path, uint32_t size)
+{
+    end();
+
+    if (!path || !size)
+        return false;
+
+    _file = fopen(path, "r+b");
+    if (!_file)
+        _file = fopen(path, "w+b");
+    if (!_file)
+        return false;
+
+    _size = size;
+
+    return true;
+}
+
+void TMF882XCalibrationFile::end(void)
+{
+    if (_file)
+        fclose(_file);
+
+    _file = nullptr;
+    _size = 0;
+}
+
+uint32_t TMF882XCalibrationFile::size(void)
+{
+    return _size;
+}
+
+bool TMF882XCalibrationFile::read(uint32_t offset, uint8_t *data, uint16_t length)
+{
+    if (!_file || offset > _size || length > _size - offset)
+        return false;
+
+    if (fseek(_file, offset, SEEK_SET))
+        return false;
+
+    // Past the end of the file reads as blank storage
+    size_t nRead = fread(data, 1, length, _file);
+    clearerr(_file);
+
+    memset(data + nRead, 0xFF, length - nRead);
+
+    return true;
+}
+
+bool TMF882XCalibrationFile::write(uint32_t offset, const uint8_t *data, uint16_t length)
+{
+    if (!_file || offset > _size || length > _size - offset)
+        return false;
+
+    if (fseek(_file, offset, SEEK_SET))
+        return false;
+
+    return fwrite(data, 1, length, _file) == length;
+}
+
+bool TMF882XCalibrationFile::commit(void)
+{
+    return _file && fflush(_file) == 0;
+}
+
+#endif
@@ -0,0 +1,314 @@
+// qwiic_tmf882x_calibration.h
+//
+// This is a library written for SparkFun Qwiic TMF882X boards
+//
+// SparkFun sells these bpards at its website: www.sparkfun.com
+//
+// Do you like this library? Help support SparkFun. Buy a board!
+//
+//  SparkFun Qwiic dToF Imager - TMF8820        https://www.sparkfun.com/products/19036
+//  SparkFun Qwiic Mini dToF Imager - TMF8820   https://www.sparkfun.com/products/19218
+//  SparkFun Qwiic Mini dToF Imager - TMF8821   https://www.sparkfun.com/products/19451
+//  SparkFun Qwiic dToF Imager - TMF8821        https://www.sparkfun.com/products/19037
+//
+// Written by Kirk Benell @ SparkFun Electronics, April 2022
+//
+// This library provides an abstract interface to the underlying TMF882X
+// SDK that is provided by AMS.
+//
+// Repository:
+//     https://github.com/sparkfun/SparkFun_Qwiic_TMF882X_Arduino_Library
+//
+//
+// SparkFun code, firmware, and software is released under the MIT
+// License(http://opensource.org/licenses/MIT).
+//
+// SPDX-License-Identifier: MIT
+//
+//    The MIT License (MIT)
+//
+//    Copyright (c) 2022 SparkFun Electronics
+//    Permission is hereby granted, free of charge, to any person obtaining a
+//    copy of this software and associated documentation files (the "Software"),
+//    to deal in the Software without restriction, including without limitation
+//    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//    and/or sell copies of the Software, and to permit persons to whom the
+//    Software is furnished to do so, subject to the following conditions: The
+//    above copyright notice and this permission notice shall be included in all
+//    copies or substantial portions of the Software. THE SOFTWARE IS PROVIDED
+//    "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+//    NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+//    PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+//    ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+//    CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+// Header for the TMF882X calibration store
+
+#pragma once
+
+#include <stdint.h>
+
+#include "qwiic_tmf882x.h"
+
+// A calibration store keeps the factory calibration of each device, keyed by
+// the device unique ID and the 8x8 mode. Set on the device object with
+// QwDevTMF882X::setCalibrationStore(), the calibration of a device is restored
+// when it is initialized. If the store has none, the device is calibrated and
+// the calibration is saved.
+//
+// The store is a list of records, from the start of the storage - all values
+// little endian:
+//
+//    magic       2 bytes     kCalStoreMagic0, kCalStoreMagic1
+//    flags       1 byte      kCalStoreFlag8x8, kCalStoreFlagErased
+//    uid         16 bytes    UID string of the device, zero padded
+//    length      2 bytes     length of the calibration data
+//    crc         2 bytes     CRC-16/CCITT-FALSE of the calibration data
+//    data        length bytes
+//
+// The list ends at the first record without the magic bytes - blank EEPROM or
+// flash ends it. A record is replaced in place if its length is the same, else
+// it is marked erased and a new record is added. When the storage is full, the
+// erased records are reclaimed - the list is compacted. If there still isn't
+// room, save() fails; the records of other devices are never dropped.
+//
+// The storage is accessed through read() and write() - the backends implement
+// these for a medium. commit() is called once a record is written.
+
+#define kCalStoreMagic0 'T'
+#define kCalStoreMagic1 'C'
+
+#define kCalStoreFlag8x8 0x01
+#define kCalStoreFlagErased 0x80
+
+// Size of the UID in a record. The device UID string is four bytes in dotted
+// decimal - "255.255.255.255" at most, 15 characters and the terminator.
+#define kCalStoreUIDSize 16
+#define kCalStoreHeaderSize (7 + kCalStoreUIDSize)
+
+// Storage size of a record - 211 bytes for a 3x3/4x4 mode calibration, 775 bytes
+// for an 8x8 mode calibration
+#define kCalStoreRecordSize(length) (kCalStoreHeaderSize + (uint32_t)(length))
+
+// Default size of a calibration file
+#define kCalStoreDefaultFileSize 8192
+
+//////////////////////////////////////////////////////////////////////////////
+// TMF882XCalibrationStore
+//
+// Base class of the calibration store backends.
+
+class TMF882XCalibrationStore
+{
+  public:
+    virtual ~TMF882XCalibrationStore(void)
+    {
+    }
+
+    ///////////////////////////////////////////////////////////////////////
+    // load()
+    //
+    // Load the calibration of a device from the store.
+    //
+    //  Parameter   Description
+    //  ---------   -----------------------------
+    //  uid         The device unique ID - from getDeviceUniqueID()
+    //  is8x8       true for the calibration of 8x8 mode
+    //  tofCalib    The calibration data loaded
+    //  retval      true if found, false if not or on error
+
+    bool load(const struct tmf882x_mode_app_dev_UID &uid, bool is8x8, struct tmf882x_mode_app_calib &tofCalib);
+
+    ///////////////////////////////////////////////////////////////////////
+    // save()
+    //
+    // Save the calibration of a device to the store.
+    //
+    //  Parameter   Description
+    //  ---------   -----------------------------
+    //  uid         The device unique ID - from getDeviceUniqueID()
+    //  is8x8       true for the calibration of 8x8 mode
+    //  tofCalib    The calibration data to save
+    //  retval      true on success, false on error
+
+    bool save(const struct tmf882x_mode_app_dev_UID &uid, bool is8x8, const struct tmf882x_mode_app_calib &tofCalib);
+
+    ///////////////////////////////////////////////////////////////////////
+    // erase()
+    //
+    // Erase the calibration of a device from the store, so the next init()
+    // calibrates it again.
+    //
+    //  Parameter   Description
+    //  ---------   -----------------------------
+    //  uid         The device unique ID - from getDeviceUniqueID()
+    //  is8x8       true for the calibration of 8x8 mode
+    //  retval      true on success or if not found, false on error
+
+    bool erase(const struct tmf882x_mode_app_dev_UID &uid, bool is8x8);
+
+    ///////////////////////////////////////////////////////////////////////
+    // clear()
+    //
+    // Drop all the records of the store.
+    //
+    //  Parameter   Description
+    //  ---------   -----------------------------
+    //  retval      true on success, false on error
+
+    bool clear(void);
+
+  protected:
+    // Size of the storage, in bytes
+    virtual uint32_t size(void) = 0;
+
+    // Read and write a block of the storage - return true if all bytes were
+    // read or written
+    virtual bool read(uint32_t offset, uint8_t *data, uint16_t length) = 0;
+    virtual bool write(uint32_t offset, const uint8_t *data, uint16_t length) = 0;
+
+    // Make the writes since the last commit persistent
+    virtual bool commit(void)
+    {
+        return true;
+    }
+
+  private:
+    bool find(const char *key, uint8_t flags, uint32_t &offset, uint16_t &length, uint32_t &end);
+    bool writeEnd(uint32_t offset);
+    bool compact(uint32_t &end);
+};
+
+//////////////////////////////////////////////////////////////////////////////
+// TMF882XCalibrationMemory
+//
+// Calibration store in a RAM buffer provided by the application. The records
+// are lost on a reset - also used as the base of the flash store.
+
+class TMF882XCalibrationMemory : public TMF882XCalibrationStore
+{
+  public:
+    TMF882XCalibrationMemory(void) : _buffer{nullptr}, _size{0}
+    {
+    }
+
+    ///////////////////////////////////////////////////////////////////////
+    // begin()
+    //
+    // Set the buffer of the store. The buffer is cleared.
+    //
+    //  Parameter   Description
+    //  ---------   -----------------------------
+    //  buffer      The buffer - provided by the application
+    //  size        Size of the buffer, in bytes
+    //  retval      true on success, false on error
+
+    bool begin(uint8_t *buffer, uint32_t size);
+
+  protected:
+    uint32_t size(void);
+    bool read(uint32_t offset, uint8_t *data, uint16_t length);
+    bool write(uint32_t offset, const uint8_t *data, uint16_t length);
+
+    uint8_t *_buffer;
+    uint32_t _size;
+};
+
+//////////////////////////////////////////////////////////////////////////////
+// TMF882XCalibrationFlash
+//
+// Calibration store in a region of flash. Flash is erased and programmed by
+// page, with platform specific methods - so the store keeps a copy of the
+// region in a RAM buffer, and the application provides the functions that
+// read the region into the buffer, and erase and program the region from it.
+// The region is programmed once per record saved.
+
+// Read the flash region into the buffer - return true on success
+typedef bool (*TMF882XFlashRead)(uint8_t *buffer, uint32_t size);
+
+// Erase the flash region, and program it with the buffer - return true on success
+typedef bool (*TMF882XFlashProgram)(const uint8_t *buffer, uint32_t size);
+
+class TMF882XCalibrationFlash : public TMF882XCalibrationMemory
+{
+  public:
+    TMF882XCalibrationFlash(void) : _program{nullptr}
+    {
+    }
+
+    ///////////////////////////////////////////////////////////////////////
+    // begin()
+    //
+    // Set the buffer of the store, and read the flash region into it.
+    //
+    //  Parameter   Description
+    //  ---------   -----------------------------
+    //  buffer      The buffer - the size of the flash region
+    //  size        Size of the buffer and flash region, in bytes
+    //  readFn      Function that reads the flash region
+    //  programFn   Function that erases and programs the flash region
+    //  retval      true on success, false on error
+
+    bool begin(uint8_t *buffer, uint32_t size, TMF882XFlashRead readFn, TMF882XFlashProgram programFn);
+
+  protected:
+    bool commit(void);
+
+  private:
+    TMF882XFlashProgram _program;
+};
+
+#if defined(__linux__) && !defined(ARDUINO)
+
+#include <stdio.h>
+
+//////////////////////////////////////////////////////////////////////////////
+// TMF882XCalibrationFile
+//
+// Calibration store in a file - Linux hosts only. The file is created if it
+// doesn't exist.
+
+class TMF882XCalibrationFile : public TMF882XCalibrationStore
+{
+  public:
+    TMF882XCalibrationFile(void) : _file{nullptr}, _size{0}
+    {
+    }
+
+    ~TMF882XCalibrationFile(void)
+    {
+        end();
+    }
+
+    ///////////////////////////////////////////////////////////////////////
+    // begin()
+    //
+    // Open the file of the store.
+    //
+    //  Parameter   Description
+    //  ---------   -----------------------------
+    //  path        Path of the file
+    //  size        optional. Largest size of the file, in bytes
+    //  retval      true on success, false on error
+
+    bool begin(const char *path, uint32_t size = kCalStoreDefaultFileSize);
+
+    ///////////////////////////////////////////////////////////////////////
+    // end()
+    //
+    // Close the file of the store.
+
+    void end(void);
+
+  protected:
+    uint32_t size(void);
+    bool read(uint32_t offset, uint8_t *data, uint16_t length);
+    bool write(uint32_t offset, const uint8_t *data, uint16_t length);
+    bool commit(void);
+
+  private:
+    FILE *_file;
+    uint32_t _size;
+};
+
+#endif
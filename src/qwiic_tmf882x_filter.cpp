@@ -0,0 +1,347 @@
+// qwiic_tmf882x_filter.cpp
+//
+// This is a library written for SparkFun Qwiic TMF882X boards
+//
+// SparkFun sells these bpards at its website: www.sparkfun.com
+//
+// Do you like this library? Help support SparkFun. Buy a board!
+//
+//  SparkFun Qwiic dToF Imager - TMF8820        https://www.sparkfun.com/products/19036
+//  SparkFun Qwiic Mini dToF Imager - TMF8820   https://www.sparkfun.com/products/19218
+//  SparkFun Qwiic Mini dToF Imager - TMF8821   https://www.sparkfun.com/products/19451
+//  SparkFun Qwiic dToF Imager - TMF8821        https://www.sparkfun.com/products/19037
+//
+// Written by Kirk Benell @ SparkFun Electronics, April 2022
+//
+// This library provides an abstract interface to the underlying TMF882X
+// SDK that is provided by AMS.
+//
+// Repository:
+//     https://github.com/sparkfun/SparkFun_Qwiic_TMF882X_Arduino_Library
+//
+//
+// SparkFun code, firmware, and software is released under the MIT
+// License(http://opensource.org/licenses/MIT).
+//
+// SPDX-License-Identifier: MIT
+//
+//    The MIT License (MIT)
+//
+//    Copyright (c) 2022 SparkFun Electronics
+//    Permission is hereby granted, free of charge, to any person obtaining a
+//    copy of this software and associated documentation files (the "Software"),
+//    to deal in the Software without restriction, including without limitation
+//    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//    and/or sell copies of the Software, and to permit persons to whom the
+//    Software is furnished to do so, subject to the following conditions: The
+//    above copyright notice and this permission notice shall be included in all
+//    copies or substantial portions of the Software. THE SOFTWARE IS PROVIDED
+//    "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+//    NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+//    PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+//    ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+//    CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+// Per-zone distance filter for the TMF882X
+
+#include <string.h>
+
+#include "qwiic_tmf882x_filter.h"
+
+static inline uint16_t difference(uint16_t a, uint16_t b)
+{
+    return a > b ? a - b : b - a;
+}
+
+///////////////////////////////////////////////////////////////////////
+// begin()
+//
+// Set the zone states of the filter, and reset them.
+//
+//  Parameter   Description
+//  ---------   -----------------------------
+//  zones       The zone states
+//  nZones      Number of zone states
+//  retval      true on success, false on error
+
+bool TMF882XZoneFilter::begin(struct TMF882XFilterZone *zones, uint16_t nZones)
+{
+    if (!zones || !nZones)
+        return false;
+
+    _zones = zones;
+    _nZones = nZones;
+
+    reset();
+
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////
+// setMedian()
+//
+// Use a median filter.
+//
+//  Parameter   Description
+//  ---------   -----------------------------
+//  length      Number of distances
+//  retval      true on success, false on error
+
+bool TMF882XZoneFilter::setMedian(uint8_t length)
+{
+    if (length < 2 || length > kFilterMaxMedian)
+        return false;
+
+    _type = kFilterMedian;
+    _length = length;
+
+    reset();
+
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////
+// setExponential()
+//
+// Use an exponential moving average filter.
+//
+//  Parameter   Description
+//  ---------   -----------------------------
+//  weight      Weight of a new distance, out of 256
+//  retval      true on success, false on error
+
+bool TMF882XZoneFilter::setExponential(uint16_t weight)
+{
+    if (!weight || weight > 256)
+        return false;
+
+    _type = kFilterExponential;
+    _weight = weight;
+
+    reset();
+
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////
+// setKalman()
+//
+// Use a 1D Kalman filter.
+//
+//  Parameter        Description
+//  ---------        -----------------------------
+//  processNoise     Variance the distance changes by each frame, in mm^2
+//  measurementNoise Variance of the measured distance, in mm^2
+//  retval           true on success, false on error
+
+bool TMF882XZoneFilter::setKalman(uint16_t processNoise, uint16_t measurementNoise)
+{
+    if (!measurementNoise)
+        return false;
+
+    _type = kFilterKalman;
+    _processNoise = processNoise;
+    _measurementNoise = measurementNoise;
+
+    reset();
+
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////
+// reset()
+//
+// Reset all the zones.
+
+void TMF882XZoneFilter::reset(void)
+{
+    if (_zones)
+        memset(_zones, 0, sizeof(struct TMF882XFilterZone) * _nZones);
+}
+
+///////////////////////////////////////////////////////////////////////
+// update()
+//
+// Internal, private method. Add a distance to the state of a zone, and
+// return the filtered distance. A zone with no samples starts from the
+// distance.
+//
+// In fixed point, the distances and variances have kFilterFracBits
+// fractional bits, and the Kalman gain 8. With 16 bit distances and noise
+// values, no product exceeds 30 bits.
+//
+//  Parameter   Description
+//  ---------   -----------------------------
+//  zone        The zone state
+//  distance    The distance, in mm
+//  retval      The filtered distance, in mm
+
+uint16_t TMF882XZoneFilter::update(struct TMF882XFilterZone *zone, uint16_t distance)
+{
+    if (_type == kFilterMedian)
+    {
+        zone->samples[zone->next] = distance;
+        zone->next = zone->next + 1 < _length ? zone->next + 1 : 0;
+        if (zone->nSamples < _length)
+            zone->nSamples++;
+
+        // sort a copy - at most kFilterMaxMedian values
+        uint16_t sorted[kFilterMaxMedian];
+        uint8_t n = zone->nSamples;
+
+        for (uint8_t i = 0; i < n; i++)
+        {
+            uint16_t value = zone->samples[i];
+            uint8_t j = i;
+
+            for (; j > 0 && sorted[j - 1] > value; j--)
+                sorted[j] = sorted[j - 1];
+            sorted[j] = value;
+        }
+
+        return n & 1 ? sorted[n / 2] : (uint16_t)(((uint32_t)sorted[n / 2 - 1] + sorted[n / 2] + 1) / 2);
+    }
+
+#ifdef TMF882X_FILTER_FLOAT
+    if (!zone->nSamples)
+    {
+        zone->estimate = distance;
+        zone->variance = _measurementNoise;
+        zone->nSamples = 1;
+    }
+    else if (_type == kFilterExponential)
+        zone->estimate += (distance - zone->estimate) * _weight / 256.0f;
+    else
+    {
+        zone->variance += _processNoise;
+
+        float gain = zone->variance / (zone->variance + _measurementNoise);
+
+        zone->estimate += gain * (distance - zone->estimate);
+        zone->variance -= gain * zone->variance;
+    }
+
+    return (uint16_t)(zone->estimate + 0.5f);
+#else
+    int32_t value = (int32_t)distance << kFilterFracBits;
+
+    if (!zone->nSamples)
+    {
+        zone->estimate = value;
+        zone->variance = (int32_t)_measurementNoise << kFilterFracBits;
+        zone->nSamples = 1;
+    }
+    else if (_type == kFilterExponential)
+        zone->estimate += ((value - zone->estimate) * _weight + 128) >> 8;
+    else
+    {
+        zone->variance += (int32_t)_processNoise << kFilterFracBits;
+
+        int32_t gain = (zone->variance << 8) / (zone->variance + ((int32_t)_measurementNoise << kFilterFracBits));
+
+        zone->estimate += ((value - zone->estimate) * gain + 128) >> 8;
+        zone->variance -= (zone->variance * gain + 128) >> 8;
+    }
+
+    return (uint16_t)((zone->estimate + (1 << (kFilterFracBits - 1))) >> kFilterFracBits);
+#endif
+}
+
+///////////////////////////////////////////////////////////////////////
+// filter()
+//
+// Filter a set of results, in place. The compact results have a slot for
+// each zone and target, so they're filtered first - then the distances of
+// the results list are copied from the slots.
+//
+//  Parameter   Description
+//  ---------   -----------------------------
+//  results     The results
+//  compact     The compact copy of the results
+//  capture     Index of the capture in the frame
+
+void TMF882XZoneFilter::filter(struct tmf882x_msg_meas_results *results, struct tmf882x_meas_compact *compact,
+                               uint8_t capture)
+{
+    if (!_zones || _type == kFilterNone || !results || !compact)
+        return;
+
+    uint32_t first = (uint32_t)capture * kFilterZonesPerCapture;
+
+    if (first >= _nZones)
+        return;
+
+    struct TMF882XFilterZone *zone = _zones + first;
+    uint32_t nZones = _nZones - first;
+    uint32_t i = 0;
+
+    for (uint8_t sub = 0; sub < TMF882X_NUM_SUB_CAPTURES; sub++)
+    {
+        for (uint8_t ch = 0; ch < TMF882X_NUM_RESULT_CH; ch++)
+        {
+            for (uint8_t target = 0; target < TMF882X_NUM_CH_TARGETS && i < nZones; target++, i++, zone++)
+            {
+                uint16_t *distance = &compact->distance_mm[sub][ch][target];
+                uint8_t confidence = compact->confidence[sub][ch][target];
+                bool present = *distance || confidence;
+
+                bool jump = present && _jumpMM && zone->nSamples && difference(*distance, zone->output) > _jumpMM;
+
+                // a second jump in a row, to the same place - the target moved, start again from it
+                if (jump && zone->jumped && difference(*distance, zone->jump) <= _jumpMM)
+                {
+                    zone->nSamples = 0;
+                    jump = false;
+                }
+                zone->jumped = jump && confidence >= _minConfidence;
+                zone->jump = *distance;
+
+                if (present && confidence >= _minConfidence && !jump)
+                {
+                    if (!zone->nSamples)
+                        zone->next = 0;
+
+                    zone->misses = 0;
+                    zone->output = update(zone, *distance);
+                    *distance = zone->output;
+                }
+                else if (zone->nSamples)
+                {
+                    if (++zone->misses >= _resetFrames)
+                        zone->nSamples = 0;
+                    else if (present)
+                        *distance = zone->output;
+                }
+            }
+        }
+    }
+
+    // The results list - the target index counts the targets present in the channel
+    for (uint32_t r = 0; r < results->num_results; r++)
+    {
+        struct tmf882x_meas_result *result = &results->results[r];
+
+        if (result->channel < 1 || result->channel > TMF882X_NUM_RESULT_CH ||
+            result->sub_capture >= TMF882X_NUM_SUB_CAPTURES)
+            continue;
+
+        uint32_t index = result->ch_target_idx;
+
+        for (uint8_t target = 0; target < TMF882X_NUM_CH_TARGETS; target++)
+        {
+            uint8_t ch = result->channel - 1;
+
+            if (!compact->distance_mm[result->sub_capture][ch][target] &&
+                !compact->confidence[result->sub_capture][ch][target])
+                continue;
+
+            if (!index--)
+            {
+                result->distance_mm = compact->distance_mm[result->sub_capture][ch][target];
+                break;
+            }
+        }
+    }
+}
@@ -0,0 +1,286 @@
+// qwiic_tmf882x_filter.h
+//
+// This is a library written for SparkFun Qwiic TMF882X boards
+//
+// SparkFun sells these bpards at its website: www.sparkfun.com
+//
+// Do you like this library? Help support SparkFun. Buy a board!
+//
+//  SparkFun Qwiic dToF Imager - TMF8820        https://www.sparkfun.com/products/19036
+//  SparkFun Qwiic Mini dToF Imager - TMF8820   https://www.sparkfun.com/products/19218
+//  SparkFun Qwiic Mini dToF Imager - TMF8821   https://www.sparkfun.com/products/19451
+//  SparkFun Qwiic dToF Imager - TMF8821        https://www.sparkfun.com/products/19037
+//
+// Written by Kirk Benell @ SparkFun Electronics, April 2022
+//
+// This library provides an abstract interface to the underlying TMF882X
+// SDK that is provided by AMS.
+//
+// Repository:
+//     https://github.com/sparkfun/SparkFun_Qwiic_TMF882X_Arduino_Library
+//
+//
+// SparkFun code, firmware, and software is released under the MIT
+// License(http://opensource.org/licenses/MIT).
+//
+// SPDX-License-Identifier: MIT
+//
+//    The MIT License (MIT)
+//
+//    Copyright (c) 2022 SparkFun Electronics
+//    Permission is hereby granted, free of charge, to any person obtaining a
+//    copy of this software and associated documentation files (the "Software"),
+//    to deal in the Software without restriction, including without limitation
+//    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//    and/or sell copies of the Software, and to permit persons to whom the
+//    Software is furnished to do so, subject to the following conditions: The
+//    above copyright notice and this permission notice shall be included in all
+//    copies or substantial portions of the Software. THE SOFTWARE IS PROVIDED
+//    "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+//    NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+//    PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+//    ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+//    CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+// Header for the TMF882X per-zone distance filter
+
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+
+#include "qwiic_tmf882x.h"
+
+// A filter stage for the distances of each zone and target, run on the results
+// before they're passed to the handlers - see QwDevTMF882X::setFilter(). The
+// filters are incremental, with a fixed size state for each zone:
+//
+//    kFilterMedian        median of the last N distances - rejects outliers
+//    kFilterExponential   exponential moving average - new = old + weight * (in - old)
+//    kFilterKalman        1D Kalman filter, of a constant distance with process
+//                         noise - the weight adapts to the noise of the zone
+//
+// Only distances with at least the minimum confidence update a zone. While a
+// zone reports a target below the minimum confidence, its last filtered distance
+// is reported. A zone is reset when it reports no target, or only low confidence
+// targets, for the reset frame count. A distance that jumps by more than the jump
+// distance is held out as an outlier - if the next distance jumps to the same
+// place, the target moved, and the zone is reset to it.
+//
+// The exponential and Kalman filters use float math when TMF882X_FILTER_FLOAT is
+// defined - by default on hosts and boards with an FPU - and fixed point math
+// otherwise. Define TMF882X_FILTER_FIXED to always use fixed point math.
+
+#if !defined(TMF882X_FILTER_FLOAT) && !defined(TMF882X_FILTER_FIXED) && \
+    (defined(__ARM_FP) || defined(__x86_64__) || defined(__i386__) || defined(__aarch64__))
+#define TMF882X_FILTER_FLOAT
+#endif
+
+// Filter types
+#define kFilterNone 0
+#define kFilterMedian 1
+#define kFilterExponential 2
+#define kFilterKalman 3
+
+// Max length of the median filter
+#define kFilterMaxMedian 5
+
+// Zones of a capture - a state for each result slot (sub capture, channel, target)
+#define kFilterZonesPerCapture TMF882X_MAX_MEAS_RESULTS
+
+// Defaults
+#define kFilterDefaultResetFrames 3
+
+// Fractional bits of the fixed point distances and variances
+#define kFilterFracBits 4
+
+#ifdef TMF882X_FILTER_FLOAT
+typedef float TMF882XFilterValue;
+#else
+typedef int32_t TMF882XFilterValue;
+#endif
+
+//////////////////////////////////////////////////////////////////////////////
+// Filter Zone state
+//
+// The state of one zone and target. An array of these is provided by the caller -
+// kFilterZonesPerCapture for 3x3 and 4x4 modes, and kMaxDepthFrameCaptures times
+// that in 8x8 mode, a set for each capture of the frame.
+
+struct TMF882XFilterZone
+{
+    union {
+        uint16_t samples[kFilterMaxMedian]; // median - the last distances, a ring
+        struct
+        {
+            TMF882XFilterValue estimate; // exponential, Kalman - the filtered distance
+            TMF882XFilterValue variance; // Kalman - variance of the estimate
+        };
+    };
+    uint8_t nSamples; // samples in the state - 0 if the zone is reset
+    uint8_t next;     // median - next sample slot
+    uint8_t misses;   // frames since the last sample
+    bool jumped;      // the last distance was held out as a jump
+    uint16_t output;  // last filtered distance
+    uint16_t jump;    // the distance held out
+};
+
+//////////////////////////////////////////////////////////////////////////////
+// TMF882XZoneFilter
+//
+// Filters the distances of each zone of the results of a device. The zone states
+// are provided by the caller. Set one filter type, then pass the filter to the
+// device with setFilter().
+
+class TMF882XZoneFilter
+{
+  public:
+    TMF882XZoneFilter(void)
+        : _zones{nullptr}, _nZones{0}, _type{kFilterNone}, _length{1}, _weight{256}, _processNoise{0},
+          _measurementNoise{0}, _minConfidence{0}, _resetFrames{kFilterDefaultResetFrames}, _jumpMM{0}
+    {
+    }
+
+    ///////////////////////////////////////////////////////////////////////
+    // begin()
+    //
+    // Set the zone states of the filter, and reset them
+    //
+    //  Parameter   Description
+    //  ---------   -----------------------------
+    //  zones       The zone states
+    //  nZones      Number of zone states - zones past these aren't filtered
+    //  retval      true on success, false on error
+
+    bool begin(struct TMF882XFilterZone *zones, uint16_t nZones);
+
+    ///////////////////////////////////////////////////////////////////////
+    // setMedian()
+    //
+    // Use a median filter
+    //
+    //  Parameter   Description
+    //  ---------   -----------------------------
+    //  length      Number of distances - 2 to kFilterMaxMedian
+    //  retval      true on success, false on error
+
+    bool setMedian(uint8_t length);
+
+    ///////////////////////////////////////////////////////////////////////
+    // setExponential()
+    //
+    // Use an exponential moving average filter
+    //
+    //  Parameter   Description
+    //  ---------   -----------------------------
+    //  weight      Weight of a new distance, out of 256 - 1 to 256
+    //  retval      true on success, false on error
+
+    bool setExponential(uint16_t weight);
+
+    ///////////////////////////////////////////////////////////////////////
+    // setKalman()
+    //
+    // Use a 1D Kalman filter
+    //
+    //  Parameter        Description
+    //  ---------        -----------------------------
+    //  processNoise     Variance the distance changes by each frame, in mm^2
+    //  measurementNoise Variance of the measured distance, in mm^2 - at least 1
+    //  retval           true on success, false on error
+
+    bool setKalman(uint16_t processNoise, uint16_t measurementNoise);
+
+    ///////////////////////////////////////////////////////////////////////
+    // setMinConfidence()
+    //
+    // Set the minimum confidence of a distance to update a zone
+    //
+    //  Parameter   Description
+    //  ---------   -----------------------------
+    //  confidence  The minimum confidence - 0 to use all distances
+
+    void setMinConfidence(uint8_t confidence)
+    {
+        _minConfidence = confidence;
+    }
+
+    ///////////////////////////////////////////////////////////////////////
+    // setResetFrames()
+    //
+    // Set the number of frames without a distance that reset a zone
+    //
+    //  Parameter   Description
+    //  ---------   -----------------------------
+    //  frames      The frame count - at least 1
+
+    void setResetFrames(uint8_t frames)
+    {
+        _resetFrames = frames ? frames : 1;
+    }
+
+    ///////////////////////////////////////////////////////////////////////
+    // setJumpReset()
+    //
+    // Set the change of distance that resets a zone, when seen on two frames
+    // in a row - the exponential and Kalman filters lag a target that moves
+    // quickly
+    //
+    //  Parameter   Description
+    //  ---------   -----------------------------
+    //  distanceMM  The distance - 0 to disable
+
+    void setJumpReset(uint16_t distanceMM)
+    {
+        _jumpMM = distanceMM;
+    }
+
+    ///////////////////////////////////////////////////////////////////////
+    // getType()
+    //
+    // Returns the filter type - kFilterNone..etc
+
+    uint8_t getType(void)
+    {
+        return _type;
+    }
+
+    ///////////////////////////////////////////////////////////////////////
+    // reset()
+    //
+    // Reset all the zones - at the start of measurements, or when the mode
+    // of the device changes
+
+    void reset(void);
+
+    ///////////////////////////////////////////////////////////////////////
+    // filter()
+    //
+    // Filter a set of results, in place. Called by the device.
+    //
+    //  Parameter   Description
+    //  ---------   -----------------------------
+    //  results     The results
+    //  compact     The compact copy of the results
+    //  capture     Index of the capture in the frame - 0 to 3 in 8x8 mode, else 0
+
+    void filter(struct tmf882x_msg_meas_results *results, struct tmf882x_meas_compact *compact, uint8_t capture);
+
+  private:
+    uint16_t update(struct TMF882XFilterZone *zone, uint16_t distance);
+
+    struct TMF882XFilterZone *_zones;
+    uint16_t _nZones;
+
+    uint8_t _type;
+    uint8_t _length;           // median
+    uint16_t _weight;          // exponential, out of 256
+    uint16_t _processNoise;    // Kalman, mm^2
+    uint16_t _measurementNoise;
+
+    uint8_t _minConfidence;
+    uint8_t _resetFrames;
+    uint16_t _jumpMM;
+};
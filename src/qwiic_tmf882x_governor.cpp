@@ -0,0 +1,285 @@
+// qwiic_tmf882x_governor.cpp
+//
+// This is a library written for SparkFun Qwiic TMF882X boards
+//
+// SparkFun sells these bpards at its website: www.sparkfun.com
+//
+// Do you like this library? Help support SparkFun. Buy a board!
+//
+//  SparkFun Qwiic dToF Imager - TMF8820        https://www.sparkfun.com/products/19036
+//  SparkFun Qwiic Mini dToF Imager - TMF8820   https://www.sparkfun.com/products/19218
+//  SparkFun Qwiic Mini dToF Imager - TMF8821   https://www.sparkfun.com/products/19451
+//  SparkFun Qwiic dToF Imager - TMF8821        https://www.sparkfun.com/products/19037
+//
+// Written by Kirk Benell @ SparkFun Electronics, April 2022
+//
+// This library provides an abstract interface to the underlying TMF882X
+// SDK that is provided by AMS.
+//
+// Repository:
+//     https://github.com/sparkfun/SparkFun_Qwiic_TMF882X_Arduino_Library
+//
+//
+// SparkFun code, firmware, and software is released under the MIT
+// License(http://opensource.org/licenses/MIT).
+//
+// SPDX-License-Identifier: MIT
+//
+//    The MIT License (MIT)
+//
+//    Copyright (c) 2022 SparkFun Electronics
+//    Permission is hereby granted, free of charge, to any person obtaining a
+//    copy of this software and associated documentation files (the "Software"),
+//    to deal in the Software without restriction, including without limitation
+//    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//    and/or sell copies of the Software, and to permit persons to whom the
+//    Software is furnished to do so, subject to the following conditions: The
+//    above copyright notice and this permission notice shall be included in all
+//    copies or substantial portions of the Software. THE SOFTWARE IS PROVIDED
+//    "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+//    NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+//    PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+//    ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+//    CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+// Frame rate governor for the TMF882X
+
+#include "qwiic_tmf882x_governor.h"
+
+///////////////////////////////////////////////////////////////////////
+// setIterationLimits()
+//
+// Set the range of the iterations of a measurement.
+//
+//  Parameter   Description
+//  ---------   -----------------------------
+//  minKilo     The fewest iterations, in thousands
+//  maxKilo     The most iterations, in thousands
+//  retval      true on success, false on error
+
+bool TMF882XGovernor::setIterationLimits(uint16_t minKilo, uint16_t maxKilo)
+{
+    if (!minKilo || minKilo > maxKilo)
+        return false;
+
+    _minKiloIterations = minKilo;
+    _maxKiloIterations = maxKilo;
+
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////
+// setPeriodLimits()
+//
+// Set the range of the frame period.
+//
+//  Parameter   Description
+//  ---------   -----------------------------
+//  minMS       The period at the fewest iterations, in milli-seconds
+//  maxMS       The period at the most iterations, in milli-seconds
+//  retval      true on success, false on error
+
+bool TMF882XGovernor::setPeriodLimits(uint16_t minMS, uint16_t maxMS)
+{
+    if (!minMS || minMS > maxMS)
+        return false;
+
+    _minPeriodMS = minMS;
+    _maxPeriodMS = maxMS;
+
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////
+// setConfidence()
+//
+// Set the mean confidence of weak and strong frames.
+//
+//  Parameter   Description
+//  ---------   -----------------------------
+//  low         The low confidence
+//  high        The high confidence
+//  retval      true on success, false on error
+
+bool TMF882XGovernor::setConfidence(uint8_t low, uint8_t high)
+{
+    if (low >= high)
+        return false;
+
+    _lowConfidence = low;
+    _highConfidence = high;
+
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////
+// setHoldFrames()
+//
+// Set the number of weak or strong frames in a row before a step.
+//
+//  Parameter   Description
+//  ---------   -----------------------------
+//  upFrames    Weak frames before a step up
+//  downFrames  Strong frames before a step down
+//  retval      true on success, false on error
+
+bool TMF882XGovernor::setHoldFrames(uint8_t upFrames, uint8_t downFrames)
+{
+    if (!upFrames || !downFrames)
+        return false;
+
+    _upFrames = upFrames;
+    _downFrames = downFrames;
+
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////
+// reset()
+//
+// Reset the frame counts.
+
+void TMF882XGovernor::reset(void)
+{
+    _direction = 0;
+    _strongFrames = 0;
+    _weakFrames = 0;
+
+    _confidenceTotal = 0;
+    _nResults = 0;
+    _ambient = 0;
+    _photonTotal = 0;
+    _nCaptures = 0;
+}
+
+///////////////////////////////////////////////////////////////////////
+// update()
+//
+// Add a set of results to the frame. At the end of the frame, decide if it
+// is strong or weak, and if a step is due.
+//
+//  Parameter   Description
+//  ---------   -----------------------------
+//  results     The results
+//  frameEnd    true if the results are the last capture of the frame
+//  retval      true if a step is due
+
+bool TMF882XGovernor::update(const struct tmf882x_msg_meas_results *results, bool frameEnd)
+{
+    if (!results)
+        return false;
+
+    for (uint32_t i = 0; i < results->num_results; i++)
+        _confidenceTotal += results->results[i].confidence;
+
+    _nResults += results->num_results;
+    _photonTotal += results->photon_count;
+    _nCaptures++;
+
+    if (results->ambient_light > _ambient)
+        _ambient = results->ambient_light;
+
+    if (!frameEnd)
+        return false;
+
+    // the frame totals are cleared for the next frame - decide on copies
+    uint8_t confidence = _nResults ? _confidenceTotal / _nResults : 0;
+    uint32_t photons = _photonTotal / _nCaptures;
+    uint32_t ambient = _ambient;
+
+    _stats.frames++;
+    _stats.confidence = confidence;
+
+    _confidenceTotal = 0;
+    _nResults = 0;
+    _ambient = 0;
+    _photonTotal = 0;
+    _nCaptures = 0;
+
+    // A step is already due, and not applied yet?
+    if (_direction)
+        return true;
+
+    bool strong = confidence >= _highConfidence && (!_ambientLimit || ambient <= _ambientLimit) &&
+                  photons - photons / kGovernorStepDivisor >= _photonLimit;
+    bool weak = confidence < _lowConfidence;
+
+    _strongFrames = strong ? _strongFrames + 1 : 0;
+    _weakFrames = weak ? _weakFrames + 1 : 0;
+
+    if (_weakFrames >= _upFrames)
+        _direction = 1;
+    else if (_strongFrames >= _downFrames)
+        _direction = -1;
+    else
+        return false;
+
+    _strongFrames = 0;
+    _weakFrames = 0;
+
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////
+// adjust()
+//
+// Apply the step that is due to a config, within the limits.
+//
+//  Parameter   Description
+//  ---------   -----------------------------
+//  config      The config of the device
+//  retval      true if the config changed
+
+bool TMF882XGovernor::adjust(struct tmf882x_mode_app_config &config)
+{
+    uint16_t kiloIterations = config.kilo_iterations;
+    uint16_t step = kiloIterations / kGovernorStepDivisor;
+
+    if (!step)
+        step = 1;
+
+    if (_direction > 0)
+        kiloIterations = kiloIterations < _maxKiloIterations - step ? kiloIterations + step : _maxKiloIterations;
+    else if (_direction < 0)
+        kiloIterations = kiloIterations > _minKiloIterations + step ? kiloIterations - step : _minKiloIterations;
+
+    if (kiloIterations < _minKiloIterations)
+        kiloIterations = _minKiloIterations;
+    else if (kiloIterations > _maxKiloIterations)
+        kiloIterations = _maxKiloIterations;
+
+    uint16_t periodMS = periodFor(kiloIterations);
+
+    if (_direction > 0 && kiloIterations > config.kilo_iterations)
+        _stats.stepsUp++;
+    else if (_direction < 0 && kiloIterations < config.kilo_iterations)
+        _stats.stepsDown++;
+
+    _direction = 0;
+
+    if (kiloIterations == config.kilo_iterations && periodMS == config.report_period_ms)
+        return false;
+
+    config.kilo_iterations = kiloIterations;
+    config.report_period_ms = periodMS;
+
+    _stats.kiloIterations = kiloIterations;
+    _stats.periodMS = periodMS;
+
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////
+// periodFor()
+//
+// Internal, private method. Returns the frame period for a number of
+// iterations - the period limits, scaled over the iteration limits.
+
+uint16_t TMF882XGovernor::periodFor(uint16_t kiloIterations)
+{
+    if (_maxKiloIterations == _minKiloIterations)
+        return _maxPeriodMS;
+
+    return _minPeriodMS + (uint32_t)(_maxPeriodMS - _minPeriodMS) * (kiloIterations - _minKiloIterations) /
+                              (_maxKiloIterations - _minKiloIterations);
+}
@@ -0,0 +1,274 @@
+// qwiic_tmf882x_governor.h
+//
+// This is a library written for SparkFun Qwiic TMF882X boards
+//
+// SparkFun sells these bpards at its website: www.sparkfun.com
+//
+// Do you like this library? Help support SparkFun. Buy a board!
+//
+//  SparkFun Qwiic dToF Imager - TMF8820        https://www.sparkfun.com/products/19036
+//  SparkFun Qwiic Mini dToF Imager - TMF8820   https://www.sparkfun.com/products/19218
+//  SparkFun Qwiic Mini dToF Imager - TMF8821   https://www.sparkfun.com/products/19451
+//  SparkFun Qwiic dToF Imager - TMF8821        https://www.sparkfun.com/products/19037
+//
+// Written by Kirk Benell @ SparkFun Electronics, April 2022
+//
+// This library provides an abstract interface to the underlying TMF882X
+// SDK that is provided by AMS.
+//
+// Repository:
+//     https://github.com/sparkfun/SparkFun_Qwiic_TMF882X_Arduino_Library
+//
+//
+// SparkFun code, firmware, and software is released under the MIT
+// License(http://opensource.org/licenses/MIT).
+//
+// SPDX-License-Identifier: MIT
+//
+//    The MIT License (MIT)
+//
+//    Copyright (c) 2022 SparkFun Electronics
+//    Permission is hereby granted, free of charge, to any person obtaining a
+//    copy of this software and associated documentation files (the "Software"),
+//    to deal in the Software without restriction, including without limitation
+//    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//    and/or sell copies of the Software, and to permit persons to whom the
+//    Software is furnished to do so, subject to the following conditions: The
+//    above copyright notice and this permission notice shall be included in all
+//    copies or substantial portions of the Software. THE SOFTWARE IS PROVIDED
+//    "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+//    NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+//    PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+//    ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+//    CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+// Header for the TMF882X frame rate governor
+
+#pragma once
+
+#include <stdint.h>
+
+#include "qwiic_tmf882x.h"
+
+// The governor trades the iterations of each measurement - and with them the
+// frame period - against the signal the device sees. While the results have a
+// high confidence, the iterations are lowered and the period shortened. When
+// the confidence drops, they are raised again. See QwDevTMF882X::setGovernor().
+//
+// The iterations stay within the limits set. The period follows the iterations,
+// from the shortest period at the fewest iterations, to the longest period at
+// the most iterations.
+//
+// A frame is strong when:
+//
+//    - the mean confidence of its results is at least the high confidence
+//    - the ambient light is at most the ambient limit, if set
+//    - the photon count, scaled down by a step, is at least the photon limit, if set
+//
+// A frame is weak when the mean confidence is below the low confidence, or no
+// target is seen. After a number of strong (or weak) frames in a row, the
+// iterations step down (or up) by a quarter.
+//
+// Each step is a config update of the device - only the fields that change are
+// written, with no read of the config page. The device stops measuring while
+// its config is written, so steps are kept apart by the hold frames.
+
+// Step size - a step changes the iterations by 1/kGovernorStepDivisor
+#define kGovernorStepDivisor 4
+
+// Defaults - the upper limits are the device defaults
+#define kGovernorDefaultMinKiloIterations 128
+#define kGovernorDefaultMaxKiloIterations 537
+#define kGovernorDefaultMinPeriodMS 10
+#define kGovernorDefaultMaxPeriodMS 33
+#define kGovernorDefaultLowConfidence 100
+#define kGovernorDefaultHighConfidence 200
+#define kGovernorDefaultUpFrames 2
+#define kGovernorDefaultDownFrames 8
+
+// Governor stats
+struct TMF882XGovernorStats
+{
+    uint32_t frames;         // frames seen
+    uint16_t stepsUp;        // steps to more iterations
+    uint16_t stepsDown;      // steps to fewer iterations
+    uint16_t kiloIterations; // iterations set by the last step - 0 if none
+    uint16_t periodMS;       // period set by the last step
+    uint8_t confidence;      // mean confidence of the last frame
+};
+
+//////////////////////////////////////////////////////////////////////////////
+// TMF882XGovernor
+//
+// Adjusts the iterations and period of a device to the signal it sees. Set the
+// limits, then pass the governor to the device with setGovernor().
+
+class TMF882XGovernor
+{
+  public:
+    TMF882XGovernor(void)
+        : _minKiloIterations{kGovernorDefaultMinKiloIterations}, _maxKiloIterations{kGovernorDefaultMaxKiloIterations},
+          _minPeriodMS{kGovernorDefaultMinPeriodMS}, _maxPeriodMS{kGovernorDefaultMaxPeriodMS},
+          _lowConfidence{kGovernorDefaultLowConfidence}, _highConfidence{kGovernorDefaultHighConfidence},
+          _ambientLimit{0}, _photonLimit{0}, _upFrames{kGovernorDefaultUpFrames},
+          _downFrames{kGovernorDefaultDownFrames}, _direction{0}, _strongFrames{0}, _weakFrames{0},
+          _confidenceTotal{0}, _nResults{0}, _ambient{0}, _photonTotal{0}, _nCaptures{0}, _stats{}
+    {
+    }
+
+    ///////////////////////////////////////////////////////////////////////
+    // setIterationLimits()
+    //
+    // Set the range of the iterations of a measurement
+    //
+    //  Parameter   Description
+    //  ---------   -----------------------------
+    //  minKilo     The fewest iterations, in thousands - at least 1
+    //  maxKilo     The most iterations, in thousands
+    //  retval      true on success, false on error
+
+    bool setIterationLimits(uint16_t minKilo, uint16_t maxKilo);
+
+    ///////////////////////////////////////////////////////////////////////
+    // setPeriodLimits()
+    //
+    // Set the range of the frame period
+    //
+    //  Parameter   Description
+    //  ---------   -----------------------------
+    //  minMS       The period at the fewest iterations, in milli-seconds - at least 1
+    //  maxMS       The period at the most iterations, in milli-seconds
+    //  retval      true on success, false on error
+
+    bool setPeriodLimits(uint16_t minMS, uint16_t maxMS);
+
+    ///////////////////////////////////////////////////////////////////////
+    // setConfidence()
+    //
+    // Set the mean confidence below which a frame is weak, and at or above
+    // which it is strong
+    //
+    //  Parameter   Description
+    //  ---------   -----------------------------
+    //  low         The low confidence
+    //  high        The high confidence - more than low
+    //  retval      true on success, false on error
+
+    bool setConfidence(uint8_t low, uint8_t high);
+
+    ///////////////////////////////////////////////////////////////////////
+    // setAmbientLimit()
+    //
+    // Set the most ambient light a strong frame can have
+    //
+    //  Parameter   Description
+    //  ---------   -----------------------------
+    //  ambient     The ambient light value - 0 for no limit
+
+    void setAmbientLimit(uint32_t ambient)
+    {
+        _ambientLimit = ambient;
+    }
+
+    ///////////////////////////////////////////////////////////////////////
+    // setPhotonLimit()
+    //
+    // Set the fewest photons a strong frame can have, after a step down
+    //
+    //  Parameter   Description
+    //  ---------   -----------------------------
+    //  photons     The photon count - 0 for no limit
+
+    void setPhotonLimit(uint32_t photons)
+    {
+        _photonLimit = photons;
+    }
+
+    ///////////////////////////////////////////////////////////////////////
+    // setHoldFrames()
+    //
+    // Set the number of weak or strong frames in a row before a step
+    //
+    //  Parameter   Description
+    //  ---------   -----------------------------
+    //  upFrames    Weak frames before a step up - at least 1
+    //  downFrames  Strong frames before a step down - at least 1
+    //  retval      true on success, false on error
+
+    bool setHoldFrames(uint8_t upFrames, uint8_t downFrames);
+
+    ///////////////////////////////////////////////////////////////////////
+    // getStats()
+    //
+    // Returns the stats of the governor
+    //
+    //  Parameter   Description
+    //  ---------   -----------------------------
+    //  stats       Struct to hold the stats
+
+    void getStats(TMF882XGovernorStats &stats)
+    {
+        stats = _stats;
+    }
+
+    ///////////////////////////////////////////////////////////////////////
+    // reset()
+    //
+    // Reset the frame counts - at the start of measurements, or when the
+    // mode of the device changes
+
+    void reset(void);
+
+    ///////////////////////////////////////////////////////////////////////
+    // update()
+    //
+    // Add a set of results to the frame. Called by the device.
+    //
+    //  Parameter   Description
+    //  ---------   -----------------------------
+    //  results     The results
+    //  frameEnd    true if the results are the last capture of the frame
+    //  retval      true if a step is due - see adjust()
+
+    bool update(const struct tmf882x_msg_meas_results *results, bool frameEnd);
+
+    ///////////////////////////////////////////////////////////////////////
+    // adjust()
+    //
+    // Apply the step that is due to a config. Called by the device. A config
+    // outside the limits is moved inside them.
+    //
+    //  Parameter   Description
+    //  ---------   -----------------------------
+    //  config      The config of the device
+    //  retval      true if the config changed
+
+    bool adjust(struct tmf882x_mode_app_config &config);
+
+  private:
+    uint16_t periodFor(uint16_t kiloIterations);
+
+    uint16_t _minKiloIterations;
+    uint16_t _maxKiloIterations;
+    uint16_t _minPeriodMS;
+    uint16_t _maxPeriodMS;
+    uint8_t _lowConfidence;
+    uint8_t _highConfidence;
+    uint32_t _ambientLimit;
+    uint32_t _photonLimit;
+    uint8_t _upFrames;
+    uint8_t _downFrames;
+
+    int8_t _direction; // step due - 1 up, -1 down, 0 none
+    uint8_t _strongFrames;
+    uint8_t _weakFrames;
+
+    // the frame being added up
+    uint32_t _confidenceTotal;
+    uint16_t _nResults;
+    uint32_t _ambient;     // most ambient light of the captures
+    uint32_t _photonTotal;
+    uint8_t _nCaptures;
+
+    TMF882XGovernorStats _stats;
+};
@@ -0,0 +1,882 @@
+// qwiic_tmf882x_sim.cpp
+//
+// This is a library written for SparkFun Qwiic TMF882X boards
+//
+// SparkFun sells these bpards at its website: www.sparkfun.com
+//
+// Do you like this library? Help support SparkFun. Buy a board!
+//
+//  SparkFun Qwiic dToF Imager - TMF8820        https://www.sparkfun.com/products/19036
+//  SparkFun Qwiic Mini dToF Imager - TMF8820   https://www.sparkfun.com/products/19218
+//  SparkFun Qwiic Mini dToF Imager - TMF8821   https://www.sparkfun.com/products/19451
+//  SparkFun Qwiic dToF Imager - TMF8821        https://www.sparkfun.com/products/19037
+//
+// Written by Kirk Benell @ SparkFun Electronics, April 2022
+//
+// This library provides an abstract interface to the underlying TMF882X
+// SDK that is provided by AMS.
+//
+// Repository:
+//     https://github.com/sparkfun/SparkFun_Qwiic_TMF882X_Arduino_Library
+//
+//
+// SparkFun code, firmware, and software is released under the MIT
+// License(http://opensource.org/licenses/MIT).
+//
+// SPDX-License-Identifier: MIT
+//
+//    The MIT License (MIT)
+//
+//    Copyright (c) 2022 SparkFun Electronics
+//    Permission is hereby granted, free of charge, to any person obtaining a
+//    copy of this software and associated documentation files (the "Software"),
+//    to deal in the Software without restriction, including without limitation
+//    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//    and/or sell copies of the Software, and to permit persons to whom the
+//    Software is furnished to do so, subject to the following conditions: The
+//    above copyright notice and this permission notice shall be included in all
+//    copies or substantial portions of the Software. THE SOFTWARE IS PROVIDED
+//    "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+//    NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+//    PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+//    ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+//    CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+// Register level simulator of the TMF882X device
+
+#if !defined(ARDUINO)
+
+#include <string.h>
+
+#include "qwiic_tmf882x_sim.h"
+#include "sfe_arduino.h"
+#include "tmf882x_interface.h"
+#include "inc/tmf882x_mode_app_protocol.h"
+#include "inc/tmf882x_mode_bl.h"
+
+// Register window used for messages - config pages, results and histograms
+#define kSimWindowStart TMF8X2X_COM_CONFIG_RESULT
+#define kSimPageStart (TMF8X2X_COM_CONFIG_RESULT + TMF8X2X_COM_HEADER_SIZE)
+#define kSimPageIdx(reg) ((reg)-kSimPageStart)
+
+// Max data in one histogram packet - window less the header and sub-packet header
+#define kSimHistPacketData (TMF8X2X_COM_MAX_PAYLOAD - TMF8X2X_COM_OPTIONAL_SUBPACKET_HEADER_SIZE)
+
+// Size of the result record - result header and the result list
+#define kSimResultSize (TMF8X2X_COM_RES_CONFIDENCE_0 - kSimPageStart + TMF8X2X_COM_MAX_MEASUREMENT_RESULTS * 3)
+
+// CPU status register bits
+#define kSimStatPON 0x01
+#define kSimStatReady 0x40
+#define kSimStatBootMatrix 0x30
+
+// Interrupt flags - see tmf882x_mode_app.c
+#define kSimIrqResult 0x02
+#define kSimIrqHistogram 0x08
+#define kSimIrqCmdDone 0x20
+
+// Info record of the simulated app - the major version must match the SDK
+static const uint8_t kSimAppInfo[] = {TMF882X_MODE_APP, 0, 0, 0};
+static const uint8_t kSimBootloaderInfo[] = {TMF882X_MODE_BOOTLOADER, 0, 0, 0};
+
+// The TOF clock runs at 5 MHz
+#define kSimSysTicksPerUS 5
+
+namespace sfe_TMF882X {
+
+//////////////////////////////////////////////////////////////////////////////////////////////////
+// Constructor
+
+QwSimTMF882X::QwSimTMF882X(uint8_t address) : _address{address}, _framePacing{true}
+{
+    uint32_t i;
+
+    // default targets - one per zone, in a simple ramp
+    memset(_distanceMM, 0, sizeof(_distanceMM));
+    memset(_confidence, 0, sizeof(_confidence));
+
+    for (i = 0; i < 9; i++)
+    {
+        setTarget(i + 1, 0, 500 + i * 100, 200);
+        setTarget(i + 1, 1, 550 + i * 100, 180);
+    }
+
+    // common config page - device reset values
+    memset(_commonPage, 0, sizeof(_commonPage));
+    _commonPage[kSimPageIdx(TMF8X2X_COM_PERIOD_MS_LSB)] = TMF8X2X_COM_PERIOD_MS_LSB__period_7_0__RESET;
+    _commonPage[kSimPageIdx(TMF8X2X_COM_PERIOD_MS_MSB)] = TMF8X2X_COM_PERIOD_MS_MSB__period_15_8__RESET;
+    _commonPage[kSimPageIdx(TMF8X2X_COM_KILO_ITERATIONS_LSB)] = TMF8X2X_COM_KILO_ITERATIONS_LSB__iterations_7_0__RESET;
+    _commonPage[kSimPageIdx(TMF8X2X_COM_KILO_ITERATIONS_MSB)] = TMF8X2X_COM_KILO_ITERATIONS_MSB__iterations_15_8__RESET;
+    _commonPage[kSimPageIdx(TMF8X2X_COM_INT_THRESHOLD_HIGH_LSB)] = 0xFF;
+    _commonPage[kSimPageIdx(TMF8X2X_COM_INT_THRESHOLD_HIGH_MSB)] = 0xFF;
+    _commonPage[kSimPageIdx(TMF8X2X_COM_CONFIDENCE_THRESHOLD)] = 6;
+    _commonPage[kSimPageIdx(TMF8X2X_COM_SPAD_MAP_ID)] = TMF8X2X_COM_SPAD_MAP_ID__spad_map_id__RESET;
+    _commonPage[kSimPageIdx(TMF8X2X_COM_ALG_SETTING_0)] = TMF8X2X_COM_ALG_SETTING_0__distances;
+    _commonPage[kSimPageIdx(TMF8X2X_COM_I2C_SLAVE_ADDRESS)] = address << 1;
+
+    // spad pages - empty masks of the max size
+    memset(_spadPages, 0, sizeof(_spadPages));
+    for (i = 0; i < 2; i++)
+    {
+        _spadPages[i][kSimPageIdx(TMF8X2X_COM_SPAD_X_SIZE)] = TMF8X2X_COM_MAX_SPAD_XSIZE;
+        _spadPages[i][kSimPageIdx(TMF8X2X_COM_SPAD_Y_SIZE)] = TMF8X2X_COM_MAX_SPAD_YSIZE;
+    }
+
+    // uncalibrated
+    memset(_calibPages, 0, sizeof(_calibPages));
+
+    reset();
+
+    setSerialNumber(0x12345678);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////
+// reset()
+//
+// Power on reset. The device starts in the bootloader, with no firmware loaded.
+// Config pages are kept - as if stored on the host.
+
+void QwSimTMF882X::reset(void)
+{
+    uint8_t uid[4];
+
+    // keep the serial number over a reset
+    memcpy(uid, &_regs[TMF8X2X_COM_SERIAL_NUMBER_0], sizeof(uid));
+    memset(_regs, 0, sizeof(_regs));
+    memcpy(&_regs[TMF8X2X_COM_SERIAL_NUMBER_0], uid, sizeof(uid));
+
+    _regs[TMF882X_ID] = 0x08;
+    _regs[TMF882X_ID + 1] = 0x01;
+
+    _fwBytes = 0;
+    _nFrames = 0;
+    _nDropped = 0;
+    _nTransactions = 0;
+    _nBytes = 0;
+
+    bootBootloader();
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////
+// setTarget()
+//
+// Set the target reported by a zone
+
+bool QwSimTMF882X::setTarget(uint8_t channel, uint8_t subCapture, uint16_t distanceMM, uint8_t confidence,
+                             uint8_t target)
+{
+    if (channel < 1 || channel > 9 || subCapture > 1 || target > 1)
+        return false;
+
+    uint8_t idx = target * 18 + subCapture * 9 + channel - 1;
+
+    _distanceMM[idx] = confidence ? distanceMM : 0;
+    _confidence[idx] = confidence;
+
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////
+// setSerialNumber()
+
+void QwSimTMF882X::setSerialNumber(uint32_t serialNumber)
+{
+    _regs[TMF8X2X_COM_SERIAL_NUMBER_0] = serialNumber & 0xFF;
+    _regs[TMF8X2X_COM_SERIAL_NUMBER_0 + 1] = (serialNumber >> 8) & 0xFF;
+    _regs[TMF8X2X_COM_SERIAL_NUMBER_0 + 2] = (serialNumber >> 16) & 0xFF;
+    _regs[TMF8X2X_COM_SERIAL_NUMBER_0 + 3] = (serialNumber >> 24) & 0xFF;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////
+// interruptAsserted()
+//
+// The INT pin is asserted when an enabled interrupt is pending
+
+bool QwSimTMF882X::interruptAsserted(void)
+{
+    updateMeasurements();
+
+    return (_regs[TMF882X_INT_STAT] & _regs[TMF882X_INT_EN]) != 0;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////
+// bootBootloader()
+//
+// CPU reset into the bootloader
+
+void QwSimTMF882X::bootBootloader(void)
+{
+    _isApp = false;
+    _measuring = false;
+    _windowUnread = false;
+    _histActive = false;
+    _histPending = 0;
+    _resultPending = false;
+    _ramAddr = 0;
+
+    memset(_regs, 0, TMF8X2X_COM_SERIAL_NUMBER_0);
+    memcpy(_regs, kSimBootloaderInfo, sizeof(kSimBootloaderInfo));
+
+    _regs[TMF882X_STAT] = kSimStatPON | kSimStatReady;
+    _regs[TMF882X_INT_STAT] = 0;
+    _regs[TMF882X_INT_EN] = 0;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////
+// bootApp()
+//
+// Start the application - after a RAM or ROM remap
+
+void QwSimTMF882X::bootApp(void)
+{
+    bootBootloader();
+
+    _isApp = true;
+    _calibIndex = -1;
+    _resultNum = 0;
+
+    memcpy(_regs, kSimAppInfo, sizeof(kSimAppInfo));
+    _regs[TMF8X2X_COM_CMD_STAT] = TMF8X2X_COM_CMD_STAT__cmd_stat__STAT_OK;
+    _regs[TMF8X2X_COM_TID] = 0x01;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////
+// writeCPUStatus()
+//
+// Handle a write to the CPU status register - standby, wakeup and the boot matrix
+
+void QwSimTMF882X::writeCPUStatus(uint8_t value)
+{
+    uint8_t current = _regs[TMF882X_STAT];
+
+    _regs[TMF882X_STAT] = (current & ~(kSimStatBootMatrix | kSimStatPON)) | (value & (kSimStatBootMatrix | kSimStatPON));
+
+    // going to standby?
+    if (!(value & kSimStatPON))
+    {
+        _regs[TMF882X_STAT] &= ~kSimStatReady;
+        _measuring = false;
+        return;
+    }
+
+    // waking up?
+    if (!(current & kSimStatPON))
+    {
+        // boot matrix of 1 selects the bootloader on wakeup
+        if ((value & kSimStatBootMatrix) == 0x10)
+            bootBootloader();
+
+        _regs[TMF882X_STAT] = (_regs[TMF882X_STAT] & ~kSimStatBootMatrix) | kSimStatPON | kSimStatReady;
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////
+// ping()
+
+bool QwSimTMF882X::ping(uint8_t address)
+{
+    return address == _address;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////
+// writeRegisterByte()
+
+bool QwSimTMF882X::writeRegisterByte(uint8_t address, uint8_t offset, uint8_t data)
+{
+    return writeRegisterRegion(address, offset, &data, 1) == 0;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////
+// writeRegisterRegion()
+//
+// A write transaction to the device. Writes to the command and control registers
+// are acted on, everything else is stored in the register map.
+
+int QwSimTMF882X::writeRegisterRegion(uint8_t address, uint8_t offset, uint8_t *data, uint16_t length)
+{
+    if (address != _address || !data || !length || offset + length > sizeof(_regs))
+        return -1;
+
+    _nTransactions++;
+    _nBytes += length + 1;
+
+    updateMeasurements();
+
+    // Command register - bootloader commands are the full message, app commands one byte
+    if (offset == TMF8X2X_COM_CMD_STAT)
+    {
+        if (_isApp)
+            appCommand(data[0]);
+        else
+            bootloaderCommand(data, length);
+        return 0;
+    }
+
+    switch (offset)
+    {
+    case TMF882X_STAT:
+        writeCPUStatus(data[0]);
+        break;
+
+    case TMF882X_INT_STAT: // write 1 to clear
+        _regs[TMF882X_INT_STAT] &= ~data[0];
+        break;
+
+    case 0xF0: // CPU reset
+        if (data[0] & 0x80)
+        {
+            if ((_regs[TMF882X_STAT] & kSimStatBootMatrix) == 0x10 || !_fwBytes)
+                bootBootloader();
+            else
+                bootApp();
+        }
+        break;
+
+    default:
+        memcpy(&_regs[offset], data, length);
+        break;
+    }
+
+    return 0;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////
+// readRegisterRegion()
+//
+// A write-then-read transaction. A read of the message window marks the published
+// message as read, which lets the device move on to the next one.
+
+int QwSimTMF882X::readRegisterRegion(uint8_t addr, uint8_t reg, uint8_t *data, uint16_t numBytes)
+{
+    if (addr != _address || !data || !numBytes || reg + numBytes > sizeof(_regs))
+        return -1;
+
+    _nTransactions++;
+    _nBytes += numBytes + 1;
+
+    updateMeasurements();
+
+    memcpy(data, &_regs[reg], numBytes);
+
+    if (reg == kSimWindowStart && numBytes >= TMF8X2X_COM_HEADER_SIZE && _windowUnread)
+    {
+        _windowUnread = false;
+        publishNext();
+    }
+
+    return 0;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////
+// bootloaderCommand()
+//
+// Process a bootloader command - command, size, data and checksum
+
+void QwSimTMF882X::bootloaderCommand(const uint8_t *data, uint16_t length)
+{
+    uint8_t sum = 0;
+    uint16_t i;
+
+    if (length < BL_CALC_CMD_SIZE(0) || length != BL_CALC_CMD_SIZE(data[1]))
+    {
+        bootloaderResponse(BL_STAT_ERR_SIZE, nullptr, 0);
+        return;
+    }
+
+    // the checksum is the 1's complement of the sum of the command, size and data
+    for (i = 0; i < length - 1; i++)
+        sum += data[i];
+
+    if ((uint8_t)~sum != data[length - 1])
+    {
+        bootloaderResponse(BL_STAT_ERR_CSUM, nullptr, 0);
+        return;
+    }
+
+    uint8_t readData[BL_MAX_DATA_SZ];
+
+    switch (data[0])
+    {
+    case BL_CMD_RAM_ADDR:
+        _ramAddr = data[2] | (data[3] << 8);
+        bootloaderResponse(BL_STAT_READY, nullptr, 0);
+        break;
+
+    case BL_CMD_WR_RAM:
+        _ramAddr += data[1];
+        _fwBytes += data[1];
+        bootloaderResponse(BL_STAT_READY, nullptr, 0);
+        break;
+
+    case BL_CMD_RD_RAM: // RAM contents are not kept
+        if (data[2] > sizeof(readData))
+        {
+            bootloaderResponse(BL_STAT_ERR_RANGE, nullptr, 0);
+            break;
+        }
+        memset(readData, 0, data[2]);
+        _ramAddr += data[2];
+        bootloaderResponse(BL_STAT_READY, readData, data[2]);
+        break;
+
+    case BL_CMD_UPLOAD_INIT:
+        bootloaderResponse(BL_STAT_READY, nullptr, 0);
+        break;
+
+    case BL_CMD_RAMREMAP_RST: // start the downloaded firmware
+        if (_fwBytes)
+            bootApp();
+        else
+            bootloaderResponse(BL_STAT_ERR_APP, nullptr, 0);
+        break;
+
+    case BL_CMD_ROMREMAP_RST: // start the application in ROM
+        bootApp();
+        break;
+
+    case BL_CMD_RST:
+        bootBootloader();
+        break;
+
+    default:
+        bootloaderResponse(BL_STAT_ERR_RES, nullptr, 0);
+        break;
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////
+// bootloaderResponse()
+//
+// Post a bootloader response - status, size, data and checksum
+
+void QwSimTMF882X::bootloaderResponse(uint8_t status, const uint8_t *data, uint8_t size)
+{
+    uint8_t *rsp = &_regs[BL_REG_CMD_STATUS];
+    uint8_t sum = status + size;
+
+    rsp[0] = status;
+    rsp[1] = size;
+
+    for (uint8_t i = 0; i < size; i++)
+    {
+        rsp[2 + i] = data[i];
+        sum += data[i];
+    }
+    rsp[2 + size] = ~sum;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////
+// appCommand()
+//
+// Process an app mode command. Commands complete right away.
+
+void QwSimTMF882X::appCommand(uint8_t cmd)
+{
+    uint8_t status = TMF8X2X_COM_CMD_STAT__cmd_stat__STAT_OK;
+
+    switch (cmd)
+    {
+    case TMF8X2X_COM_CMD_STAT__cmd_stat__CMD_MEASURE:
+        if (!_measuring)
+        {
+            _measuring = true;
+            _windowUnread = false;
+            _nextFrameUS = sfe_micros() + (_commonPage[kSimPageIdx(TMF8X2X_COM_PERIOD_MS_LSB)] |
+                                           (_commonPage[kSimPageIdx(TMF8X2X_COM_PERIOD_MS_MSB)] << 8)) * 1000;
+        }
+        status = TMF8X2X_COM_CMD_STAT__cmd_stat__STAT_ACCEPTED;
+        break;
+
+    case TMF8X2X_COM_CMD_STAT__cmd_stat__CMD_STOP:
+        _measuring = false;
+        _windowUnread = false;
+        _histActive = false;
+        _histPending = 0;
+        _resultPending = false;
+        break;
+
+    case TMF8X2X_COM_CMD_STAT__cmd_stat__CMD_LOAD_CONFIG_PAGE_COMMON:
+    case TMF8X2X_COM_CMD_STAT__cmd_stat__CMD_LOAD_CONFIG_PAGE_SPAD_1:
+    case TMF8X2X_COM_CMD_STAT__cmd_stat__CMD_LOAD_CONFIG_PAGE_SPAD_2:
+    case TMF8X2X_COM_CMD_STAT__cmd_stat__CMD_LOAD_CONFIG_PAGE_FACTORY_CALIB:
+        // the CID of the page is the same as the load command
+        loadConfigPage(cmd);
+        break;
+
+    case TMF8X2X_COM_CMD_STAT__cmd_stat__CMD_WRITE_CONFIG_PAGE:
+        if (!writeConfigPage())
+            status = TMF8X2X_COM_CMD_STAT__cmd_stat__STAT_ERR_UNKNOWN_CID;
+        break;
+
+    case TMF8X2X_COM_CMD_STAT__cmd_stat__CMD_RESET_FACTORY_CALIBRATION:
+        _calibIndex = -1;
+        break;
+
+    case TMF8X2X_COM_CMD_STAT__cmd_stat__CMD_FACTORY_CALIBRATION:
+        factoryCalibration();
+        break;
+
+    case TMF8X2X_COM_CMD_STAT__cmd_stat__CMD_SWITCH_TMF8828_MODE:
+        _regs[TMF8X2X_COM_MODE] |= TMF8X2X_COM_MODE__mode__MASK;
+        break;
+
+    case TMF8X2X_COM_CMD_STAT__cmd_stat__CMD_SWITCH_TMF8821_MODE:
+        _regs[TMF8X2X_COM_MODE] &= ~TMF8X2X_COM_MODE__mode__MASK;
+        break;
+
+    case TMF8X2X_COM_CMD_STAT__cmd_stat__CMD_I2C_SLAVE_ADDRESS:
+        // move to the address in the common config page (7 bit address, shifted)
+        _address = _commonPage[kSimPageIdx(TMF8X2X_COM_I2C_SLAVE_ADDRESS)] >> 1;
+        break;
+
+    case TMF8X2X_COM_CMD_STAT__cmd_stat__CMD_CLEAR_STATUS:
+    case TMF8X2X_COM_CMD_STAT__cmd_stat__CMD_GPIO:
+    case TMF8X2X_COM_CMD_STAT__cmd_stat__CMD_BREAKPOINT_GO:
+        break;
+
+    case TMF8X2X_COM_CMD_STAT__cmd_stat__CMD_RESET:
+        bootApp();
+        break;
+
+    default:
+        status = TMF8X2X_COM_CMD_STAT__cmd_stat__STAT_ERR_UNKNOWN_CMD;
+        break;
+    }
+
+    _regs[TMF8X2X_COM_CMD_STAT] = status;
+    _regs[TMF882X_INT_STAT] |= kSimIrqCmdDone;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////
+// loadConfigPage()
+//
+// Load a config page into the message window
+
+void QwSimTMF882X::loadConfigPage(uint8_t cid)
+{
+    const uint8_t *page;
+    bool is8x8 = _regs[TMF8X2X_COM_MODE] & TMF8X2X_COM_MODE__mode__MASK;
+
+    switch (cid)
+    {
+    case TMF8X2X_COM_CONFIG_RESULT__cid_rid__COMMON_CID:
+        page = _commonPage;
+        break;
+    case TMF8X2X_COM_CONFIG_RESULT__cid_rid__SPAD_1_CID:
+        page = _spadPages[0];
+        break;
+    case TMF8X2X_COM_CONFIG_RESULT__cid_rid__SPAD_2_CID:
+        page = _spadPages[1];
+        break;
+    default: // factory calibration - in 8x8 mode, each load moves to the next page
+        _calibIndex = is8x8 ? (_calibIndex + 1) % kSimNumCalibPages : 0;
+        page = _calibPages[_calibIndex];
+        break;
+    }
+
+    _regs[TMF8X2X_COM_CONFIG_RESULT] = cid;
+    _regs[TMF8X2X_COM_SIZE_LSB] = kSimConfigPageSize & 0xFF;
+    _regs[TMF8X2X_COM_SIZE_MSB] = kSimConfigPageSize >> 8;
+    memcpy(&_regs[kSimPageStart], page, kSimConfigPageSize);
+
+    nextTID();
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////
+// writeConfigPage()
+//
+// Write the loaded config page from the message window. Returns false if no
+// config page is loaded.
+
+bool QwSimTMF882X::writeConfigPage(void)
+{
+    uint8_t *page;
+
+    switch (_regs[TMF8X2X_COM_CONFIG_RESULT])
+    {
+    case TMF8X2X_COM_CONFIG_RESULT__cid_rid__COMMON_CID:
+        page = _commonPage;
+        break;
+    case TMF8X2X_COM_CONFIG_RESULT__cid_rid__SPAD_1_CID:
+        page = _spadPages[0];
+        break;
+    case TMF8X2X_COM_CONFIG_RESULT__cid_rid__SPAD_2_CID:
+        page = _spadPages[1];
+        break;
+    case TMF8X2X_COM_CONFIG_RESULT__cid_rid__FACTORY_CALIBRATION_CID:
+        page = _calibPages[_calibIndex < 0 ? 0 : _calibIndex];
+        break;
+    default:
+        return false;
+    }
+
+    memcpy(page, &_regs[kSimPageStart], kSimConfigPageSize);
+
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////
+// factoryCalibration()
+//
+// Run a factory calibration - fills the next calibration page with data derived
+// from the device serial number.
+
+void QwSimTMF882X::factoryCalibration(void)
+{
+    bool is8x8 = _regs[TMF8X2X_COM_MODE] & TMF8X2X_COM_MODE__mode__MASK;
+    int8_t idx = is8x8 ? (_calibIndex + 1) % kSimNumCalibPages : 0;
+
+    if (is8x8)
+        _calibIndex = idx;
+
+    for (uint16_t i = 0; i < kSimConfigPageSize; i++)
+        _calibPages[idx][i] = _regs[TMF8X2X_COM_SERIAL_NUMBER_0 + (i & 0x3)] ^ (uint8_t)(i + idx);
+
+    // the next load starts with the first page
+    _calibIndex = -1;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////
+// numSubCaptures()
+//
+// Number of sub captures for the current SPAD map - time-multiplexed maps have two
+
+uint8_t QwSimTMF882X::numSubCaptures(void)
+{
+    switch (_commonPage[kSimPageIdx(TMF8X2X_COM_SPAD_MAP_ID)])
+    {
+    case TMF8X2X_COM_SPAD_MAP_ID__spad_map_id__map_no_4:
+    case TMF8X2X_COM_SPAD_MAP_ID__spad_map_id__map_no_5:
+    case TMF8X2X_COM_SPAD_MAP_ID__spad_map_id__map_no_7:
+    case TMF8X2X_COM_SPAD_MAP_ID__spad_map_id__map_no_10:
+    case TMF8X2X_COM_SPAD_MAP_ID__spad_map_id__map_no_13:
+    case TMF8X2X_COM_SPAD_MAP_ID__spad_map_id__user_defined_2:
+        return 2;
+    default:
+        return 1;
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////
+// nextTID()
+//
+// Each new message in the window gets a new transaction ID
+
+void QwSimTMF882X::nextTID(void)
+{
+    _regs[TMF8X2X_COM_TID]++;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////
+// updateMeasurements()
+//
+// Called on each bus transaction. If measuring, and a result is due, start the
+// next frame. A frame isn't started until the host has read the last message -
+// any report periods missed while waiting are counted as dropped frames.
+
+void QwSimTMF882X::updateMeasurements(void)
+{
+    if (!_measuring || _windowUnread || _histActive || _histPending || _resultPending)
+        return;
+
+    uint32_t now = sfe_micros();
+
+    if (!_framePacing)
+    {
+        startFrame(now);
+        return;
+    }
+
+    if ((int32_t)(now - _nextFrameUS) < 0)
+        return;
+
+    uint32_t periodUS = (_commonPage[kSimPageIdx(TMF8X2X_COM_PERIOD_MS_LSB)] |
+                         (_commonPage[kSimPageIdx(TMF8X2X_COM_PERIOD_MS_MSB)] << 8)) * 1000;
+
+    // missed report periods
+    while (periodUS && (int32_t)(now - (_nextFrameUS + periodUS)) >= 0)
+    {
+        _nextFrameUS += periodUS;
+        _resultNum++;
+        _nDropped++;
+    }
+
+    startFrame(_nextFrameUS);
+    _nextFrameUS += periodUS ? periodUS : 1000;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////
+// startFrame()
+//
+// Start publishing a frame - any histograms, followed by the result
+
+void QwSimTMF882X::startFrame(uint32_t frameUS)
+{
+    uint8_t histDump = _commonPage[kSimPageIdx(TMF8X2X_COM_HIST_DUMP)];
+
+    _frameUS = frameUS;
+    _nFrames++;
+
+    _histRID = 0;
+    if (histDump & TMF8X2X_COM_HIST_DUMP__histogram__raw_24_bit_histogram)
+        _histRID = TMF8X2X_COM_RID_RAW_HISTOGRAM_24_BITS;
+    else if (histDump & TMF8X2X_COM_HIST_DUMP__histogram__electrical_calibration_24_bit_histogram)
+        _histRID = TMF8X2X_COM_RID_ELECTRICAL_CALIBRATION_24_BITS;
+
+    _histPending = _histRID ? numSubCaptures() : 0;
+    _resultPending = true;
+
+    publishNext();
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////
+// publishNext()
+//
+// Publish the next message of the frame, once the last one was read
+
+void QwSimTMF882X::publishNext(void)
+{
+    if (_windowUnread)
+        return;
+
+    if (_histActive)
+        publishHistogramPacket();
+    else if (_histPending)
+    {
+        buildHistogram(numSubCaptures() - _histPending);
+        _histPending--;
+        publishHistogramPacket();
+    }
+    else if (_resultPending)
+        publishResult();
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////
+// publishResult()
+//
+// Publish a measurement result page
+
+void QwSimTMF882X::publishResult(void)
+{
+    uint8_t *page = &_regs[kSimPageStart];
+    uint8_t nSub = numSubCaptures();
+    uint8_t nValid = 0;
+    uint32_t sysTicks = (_frameUS * kSimSysTicksPerUS) | 0x01; // LSB set - valid
+    uint32_t photons = 0;
+
+    _resultPending = false;
+
+    memset(page, 0, kSimResultSize);
+
+    // result list - confidence, distance LSB, distance MSB
+    uint8_t *result = &_regs[TMF8X2X_COM_RES_CONFIDENCE_0];
+
+    for (uint8_t i = 0; i < TMF8X2X_COM_MAX_MEASUREMENT_RESULTS; i++, result += 3)
+    {
+        if (((i / 9) % 2) >= nSub || !_confidence[i])
+            continue;
+
+        result[0] = _confidence[i];
+        result[1] = _distanceMM[i] & 0xFF;
+        result[2] = _distanceMM[i] >> 8;
+        photons += _confidence[i] * 10;
+        nValid++;
+    }
+
+    page[kSimPageIdx(TMF8X2X_COM_RESULT_NUMBER)] = _resultNum++;
+    page[kSimPageIdx(TMF8X2X_COM_TEMPERATURE)] = 25;
+    page[kSimPageIdx(TMF8X2X_COM_NUMBER_VALID_RESULTS)] = nValid;
+
+    for (uint8_t i = 0; i < 4; i++)
+    {
+        page[kSimPageIdx(TMF8X2X_COM_AMBIENT_LIGHT_0) + i] = (100 >> (8 * i)) & 0xFF;
+        page[kSimPageIdx(TMF8X2X_COM_PHOTON_COUNT_0) + i] = (photons >> (8 * i)) & 0xFF;
+        page[kSimPageIdx(TMF8X2X_COM_REFERENCE_COUNT_0) + i] = (5000 >> (8 * i)) & 0xFF;
+        page[kSimPageIdx(TMF8X2X_COM_SYS_TICK_0) + i] = (sysTicks >> (8 * i)) & 0xFF;
+    }
+
+    _regs[TMF8X2X_COM_CONFIG_RESULT] = TMF8X2X_COM_CONFIG_RESULT__cid_rid__MEASUREMENT_RESULT;
+    _regs[TMF8X2X_COM_SIZE_LSB] = kSimResultSize & 0xFF;
+    _regs[TMF8X2X_COM_SIZE_MSB] = kSimResultSize >> 8;
+    nextTID();
+
+    _windowUnread = true;
+    _regs[TMF882X_INT_STAT] |= kSimIrqResult;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////
+// buildHistogram()
+//
+// Build the histogram for a sub capture - a flat ambient level, with a peak for the
+// target of each TDC. The device shifts out each byte of the bins, for each TDC, as
+// a block - see decode_histogram_msg() in tmf882x_mode_app.c
+
+void QwSimTMF882X::buildHistogram(uint8_t subCapture)
+{
+    const uint16_t nBins = 256;
+    const uint8_t nTDC = 5;
+
+    memset(_histogram, 0, sizeof(_histogram));
+
+    for (uint8_t tdc = 0; tdc < nTDC; tdc++)
+    {
+        // TDC n has channels 2n+1 and 2n+2 - use the target of the first
+        uint8_t idx = subCapture * 9 + tdc * 2;
+        uint16_t peakBin = _distanceMM[idx] / 30;
+
+        for (uint16_t bin = 0; bin < nBins; bin++)
+        {
+            uint32_t value = 100;
+            uint16_t delta = bin > peakBin ? bin - peakBin : peakBin - bin;
+
+            if (_confidence[idx] && delta < 4)
+                value += (uint32_t)_confidence[idx] * 100 >> delta;
+
+            for (uint8_t byte = 0; byte < 3; byte++)
+                _histogram[(byte * nBins * nTDC) + (nBins * tdc) + bin] = (value >> (8 * byte)) & 0xFF;
+        }
+    }
+
+    _histSubCapture = subCapture;
+    _histPacket = 0;
+    _histOffset = 0;
+    _histActive = true;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////
+// publishHistogramPacket()
+//
+// Publish the next packet of a multi-packet histogram message. Each packet has a
+// sub-packet header - packet number, payload size and config id (sub capture).
+
+void QwSimTMF882X::publishHistogramPacket(void)
+{
+    uint16_t remaining = kSimHistogramSize - _histOffset;
+    uint8_t size = remaining > kSimHistPacketData ? kSimHistPacketData : remaining;
+    uint8_t *packet = &_regs[kSimPageStart];
+
+    // each packet has the size of the full message
+    _regs[TMF8X2X_COM_CONFIG_RESULT] = _histRID;
+    _regs[TMF8X2X_COM_SIZE_LSB] = kSimHistogramSize & 0xFF;
+    _regs[TMF8X2X_COM_SIZE_MSB] = kSimHistogramSize >> 8;
+
+    packet[0] = _histPacket++;
+    packet[1] = size;
+    packet[2] = _histSubCapture;
+    memcpy(packet + TMF8X2X_COM_OPTIONAL_SUBPACKET_HEADER_SIZE, _histogram + _histOffset, size);
+
+    _histOffset += size;
+    if (_histOffset >= kSimHistogramSize)
+        _histActive = false;
+
+    nextTID();
+
+    _windowUnread = true;
+    _regs[TMF882X_INT_STAT] |= kSimIrqHistogram;
+}
+
+};
+
+#endif
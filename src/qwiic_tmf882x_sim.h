@@ -0,0 +1,220 @@
+// qwiic_tmf882x_sim.h
+//
+// This is a library written for SparkFun Qwiic TMF882X boards
+//
+// SparkFun sells these bpards at its website: www.sparkfun.com
+//
+// Do you like this library? Help support SparkFun. Buy a board!
+//
+//  SparkFun Qwiic dToF Imager - TMF8820        https://www.sparkfun.com/products/19036
+//  SparkFun Qwiic Mini dToF Imager - TMF8820   https://www.sparkfun.com/products/19218
+//  SparkFun Qwiic Mini dToF Imager - TMF8821   https://www.sparkfun.com/products/19451
+//  SparkFun Qwiic dToF Imager - TMF8821        https://www.sparkfun.com/products/19037
+//
+// Written by Kirk Benell @ SparkFun Electronics, April 2022
+//
+// This library provides an abstract interface to the underlying TMF882X
+// SDK that is provided by AMS.
+//
+// Repository:
+//     https://github.com/sparkfun/SparkFun_Qwiic_TMF882X_Arduino_Library
+//
+//
+// SparkFun code, firmware, and software is released under the MIT
+// License(http://opensource.org/licenses/MIT).
+//
+// SPDX-License-Identifier: MIT
+//
+//    The MIT License (MIT)
+//
+//    Copyright (c) 2022 SparkFun Electronics
+//    Permission is hereby granted, free of charge, to any person obtaining a
+//    copy of this software and associated documentation files (the "Software"),
+//    to deal in the Software without restriction, including without limitation
+//    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//    and/or sell copies of the Software, and to permit persons to whom the
+//    Software is furnished to do so, subject to the following conditions: The
+//    above copyright notice and this permission notice shall be included in all
+//    copies or substantial portions of the Software. THE SOFTWARE IS PROVIDED
+//    "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+//    NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+//    PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+//    ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+//    CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+// Header for the TMF882X device simulator
+
+#pragma once
+
+// Register level model of a TMF882X device, that is attached to the library
+// in place of a real bus. The library and the AMS SDK run unchanged on top of
+// it, so init(), firmware download, measurements and calibration can be run
+// on a host without a board connected.
+//
+// Modeled:
+//    - CPU status, power on/standby, boot matrix and CPU reset
+//    - The bootloader command protocol, with checksums - used for firmware download
+//    - App mode commands (CMD_STAT), the TID and INT_STAT handshake
+//    - Common, SPAD and factory calibration config pages
+//    - I2C address change, from the common config page
+//    - Measurement result pages, at the configured report period
+//    - Multi-packet histogram dumps
+//
+// Results are synthetic - each zone reports a fixed target, set with setTarget().
+//
+// Not built for Arduino.
+
+#if !defined(ARDUINO)
+
+#include <stdint.h>
+
+#include "qwiic_bus.h"
+
+// Default I2C address of the simulated device
+#define kSimTMF882XAddress 0x41
+
+// Size of a config page - registers 0x24 to 0xDF
+#define kSimConfigPageSize 188
+
+// Number of factory calibration pages - 4 to support 8x8 mode
+#define kSimNumCalibPages 4
+
+// Size of one histogram - 5 TDCs, 256 bins, 3 bytes per bin
+#define kSimHistogramSize (5 * 256 * 3)
+
+namespace sfe_TMF882X {
+
+class QwSimTMF882X : public QwIDeviceBus {
+
+public:
+    QwSimTMF882X(uint8_t address = kSimTMF882XAddress);
+
+    // Power on reset - the device starts in the bootloader
+    void reset(void);
+
+    // When enabled (default), results are produced at the report period. When disabled,
+    // the next result is ready as soon as the previous one is read - for throughput tests.
+    void setFramePacing(bool bEnable)
+    {
+        _framePacing = bEnable;
+    }
+    bool getFramePacing(void)
+    {
+        return _framePacing;
+    }
+
+    // Set the target reported by a zone (channel 1-9) of a sub capture (0-1). Each zone can
+    // report two targets (0-1). A confidence of 0 removes the target.
+    bool setTarget(uint8_t channel, uint8_t subCapture, uint16_t distanceMM, uint8_t confidence,
+                   uint8_t target = 0);
+
+    // Set the device serial number/UID
+    void setSerialNumber(uint32_t serialNumber);
+
+    // The state of the INT pin of the device - true when asserted (low)
+    bool interruptAsserted(void);
+
+    // Simulator stats
+    uint32_t getFrameCount(void)
+    {
+        return _nFrames;
+    }
+    uint32_t getDroppedFrames(void)
+    {
+        return _nDropped;
+    }
+    uint32_t getTransactionCount(void)
+    {
+        return _nTransactions;
+    }
+    uint32_t getBytesTransferred(void)
+    {
+        return _nBytes;
+    }
+    uint32_t getFirmwareBytes(void)
+    {
+        return _fwBytes;
+    }
+
+    // QwIDeviceBus interface
+    bool ping(uint8_t address);
+
+    bool writeRegisterByte(uint8_t address, uint8_t offset, uint8_t data);
+
+    int writeRegisterRegion(uint8_t address, uint8_t offset, uint8_t* data, uint16_t length);
+
+    int readRegisterRegion(uint8_t addr, uint8_t reg, uint8_t* data, uint16_t numBytes);
+
+private:
+    // device state
+    void bootBootloader(void);
+    void bootApp(void);
+    void writeCPUStatus(uint8_t value);
+
+    // command processing
+    void bootloaderCommand(const uint8_t* data, uint16_t length);
+    void bootloaderResponse(uint8_t status, const uint8_t* data, uint8_t size);
+    void appCommand(uint8_t cmd);
+    void loadConfigPage(uint8_t cid);
+    bool writeConfigPage(void);
+    void factoryCalibration(void);
+
+    // measurement processing
+    void updateMeasurements(void);
+    void startFrame(uint32_t frameUS);
+    void publishNext(void);
+    void publishResult(void);
+    void publishHistogramPacket(void);
+    void buildHistogram(uint8_t subCapture);
+    uint8_t numSubCaptures(void);
+    void nextTID(void);
+
+    uint8_t _address;
+    uint8_t _regs[256];
+
+    bool _isApp;
+    bool _framePacing;
+
+    // config pages
+    uint8_t _commonPage[kSimConfigPageSize];
+    uint8_t _spadPages[2][kSimConfigPageSize];
+    uint8_t _calibPages[kSimNumCalibPages][kSimConfigPageSize];
+    int8_t _calibIndex;
+
+    // bootloader
+    uint16_t _ramAddr;
+    uint32_t _fwBytes;
+
+    // measurement state
+    bool _measuring;
+    uint32_t _nextFrameUS;
+    uint32_t _frameUS;
+    uint8_t _resultNum;
+    bool _windowUnread;    // a published message hasn't been read by the host
+    uint8_t _histPending;  // histograms left to publish in this frame
+    bool _resultPending;   // result left to publish in this frame
+
+    // histogram message being streamed
+    uint8_t _histRID;
+    uint8_t _histSubCapture;
+    uint8_t _histPacket;
+    uint16_t _histOffset;
+    bool _histActive;
+    uint8_t _histogram[kSimHistogramSize];
+
+    // targets - indexed like the result page, target * 18 + sub capture * 9 + channel - 1
+    uint16_t _distanceMM[36];
+    uint8_t _confidence[36];
+
+    // stats
+    uint32_t _nFrames;
+    uint32_t _nDropped;
+    uint32_t _nTransactions;
+    uint32_t _nBytes;
+};
+
+};
+
+#endif
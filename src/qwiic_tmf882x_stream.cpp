@@ -0,0 +1,808 @@
+// qwiic_tmf882x_stream.cpp
+//
+// This is a library written for SparkFun Qwiic TMF882X boards
+//
+// SparkFun sells these bpards at its website: www.sparkfun.com
+//
+// Do you like this library? Help support SparkFun. Buy a board!
+//
+//  SparkFun Qwiic dToF Imager - TMF8820        https://www.sparkfun.com/products/19036
+//  SparkFun Qwiic Mini dToF Imager - TMF8820   https://www.sparkfun.com/products/19218
+//  SparkFun Qwiic Mini dToF Imager - TMF8821   https://www.sparkfun.com/products/19451
+//  SparkFun Qwiic dToF Imager - TMF8821        https://www.sparkfun.com/products/19037
+//
+// Written by Kirk Benell @ SparkFun Electronics, April 2022
+//
+// This library provides an abstract interface to the underlying TMF882X
+// SDK that is provided by AMS.
+//
+// Repository:
+//     https://github.com/sparkfun/SparkFun_Qwiic_TMF882X_Arduino_Library
+//
+//
+// SparkFun code, firmware, and software is released under the MIT
+// License(http://opensource.org/licenses/MIT).
+//
+// SPDX-License-Identifier: MIT
+//
+//    The MIT License (MIT)
+//
+//    Copyright (c) 2022 SparkFun Electronics
+//    Permission is hereby granted, free of charge, to any person obtaining a
+//    copy of this software and associated documentation files (the "Software"),
+//    to deal in the Software without restriction, including without limitation
+//    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//    and/or sell copies of the Software, and to permit persons to whom the
+//    Software is furnished to do so, subject to the following conditions: The
+//    above copyright notice and this permission notice shall be included in all
+//    copies or substantial portions of the Software. THE SOFTWARE IS PROVIDED
+//    "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+//    NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+//    PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+//    ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+//    CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Encoder and decoder for the TMF882X binary stream format
+
+#include <string.h>
+
+#include "qwiic_tmf882x_stream.h"
+
+// Encoder chunk size - histogram bins are written this many bytes at a time
+#define kStreamChunkSize 48
+
+static_assert(kStreamI2CMessageHeaderSize + APP_MAX_MSG_SIZE <= kStreamMaxPayload,
+              "kStreamMaxPayload must hold the largest raw message");
+
+//////////////////////////////////////////////////////////////////////////////
+// Little endian helpers
+
+static inline uint8_t *put16(uint8_t *p, uint16_t value)
+{
+    p[0] = value & 0xFF;
+    p[1] = value >> 8;
+    return p + 2;
+}
+
+static inline uint8_t *put32(uint8_t *p, uint32_t value)
+{
+    p = put16(p, value & 0xFFFF);
+    return put16(p, value >> 16);
+}
+
+static inline uint16_t get16(const uint8_t *p)
+{
+    return (uint16_t)p[0] | ((uint16_t)p[1] << 8);
+}
+
+static inline uint32_t get32(const uint8_t *p)
+{
+    return (uint32_t)get16(p) | ((uint32_t)get16(p + 2) << 16);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// Histogram bin helpers - the difference of a bin from the one before, zig-zag
+// encoded so small negative differences are small values too.
+
+static inline uint32_t binDelta(uint32_t bin, uint32_t previous)
+{
+    int32_t delta = (int32_t)(bin - previous);
+    return ((uint32_t)delta << 1) ^ (uint32_t)(delta >> 31);
+}
+
+static inline uint8_t varintSize(uint32_t value)
+{
+    uint8_t size = 1;
+
+    while (value >>= 7)
+        size++;
+    return size;
+}
+
+static inline uint8_t *putVarint(uint8_t *p, uint32_t value)
+{
+    while (value >= 0x80)
+    {
+        *p++ = (value & 0x7F) | 0x80;
+        value >>= 7;
+    }
+    *p++ = value;
+    return p;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// tmf882xStreamCRC()
+//
+// Update a CRC-16/CCITT-FALSE (poly 0x1021) with a block of data - bit at a
+// time, so no table is needed.
+//
+//  Parameter   Description
+//  ---------   -----------------------------
+//  crc         The current CRC value
+//  data        The data
+//  length      Length of the data
+//  retval      The updated CRC value
+
+uint16_t tmf882xStreamCRC(uint16_t crc, const uint8_t *data, uint16_t length)
+{
+    while (length--)
+    {
+        crc ^= (uint16_t)*data++ << 8;
+
+        for (uint8_t i = 0; i < 8; i++)
+            crc = crc & 0x8000 ? (crc << 1) ^ 0x1021 : crc << 1;
+    }
+    return crc;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// beginFrame()
+//
+// Internal method. Write the header of a frame, and start its CRC.
+//
+//  Parameter   Description
+//  ---------   -----------------------------
+//  id          The frame type
+//  length      Length of the payload
+//  retval      true on success, false on error
+
+bool TMF882XStreamEncoder::beginFrame(uint8_t id, uint16_t length)
+{
+    if (!_output)
+        return false;
+
+    uint8_t header[kStreamHeaderSize] = {kStreamSync0, kStreamSync1, id};
+    put16(header + 3, length);
+
+    // The sync bytes aren't part of the CRC
+    _crc = tmf882xStreamCRC(0xFFFF, header + 2, kStreamHeaderSize - 2);
+    _writeOK = _output->write(header, kStreamHeaderSize);
+    _bytes += kStreamHeaderSize;
+
+    return _writeOK;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// writePayload()
+//
+// Internal method. Write part of the payload of a frame.
+//
+//  Parameter   Description
+//  ---------   -----------------------------
+//  data        The payload data
+//  length      Length of the data
+
+void TMF882XStreamEncoder::writePayload(const uint8_t *data, uint16_t length)
+{
+    if (!_writeOK)
+        return;
+
+    _crc = tmf882xStreamCRC(_crc, data, length);
+    _writeOK = _output->write(data, length);
+    _bytes += length;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// endFrame()
+//
+// Internal method. Write the CRC of a frame.
+//
+//  Parameter   Description
+//  ---------   -----------------------------
+//  retval      true if the whole frame was written, false on error
+
+bool TMF882XStreamEncoder::endFrame(void)
+{
+    if (!_writeOK)
+        return false;
+
+    uint8_t trailer[kStreamCRCSize];
+    put16(trailer, _crc);
+
+    _writeOK = _output->write(trailer, kStreamCRCSize);
+    _bytes += kStreamCRCSize;
+
+    if (_writeOK)
+        _frames++;
+
+    return _writeOK;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// writeResults()
+//
+// Write a set of measurement results
+//
+//  Parameter   Description
+//  ---------   -----------------------------
+//  results     The measurement results
+//  retval      true on success, false on error
+
+bool TMF882XStreamEncoder::writeResults(struct tmf882x_msg_meas_results *results)
+{
+    if (!results || results->num_results > TMF882X_MAX_MEAS_RESULTS)
+        return false;
+
+    uint16_t length = kStreamResultsHeaderSize + kStreamResultSize * results->num_results;
+
+    if (!beginFrame(kStreamResults, length))
+        return false;
+
+    uint8_t buffer[kStreamResultsHeaderSize];
+    uint8_t *p = buffer;
+
+    *p++ = results->result_num;
+    *p++ = results->temperature;
+    *p++ = results->valid_results;
+    *p++ = results->num_results;
+    p = put32(p, results->ambient_light);
+    p = put32(p, results->photon_count);
+    p = put32(p, results->ref_photon_count);
+    p = put32(p, results->sys_ticks);
+    put32(p, results->host_time_us);
+
+    writePayload(buffer, kStreamResultsHeaderSize);
+
+    for (uint32_t i = 0; i < results->num_results; i++)
+    {
+        struct tmf882x_meas_result *result = &results->results[i];
+
+        p = buffer;
+        *p++ = result->channel;
+        *p++ = result->ch_target_idx;
+        *p++ = result->sub_capture;
+        *p++ = result->confidence;
+        put16(p, result->distance_mm);
+
+        writePayload(buffer, kStreamResultSize);
+    }
+
+    return endFrame();
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// writeHistogram()
+//
+// Write a histogram
+//
+//  Parameter   Description
+//  ---------   -----------------------------
+//  histogram   The histogram
+//  retval      true on success, false on error
+
+bool TMF882XStreamEncoder::writeHistogram(struct tmf882x_msg_histogram *histogram)
+{
+#ifdef CONFIG_TMF882X_NO_HISTOGRAM_SUPPORT
+    (void)histogram;
+    return false;
+#else
+    if (!histogram || histogram->num_tdc > TMF882X_HIST_NUM_TDC || histogram->num_bins > TMF882X_HIST_NUM_BINS)
+        return false;
+
+    // The payload length is needed up front, for the header
+    uint16_t length = kStreamHistogramHeaderSize;
+
+    for (uint32_t tdc = 0; tdc < histogram->num_tdc; tdc++)
+    {
+        uint32_t previous = 0;
+
+        for (uint32_t bin = 0; bin < histogram->num_bins; bin++)
+        {
+            length += varintSize(binDelta(histogram->bins[tdc][bin], previous));
+            previous = histogram->bins[tdc][bin];
+        }
+    }
+
+    if (!beginFrame(kStreamHistogram, length))
+        return false;
+
+    uint8_t buffer[kStreamChunkSize];
+    uint8_t *p = buffer;
+
+    p = put16(p, histogram->capture_num);
+    *p++ = histogram->sub_capture;
+    *p++ = histogram->histogram_type;
+    *p++ = histogram->num_tdc;
+    put16(p, histogram->num_bins);
+
+    writePayload(buffer, kStreamHistogramHeaderSize);
+
+    // The bins, a chunk at a time
+    p = buffer;
+    for (uint32_t tdc = 0; tdc < histogram->num_tdc; tdc++)
+    {
+        uint32_t previous = 0;
+
+        for (uint32_t bin = 0; bin < histogram->num_bins; bin++)
+        {
+            p = putVarint(p, binDelta(histogram->bins[tdc][bin], previous));
+            previous = histogram->bins[tdc][bin];
+
+            if (p - buffer > kStreamChunkSize - kStreamMaxBinSize)
+            {
+                writePayload(buffer, p - buffer);
+                p = buffer;
+            }
+        }
+    }
+    if (p != buffer)
+        writePayload(buffer, p - buffer);
+
+    return endFrame();
+#endif
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// writeStats()
+//
+// Write a set of measurement statistics
+//
+//  Parameter   Description
+//  ---------   -----------------------------
+//  stats       The measurement statistics
+//  retval      true on success, false on error
+
+bool TMF882XStreamEncoder::writeStats(struct tmf882x_msg_meas_stats *stats)
+{
+    if (!stats || !beginFrame(kStreamStats, kStreamStatsSize))
+        return false;
+
+    uint8_t buffer[kStreamStatsSize];
+    uint8_t *p = buffer;
+
+    p = put16(p, stats->capture_num);
+    *p++ = stats->sub_capture;
+    p = put32(p, stats->tdcif_status);
+    p = put32(p, stats->iterations_configured);
+    p = put32(p, stats->remaining_iterations);
+    p = put32(p, stats->accumulated_hits);
+
+    for (uint8_t i = 0; i < TMF882X_HIST_NUM_TDC; i++)
+        p = put32(p, stats->raw_hits[i]);
+    for (uint8_t i = 0; i < TMF882X_HIST_NUM_TDC; i++)
+        p = put32(p, stats->saturation_cnt[i]);
+
+    writePayload(buffer, kStreamStatsSize);
+
+    return endFrame();
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// writeI2CMessage()
+//
+// Write a raw message read from the device
+//
+//  Parameter   Description
+//  ---------   -----------------------------
+//  timeUS      Host time the message arrived at
+//  i2c_msg     The message
+//  retval      true on success, false on error
+
+bool TMF882XStreamEncoder::writeI2CMessage(uint32_t timeUS, const struct tmf882x_mode_app_i2c_msg *i2c_msg)
+{
+    if (!i2c_msg || i2c_msg->size > APP_MAX_MSG_SIZE ||
+        !beginFrame(kStreamI2CMessage, kStreamI2CMessageHeaderSize + i2c_msg->size))
+        return false;
+
+    uint8_t buffer[kStreamI2CMessageHeaderSize];
+    uint8_t *p = buffer;
+
+    p = put32(p, timeUS);
+    *p++ = i2c_msg->rid;
+    *p++ = i2c_msg->tid;
+    *p++ = i2c_msg->cfg_id;
+    p = put16(p, i2c_msg->size);
+
+    writePayload(buffer, kStreamI2CMessageHeaderSize);
+    writePayload(i2c_msg->buf, i2c_msg->size);
+
+    return endFrame();
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// writeMessage()
+//
+// Write an SDK message - other than results, histograms and statistics,
+// messages are ignored.
+//
+//  Parameter   Description
+//  ---------   -----------------------------
+//  msg         The message
+//  retval      true on success, or if ignored. false on error
+
+bool TMF882XStreamEncoder::writeMessage(struct tmf882x_msg *msg)
+{
+    if (!msg)
+        return false;
+
+    switch (msg->hdr.msg_id)
+    {
+    case ID_MEAS_RESULTS:
+        return writeResults(&msg->meas_result_msg);
+
+    case ID_HISTOGRAM:
+        return writeHistogram(&msg->hist_msg);
+
+    case ID_MEAS_STATS:
+        return writeStats(&msg->meas_stat_msg);
+
+    default:
+        return true;
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// resetStats()
+//
+// Reset the frame counts of the decoder
+
+void TMF882XStreamDecoder::resetStats(void)
+{
+    memset(&_stats, 0, sizeof(_stats));
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// decode()
+//
+// Pass a block of stream data to the decoder.
+//
+//  Parameter   Description
+//  ---------   -----------------------------
+//  data        The stream data
+//  length      Length of the data
+//  retval      The number of valid frames read
+
+uint32_t TMF882XStreamDecoder::decode(const uint8_t *data, uint32_t length)
+{
+    uint32_t nFrames = 0;
+
+    if (!data)
+        return 0;
+
+    while (length)
+    {
+        uint8_t value = *data;
+
+        switch (_state)
+        {
+        case kDecodeSync0:
+            if (value == kStreamSync0)
+                _state = kDecodeSync1;
+            else
+                _stats.skippedBytes++;
+            break;
+
+        case kDecodeSync1:
+            if (value == kStreamSync1)
+            {
+                _state = kDecodeHeader;
+                _count = 0;
+            }
+            else
+            {
+                // the first sync byte was noise - this one could start a frame
+                _stats.skippedBytes++;
+                if (value != kStreamSync0)
+                {
+                    _stats.skippedBytes++;
+                    _state = kDecodeSync0;
+                }
+            }
+            break;
+
+        case kDecodeHeader:
+            _header[_count++] = value;
+            if (_count == sizeof(_header))
+            {
+                _length = get16(_header + 1);
+                _count = 0;
+
+                if (_length > kStreamMaxPayload)
+                {
+                    // can't be a frame - look for the next one
+                    _stats.skippedBytes += kStreamHeaderSize;
+                    _state = kDecodeSync0;
+                }
+                else
+                    _state = _length ? kDecodePayload : kDecodeCRC;
+            }
+            break;
+
+        case kDecodePayload:
+        {
+            // copy as much of the payload as is available
+            uint32_t nCopy = _length - _count;
+            if (nCopy > length)
+                nCopy = length;
+
+            memcpy(_payload + _count, data, nCopy);
+            _count += nCopy;
+
+            if (_count == _length)
+            {
+                _count = 0;
+                _state = kDecodeCRC;
+            }
+            data += nCopy;
+            length -= nCopy;
+            continue;
+        }
+
+        case kDecodeCRC:
+            _crc[_count++] = value;
+            if (_count == kStreamCRCSize)
+            {
+                uint16_t crc = tmf882xStreamCRC(0xFFFF, _header, sizeof(_header));
+                crc = tmf882xStreamCRC(crc, _payload, _length);
+
+                if (crc == get16(_crc))
+                {
+                    _stats.frames++;
+                    nFrames++;
+                    dispatchFrame();
+                }
+                else
+                    _stats.crcErrors++;
+
+                _state = kDecodeSync0;
+            }
+            break;
+        }
+
+        data++;
+        length--;
+    }
+
+    return nFrames;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// dispatchFrame()
+//
+// Internal, private method. Decodes a valid frame, and calls the handlers.
+
+void TMF882XStreamDecoder::dispatchFrame(void)
+{
+    uint8_t id = _header[0];
+    uint32_t timeUS;
+
+    if (_frameHandlerCB)
+        _frameHandlerCB(id, _payload, _length);
+
+    switch (id)
+    {
+    case kStreamResults:
+        if (!decodeResults(_payload, _length, &_msg.meas_result_msg))
+            _stats.badFrames++;
+        else if (_measurementHandlerCB)
+            _measurementHandlerCB(&_msg.meas_result_msg);
+        break;
+
+    case kStreamHistogram:
+        if (!decodeHistogram(_payload, _length, &_msg.hist_msg))
+            _stats.badFrames++;
+        else if (_histogramHandlerCB)
+            _histogramHandlerCB(&_msg.hist_msg);
+        break;
+
+    case kStreamStats:
+        if (!decodeStats(_payload, _length, &_msg.meas_stat_msg))
+            _stats.badFrames++;
+        else if (_statsHandlerCB)
+            _statsHandlerCB(&_msg.meas_stat_msg);
+        break;
+
+    case kStreamI2CMessage:
+        if (!decodeI2CMessage(_payload, _length, &timeUS, &_i2cMsg))
+            _stats.badFrames++;
+        else if (_i2cMessageHandlerCB)
+            _i2cMessageHandlerCB(timeUS, &_i2cMsg);
+        break;
+
+    default:
+        // other frame types are for the frame handler
+        break;
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// decodeResults()
+//
+// Decode the payload of a results frame
+//
+//  Parameter   Description
+//  ---------   -----------------------------
+//  payload     The frame payload
+//  length      Length of the payload
+//  results     The results message to fill in
+//  retval      true on success, false if the payload is not valid
+
+bool TMF882XStreamDecoder::decodeResults(const uint8_t *payload, uint16_t length,
+                                         struct tmf882x_msg_meas_results *results)
+{
+    if (length < kStreamResultsHeaderSize)
+        return false;
+
+    uint8_t nResults = payload[3];
+
+    if (nResults > TMF882X_MAX_MEAS_RESULTS || length != kStreamResultsHeaderSize + kStreamResultSize * nResults)
+        return false;
+
+    memset(results, 0, sizeof(*results));
+    results->hdr.msg_id = ID_MEAS_RESULTS;
+    results->hdr.msg_len = sizeof(*results);
+
+    results->result_num = payload[0];
+    results->temperature = payload[1];
+    results->valid_results = payload[2];
+    results->num_results = nResults;
+    results->ambient_light = get32(payload + 4);
+    results->photon_count = get32(payload + 8);
+    results->ref_photon_count = get32(payload + 12);
+    results->sys_ticks = get32(payload + 16);
+    results->host_time_us = get32(payload + 20);
+
+    const uint8_t *p = payload + kStreamResultsHeaderSize;
+
+    for (uint8_t i = 0; i < nResults; i++, p += kStreamResultSize)
+    {
+        results->results[i].channel = p[0];
+        results->results[i].ch_target_idx = p[1];
+        results->results[i].sub_capture = p[2];
+        results->results[i].confidence = p[3];
+        results->results[i].distance_mm = get16(p + 4);
+    }
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// decodeHistogram()
+//
+// Decode the payload of a histogram frame
+//
+//  Parameter   Description
+//  ---------   -----------------------------
+//  payload     The frame payload
+//  length      Length of the payload
+//  histogram   The histogram message to fill in
+//  retval      true on success, false if the payload is not valid
+
+bool TMF882XStreamDecoder::decodeHistogram(const uint8_t *payload, uint16_t length,
+                                           struct tmf882x_msg_histogram *histogram)
+{
+#ifdef CONFIG_TMF882X_NO_HISTOGRAM_SUPPORT
+    (void)payload;
+    (void)length;
+    (void)histogram;
+    return false;
+#else
+    if (length < kStreamHistogramHeaderSize)
+        return false;
+
+    uint8_t nTDC = payload[4];
+    uint16_t nBins = get16(payload + 5);
+
+    if (nTDC > TMF882X_HIST_NUM_TDC || nBins > TMF882X_HIST_NUM_BINS)
+        return false;
+
+    memset(histogram, 0, sizeof(*histogram));
+    histogram->hdr.msg_id = ID_HISTOGRAM;
+    histogram->hdr.msg_len = sizeof(*histogram);
+
+    histogram->capture_num = get16(payload);
+    histogram->sub_capture = payload[2];
+    histogram->histogram_type = payload[3];
+    histogram->num_tdc = nTDC;
+    histogram->num_bins = nBins;
+
+    const uint8_t *p = payload + kStreamHistogramHeaderSize;
+    const uint8_t *end = payload + length;
+
+    for (uint8_t tdc = 0; tdc < nTDC; tdc++)
+    {
+        uint32_t previous = 0;
+
+        for (uint16_t bin = 0; bin < nBins; bin++)
+        {
+            // read the varint
+            uint32_t value = 0;
+            uint8_t shift = 0;
+
+            do
+            {
+                if (p == end || shift > 28)
+                    return false;
+                value |= (uint32_t)(*p & 0x7F) << shift;
+                shift += 7;
+            } while (*p++ & 0x80);
+
+            // undo the zig-zag, and add to the bin before
+            previous += (value >> 1) ^ (0 - (value & 1));
+            histogram->bins[tdc][bin] = previous;
+        }
+    }
+
+    // The bins must fill the payload
+    if (p != end)
+        return false;
+
+    return true;
+#endif
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// decodeStats()
+//
+// Decode the payload of a statistics frame
+//
+//  Parameter   Description
+//  ---------   -----------------------------
+//  payload     The frame payload
+//  length      Length of the payload
+//  stats       The statistics message to fill in
+//  retval      true on success, false if the payload is not valid
+
+bool TMF882XStreamDecoder::decodeStats(const uint8_t *payload, uint16_t length, struct tmf882x_msg_meas_stats *stats)
+{
+    if (length != kStreamStatsSize)
+        return false;
+
+    memset(stats, 0, sizeof(*stats));
+    stats->hdr.msg_id = ID_MEAS_STATS;
+    stats->hdr.msg_len = sizeof(*stats);
+
+    stats->capture_num = get16(payload);
+    stats->sub_capture = payload[2];
+    stats->tdcif_status = get32(payload + 3);
+    stats->iterations_configured = get32(payload + 7);
+    stats->remaining_iterations = get32(payload + 11);
+    stats->accumulated_hits = get32(payload + 15);
+
+    const uint8_t *p = payload + 19;
+
+    for (uint8_t i = 0; i < TMF882X_HIST_NUM_TDC; i++, p += 4)
+        stats->raw_hits[i] = get32(p);
+    for (uint8_t i = 0; i < TMF882X_HIST_NUM_TDC; i++, p += 4)
+        stats->saturation_cnt[i] = get32(p);
+
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// decodeI2CMessage()
+//
+// Decode the payload of a raw message frame
+//
+//  Parameter   Description
+//  ---------   -----------------------------
+//  payload     The frame payload
+//  length      Length of the payload
+//  timeUS      Set to the host time the message arrived at
+//  i2c_msg     The message to fill in
+//  retval      true on success, false if the payload is not valid
+
+bool TMF882XStreamDecoder::decodeI2CMessage(const uint8_t *payload, uint16_t length, uint32_t *timeUS,
+                                            struct tmf882x_mode_app_i2c_msg *i2c_msg)
+{
+    if (length < kStreamI2CMessageHeaderSize)
+        return false;
+
+    uint16_t size = get16(payload + 7);
+
+    if (size > APP_MAX_MSG_SIZE || length != kStreamI2CMessageHeaderSize + size)
+        return false;
+
+    *timeUS = get32(payload);
+
+    i2c_msg->rid = payload[4];
+    i2c_msg->cmd = 0;
+    i2c_msg->tid = payload[5];
+    i2c_msg->cfg_id = payload[6];
+    i2c_msg->size = size;
+    i2c_msg->pckt_size = 0;
+    i2c_msg->pckt_num = 0;
+    memcpy(i2c_msg->buf, payload + kStreamI2CMessageHeaderSize, size);
+
+    return true;
+}
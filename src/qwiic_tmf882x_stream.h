@@ -0,0 +1,436 @@
+// qwiic_tmf882x_stream.h
+//
+// This is a library written for SparkFun Qwiic TMF882X boards
+//
+// SparkFun sells these bpards at its website: www.sparkfun.com
+//
+// Do you like this library? Help support SparkFun. Buy a board!
+//
+//  SparkFun Qwiic dToF Imager - TMF8820        https://www.sparkfun.com/products/19036
+//  SparkFun Qwiic Mini dToF Imager - TMF8820   https://www.sparkfun.com/products/19218
+//  SparkFun Qwiic Mini dToF Imager - TMF8821   https://www.sparkfun.com/products/19451
+//  SparkFun Qwiic dToF Imager - TMF8821        https://www.sparkfun.com/products/19037
+//
+// Written by Kirk Benell @ SparkFun Electronics, April 2022
+//
+// This library provides an abstract interface to the underlying TMF882X
+// SDK that is provided by AMS.
+//
+// Repository:
+//     https://github.com/sparkfun/SparkFun_Qwiic_TMF882X_Arduino_Library
+//
+//
+// SparkFun code, firmware, and software is released under the MIT
+// License(http://opensource.org/licenses/MIT).
+//
+// SPDX-License-Identifier: MIT
+//
+//    The MIT License (MIT)
+//
+//    Copyright (c) 2022 SparkFun Electronics
+//    Permission is hereby granted, free of charge, to any person obtaining a
+//    copy of this software and associated documentation files (the "Software"),
+//    to deal in the Software without restriction, including without limitation
+//    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//    and/or sell copies of the Software, and to permit persons to whom the
+//    Software is furnished to do so, subject to the following conditions: The
+//    above copyright notice and this permission notice shall be included in all
+//    copies or substantial portions of the Software. THE SOFTWARE IS PROVIDED
+//    "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+//    NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+//    PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+//    ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+//    CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Header for the TMF882X binary stream format
+
+#pragma once
+
+#include <stdint.h>
+
+#include "qwiic_tmf882x.h"
+
+// A compact, framed, binary encoding of the SDK messages - for sending results,
+// histograms and statistics over a serial link, or saving them to a file.
+//
+// Frame layout - all values little endian:
+//
+//    sync        2 bytes     kStreamSync0, kStreamSync1
+//    id          1 byte      frame type - kStreamResults..etc
+//    length      2 bytes     length of the payload
+//    payload     length bytes
+//    crc         2 bytes     CRC-16/CCITT-FALSE of the id, length and payload
+//
+// Payloads:
+//
+//    kStreamResults      result_num, temperature, valid_results, num_results - 1 byte each
+//                        ambient_light, photon_count, ref_photon_count, sys_ticks,
+//                        host_time_us - 4 bytes each
+//                        per result: channel, ch_target_idx, sub_capture, confidence - 1
+//                        byte each, distance_mm - 2 bytes
+//
+//    kStreamHistogram    capture_num - 2 bytes, sub_capture, histogram_type, num_tdc - 1
+//                        byte each, num_bins - 2 bytes, then the bins of each TDC. Each
+//                        bin is the difference from the bin before it (zero for the first
+//                        bin), zig-zag encoded as a signed value, in a varint - 7 bits a
+//                        byte, low bits first, top bit set if more bytes follow. Most
+//                        bins take one byte.
+//
+//    kStreamStats        capture_num - 2 bytes, sub_capture - 1 byte, tdcif_status,
+//                        iterations_configured, remaining_iterations, accumulated_hits
+//                        - 4 bytes each, raw_hits and saturation_cnt of each TDC - 4
+//                        bytes each
+//
+//    kStreamI2CMessage   time_us - 4 bytes, rid, tid, cfg_id - 1 byte each, size - 2
+//                        bytes, then size bytes of the message. A raw message read from
+//                        the device, before it was decoded - see setI2CRecorder().
+//
+// A decoder that loses sync skips bytes until the next valid frame, so the stream
+// can share a serial port with text output.
+
+#define kStreamSync0 0xA5
+#define kStreamSync1 0x5A
+
+// Frame types
+#define kStreamResults 0x01
+#define kStreamHistogram 0x02
+#define kStreamStats 0x03
+#define kStreamI2CMessage 0x10
+
+// Size of the frame header (sync, id, length) and trailer (crc)
+#define kStreamHeaderSize 5
+#define kStreamCRCSize 2
+
+// Payload sizes
+#define kStreamResultsHeaderSize 24
+#define kStreamResultSize 6
+#define kStreamHistogramHeaderSize 7
+#define kStreamMaxBinSize 4 // varint of a 24 bit difference
+#define kStreamStatsSize (19 + 8 * TMF882X_HIST_NUM_TDC)
+#define kStreamI2CMessageHeaderSize 9
+
+// Largest payload - a full histogram. Larger than the largest raw message.
+#define kStreamMaxPayload (kStreamHistogramHeaderSize + kStreamMaxBinSize * TMF882X_HIST_NUM_TDC * TMF882X_HIST_NUM_BINS)
+
+//////////////////////////////////////////////////////////////////////////////
+// tmf882xStreamCRC()
+//
+// Update a CRC-16/CCITT-FALSE with a block of data. Start with 0xFFFF.
+//
+//  Parameter   Description
+//  ---------   -----------------------------
+//  crc         The current CRC value
+//  data        The data
+//  length      Length of the data
+//  retval      The updated CRC value
+
+uint16_t tmf882xStreamCRC(uint16_t crc, const uint8_t *data, uint16_t length);
+
+//////////////////////////////////////////////////////////////////////////////
+// TMF882XStreamOutput
+//
+// Output of the stream encoder. Implemented for an Arduino Stream in
+// SparkFun_TMF882X_Library.h - other outputs (a file, a socket..etc)
+// implement write().
+
+class TMF882XStreamOutput
+{
+  public:
+    virtual ~TMF882XStreamOutput(void)
+    {
+    }
+
+    // Write a block of bytes - return true if all were written
+    virtual bool write(const uint8_t *data, uint16_t length) = 0;
+};
+
+//////////////////////////////////////////////////////////////////////////////
+// TMF882XStreamEncoder
+//
+// Writes SDK messages to an output as stream frames. The frames are written
+// as they are encoded, a few bytes at a time - no frame buffer is needed.
+
+class TMF882XStreamEncoder
+{
+  public:
+    TMF882XStreamEncoder(void) : _output{nullptr}, _frames{0}, _bytes{0}, _crc{0}, _writeOK{false}
+    {
+    }
+
+    ///////////////////////////////////////////////////////////////////////
+    // setOutput()
+    //
+    // Set the output the frames are written to
+    //
+    //  Parameter   Description
+    //  ---------   -----------------------------
+    //  output      The output
+
+    void setOutput(TMF882XStreamOutput &output)
+    {
+        _output = &output;
+    }
+
+    ///////////////////////////////////////////////////////////////////////
+    // writeResults()
+    //
+    // Write a set of measurement results
+    //
+    //  Parameter   Description
+    //  ---------   -----------------------------
+    //  results     The measurement results
+    //  retval      true on success, false on error
+
+    bool writeResults(struct tmf882x_msg_meas_results *results);
+
+    ///////////////////////////////////////////////////////////////////////
+    // writeHistogram()
+    //
+    // Write a histogram. Not supported in the memory profiles without histograms.
+    //
+    //  Parameter   Description
+    //  ---------   -----------------------------
+    //  histogram   The histogram
+    //  retval      true on success, false on error
+
+    bool writeHistogram(struct tmf882x_msg_histogram *histogram);
+
+    ///////////////////////////////////////////////////////////////////////
+    // writeStats()
+    //
+    // Write a set of measurement statistics
+    //
+    //  Parameter   Description
+    //  ---------   -----------------------------
+    //  stats       The measurement statistics
+    //  retval      true on success, false on error
+
+    bool writeStats(struct tmf882x_msg_meas_stats *stats);
+
+    ///////////////////////////////////////////////////////////////////////
+    // writeI2CMessage()
+    //
+    // Write a raw message read from the device
+    //
+    //  Parameter   Description
+    //  ---------   -----------------------------
+    //  timeUS      Host time the message arrived at
+    //  i2c_msg     The message
+    //  retval      true on success, false on error
+
+    bool writeI2CMessage(uint32_t timeUS, const struct tmf882x_mode_app_i2c_msg *i2c_msg);
+
+    ///////////////////////////////////////////////////////////////////////
+    // writeMessage()
+    //
+    // Write an SDK message - results, histograms and statistics are written,
+    // other messages are ignored. Can be called from a message handler.
+    //
+    //  Parameter   Description
+    //  ---------   -----------------------------
+    //  msg         The message
+    //  retval      true on success, or if ignored. false on error
+
+    bool writeMessage(struct tmf882x_msg *msg);
+
+    ///////////////////////////////////////////////////////////////////////
+    // getFrameCount()
+    //
+    // Returns the number of frames written
+
+    uint32_t getFrameCount(void)
+    {
+        return _frames;
+    }
+
+    ///////////////////////////////////////////////////////////////////////
+    // getByteCount()
+    //
+    // Returns the number of bytes written
+
+    uint32_t getByteCount(void)
+    {
+        return _bytes;
+    }
+
+  protected:
+    bool beginFrame(uint8_t id, uint16_t length);
+    void writePayload(const uint8_t *data, uint16_t length);
+    bool endFrame(void);
+
+  private:
+    TMF882XStreamOutput *_output;
+    uint32_t _frames;
+    uint32_t _bytes;
+
+    // state of the frame being written
+    uint16_t _crc;
+    bool _writeOK;
+};
+
+//////////////////////////////////////////////////////////////////////////////
+// Stream Frame Handler type
+//
+// Called with each valid frame read by the stream decoder - before the frame
+// is decoded into a message.
+
+typedef void (*TMF882XStreamFrameHandler)(uint8_t id, const uint8_t *payload, uint16_t length);
+
+//////////////////////////////////////////////////////////////////////////////
+// Stream I2C Message Handler type
+//
+// Called with each raw message read by the stream decoder, and the host time
+// it arrived at.
+
+typedef void (*TMF882XStreamI2CMessageHandler)(uint32_t timeUS, const struct tmf882x_mode_app_i2c_msg *i2c_msg);
+
+//////////////////////////////////////////////////////////////////////////////
+// Stream Decode Stats
+
+struct TMF882XStreamStats
+{
+    uint32_t frames;       // Valid frames read
+    uint32_t crcErrors;    // Frames dropped - bad CRC
+    uint32_t skippedBytes; // Bytes skipped while looking for a frame
+    uint32_t badFrames;    // Frames with a valid CRC, but a payload that can't be decoded
+};
+
+//////////////////////////////////////////////////////////////////////////////
+// TMF882XStreamDecoder
+//
+// Reads stream frames, and decodes them back into SDK messages. The messages
+// are passed to handlers of the same types used by QwDevTMF882X, so the same
+// code can process live and recorded data.
+//
+// The decoder holds a frame buffer and a message - a few KB. It's meant for
+// the host side of a link, but has no host dependencies.
+
+class TMF882XStreamDecoder
+{
+  public:
+    TMF882XStreamDecoder(void)
+        : _measurementHandlerCB{nullptr}, _histogramHandlerCB{nullptr}, _statsHandlerCB{nullptr},
+          _frameHandlerCB{nullptr}, _i2cMessageHandlerCB{nullptr}
+    {
+        reset();
+        resetStats();
+    }
+
+    ///////////////////////////////////////////////////////////////////////
+    // Handlers - called with each decoded message of the type
+
+    void setMeasurementHandler(TMF882XMeasurementHandler handler)
+    {
+        _measurementHandlerCB = handler;
+    }
+
+    void setHistogramHandler(TMF882XHistogramHandler handler)
+    {
+        _histogramHandlerCB = handler;
+    }
+
+    void setStatsHandler(TMF882XStatsHandler handler)
+    {
+        _statsHandlerCB = handler;
+    }
+
+    void setFrameHandler(TMF882XStreamFrameHandler handler)
+    {
+        _frameHandlerCB = handler;
+    }
+
+    void setI2CMessageHandler(TMF882XStreamI2CMessageHandler handler)
+    {
+        _i2cMessageHandlerCB = handler;
+    }
+
+    ///////////////////////////////////////////////////////////////////////
+    // decode()
+    //
+    // Pass a block of stream data to the decoder. The block doesn't need to hold
+    // whole frames - a frame can be split over any number of calls. The handlers
+    // are called for each frame completed.
+    //
+    //  Parameter   Description
+    //  ---------   -----------------------------
+    //  data        The stream data
+    //  length      Length of the data
+    //  retval      The number of valid frames read
+
+    uint32_t decode(const uint8_t *data, uint32_t length);
+
+    ///////////////////////////////////////////////////////////////////////
+    // reset()
+    //
+    // Drop any partial frame, and look for the start of the next frame
+
+    void reset(void)
+    {
+        _state = kDecodeSync0;
+    }
+
+    ///////////////////////////////////////////////////////////////////////
+    // getStreamStats()
+    //
+    // Returns the frame counts of the decoder
+    //
+    //  Parameter   Description
+    //  ---------   -----------------------------
+    //  stats       Struct to hold the stats
+
+    void getStreamStats(TMF882XStreamStats &stats)
+    {
+        stats = _stats;
+    }
+
+    ///////////////////////////////////////////////////////////////////////
+    // resetStats()
+    //
+    // Reset the frame counts
+
+    void resetStats(void);
+
+    ///////////////////////////////////////////////////////////////////////
+    // Payload decoders - decode the payload of a frame into a message. Return
+    // true on success, false if the payload is not valid.
+
+    static bool decodeResults(const uint8_t *payload, uint16_t length, struct tmf882x_msg_meas_results *results);
+    static bool decodeHistogram(const uint8_t *payload, uint16_t length, struct tmf882x_msg_histogram *histogram);
+    static bool decodeStats(const uint8_t *payload, uint16_t length, struct tmf882x_msg_meas_stats *stats);
+    static bool decodeI2CMessage(const uint8_t *payload, uint16_t length, uint32_t *timeUS,
+                                 struct tmf882x_mode_app_i2c_msg *i2c_msg);
+
+  private:
+    void dispatchFrame(void);
+
+    enum
+    {
+        kDecodeSync0,
+        kDecodeSync1,
+        kDecodeHeader,
+        kDecodePayload,
+        kDecodeCRC
+    } _state;
+
+    TMF882XMeasurementHandler _measurementHandlerCB;
+    TMF882XHistogramHandler _histogramHandlerCB;
+    TMF882XStatsHandler _statsHandlerCB;
+    TMF882XStreamFrameHandler _frameHandlerCB;
+    TMF882XStreamI2CMessageHandler _i2cMessageHandlerCB;
+
+    // frame being read
+    uint8_t _header[3]; // id, length
+    uint16_t _length;
+    uint16_t _count;    // bytes read of the current part
+    uint8_t _crc[kStreamCRCSize];
+    uint8_t _payload[kStreamMaxPayload];
+
+    // the decoded message - one type at a time
+    union {
+        struct tmf882x_msg _msg;
+        struct tmf882x_mode_app_i2c_msg _i2cMsg;
+    };
+
+    TMF882XStreamStats _stats;
+};
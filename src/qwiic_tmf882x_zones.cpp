@@ -0,0 +1,270 @@
+// qwiic_tmf882x_zones.cpp
+//
+// This is a library written for SparkFun Qwiic TMF882X boards
+//
+// SparkFun sells these bpards at its website: www.sparkfun.com
+//
+// Do you like this library? Help support SparkFun. Buy a board!
+//
+//  SparkFun Qwiic dToF Imager - TMF8820        https://www.sparkfun.com/products/19036
+//  SparkFun Qwiic Mini dToF Imager - TMF8820   https://www.sparkfun.com/products/19218
+//  SparkFun Qwiic Mini dToF Imager - TMF8821   https://www.sparkfun.com/products/19451
+//  SparkFun Qwiic dToF Imager - TMF8821        https://www.sparkfun.com/products/19037
+//
+// Written by Kirk Benell @ SparkFun Electronics, April 2022
+//
+// This library provides an abstract interface to the underlying TMF882X
+// SDK that is provided by AMS.
+//
+// Repository:
+//     https://github.com/sparkfun/SparkFun_Qwiic_TMF882X_Arduino_Library
+//
+//
+// SparkFun code, firmware, and software is released under the MIT
+// License(http://opensource.org/licenses/MIT).
+//
+// SPDX-License-Identifier: MIT
+//
+//    The MIT License (MIT)
+//
+//    Copyright (c) 2022 SparkFun Electronics
+//    Permission is hereby granted, free of charge, to any person obtaining a
+//    copy of this software and associated documentation files (the "Software"),
+//    to deal in the Software without restriction, including without limitation
+//    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//    and/or sell copies of the Software, and to permit persons to whom the
+//    Software is furnished to do so, subject to the following conditions: The
+//    above copyright notice and this permission notice shall be included in all
+//    copies or substantial portions of the Software. THE SOFTWARE IS PROVIDED
+//    "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+//    NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+//    PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+//    ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+//    CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+
+// Zone to angle tables, and point cloud generation
+
+#include <math.h>
+#include <string.h>
+
+#include "qwiic_tmf882x_zones.h"
+
+//////////////////////////////////////////////////////////////////////////////
+// Predefined SPAD map tables - generated by extras/zones/zone_tables.py, from the
+// grid and field of view of each map. Maps with the same grid and field of view
+// share a table. Maps 8, 9 (9 zones) and 11, 12 (checkerboard) have no table -
+// their zone positions aren't a plain grid.
+
+// Map 1 - 3x3, 29 x 29 degrees
+static constexpr TMF882XZoneMap kZoneMap1 = {{
+    {{-2713, 2713, 15928}, {0, 2751, 16151}, {2713, 2713, 15928}, {-2751, 0, 16151}, {0, 0, 16384},
+     {2751, 0, 16151}, {-2713, -2713, 15928}, {0, -2751, 16151}, {2713, -2713, 15928}},
+    {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0},
+     {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}},
+}};
+
+// Maps 2, 3 - 3x3, 29 x 43.5 degrees
+static constexpr TMF882XZoneMap kZoneMap2 = {{
+    {{-2666, 4048, 15651}, {0, 4102, 15862}, {2666, 4048, 15651}, {-2751, 0, 16151}, {0, 0, 16384},
+     {2751, 0, 16151}, {-2666, -4048, 15651}, {0, -4102, 15862}, {2666, -4048, 15651}},
+    {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0},
+     {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}},
+}};
+
+// Maps 4, 5 - 4x4, 29 x 43.5 degrees
+static constexpr TMF882XZoneMap kZoneMap4 = {{
+    {{-2971, 4526, 15464}, {-994, 4593, 15695}, {994, 4593, 15695}, {2971, 4526, 15464}, {-3078, 1525, 16020},
+     {-1031, 1549, 16278}, {1031, 1549, 16278}, {3078, 1525, 16020}, {0, 0, 0}},
+    {{-3078, -1525, 16020}, {-1031, -1549, 16278}, {1031, -1549, 16278}, {3078, -1525, 16020}, {-2971, -4526, 15464},
+     {-994, -4593, 15695}, {994, -4593, 15695}, {2971, -4526, 15464}, {0, 0, 0}},
+}};
+
+// Map 6 - 3x3, 44 x 48 degrees
+static constexpr TMF882XZoneMap kZoneMap6 = {{
+    {{-3997, 4380, 15273}, {0, 4516, 15749}, {3997, 4380, 15273}, {-4148, 0, 15850}, {0, 0, 16384},
+     {4148, 0, 15850}, {-3997, -4380, 15273}, {0, -4516, 15749}, {3997, -4380, 15273}},
+    {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0},
+     {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}},
+}};
+
+// Map 7 - 4x4, 44 x 48 degrees
+static constexpr TMF882XZoneMap kZoneMap7 = {{
+    {{-4443, 4873, 14998}, {-1494, 5042, 15517}, {1494, 5042, 15517}, {4443, 4873, 14998}, {-4630, 1643, 15630},
+     {-1562, 1705, 16220}, {1562, 1705, 16220}, {4630, 1643, 15630}, {0, 0, 0}},
+    {{-4630, -1643, 15630}, {-1562, -1705, 16220}, {1562, -1705, 16220}, {4630, -1643, 15630}, {-4443, -4873, 14998},
+     {-1494, -5042, 15517}, {1494, -5042, 15517}, {4443, -4873, 14998}, {0, 0, 0}},
+}};
+
+// Map 10 - 3x6, 29 x 57 degrees
+static constexpr TMF882XZoneMap kZoneMap10 = {{
+    {{-2524, 6520, 14817}, {0, 6599, 14996}, {2524, 6520, 14817}, {-2669, 3979, 15668}, {0, 4033, 15880},
+     {2669, 3979, 15668}, {-2742, 1338, 16097}, {0, 1357, 16328}, {2742, 1338, 16097}},
+    {{-2742, -1338, 16097}, {0, -1357, 16328}, {2742, -1338, 16097}, {-2669, -3979, 15668}, {0, -4033, 15880},
+     {2669, -3979, 15668}, {-2524, -6520, 14817}, {0, -6599, 14996}, {2524, -6520, 14817}},
+}};
+
+// Map 13 - 4x4, 29 x 39 degrees
+static constexpr TMF882XZoneMap kZoneMap13 = {{
+    {{-2994, 4067, 15586}, {-1002, 4129, 15823}, {1002, 4129, 15823}, {2994, 4067, 15586}, {-3080, 1368, 16034},
+     {-1032, 1390, 16292}, {1032, 1390, 16292}, {3080, 1368, 16034}, {0, 0, 0}},
+    {{-3080, -1368, 16034}, {-1032, -1390, 16292}, {1032, -1390, 16292}, {3080, -1368, 16034}, {-2994, -4067, 15586},
+     {-1002, -4129, 15823}, {1002, -4129, 15823}, {2994, -4067, 15586}, {0, 0, 0}},
+}};
+
+// Tables by SPAD map ID - nullptr for the maps without one, and the test (0)
+// and user defined (14, 15) maps
+static constexpr const TMF882XZoneMap *kZoneMaps[] = {
+    nullptr, &kZoneMap1, &kZoneMap2, &kZoneMap2,
+    &kZoneMap4, &kZoneMap4, &kZoneMap6, &kZoneMap7,
+    nullptr, nullptr, &kZoneMap10, nullptr,
+    nullptr, &kZoneMap13,
+};
+
+#define kNumZoneMaps (sizeof(kZoneMaps) / sizeof(kZoneMaps[0]))
+
+#define kDegToRad (3.14159265f / 180.0f)
+
+//////////////////////////////////////////////////////////////////////////////
+// getTMF882XZoneMap()
+//
+// Returns the zone map of a predefined SPAD map.
+//
+//  Parameter    Description
+//  ---------    -----------------------------
+//  idSPAD       The ID of the SPAD map
+//  retval       The zone map, nullptr if the map isn't a predefined grid map - not
+//               for maps 8, 9 (9 zones) and 11, 12 (checkerboard)
+
+const TMF882XZoneMap *getTMF882XZoneMap(uint8_t idSPAD)
+{
+    return idSPAD < kNumZoneMaps ? kZoneMaps[idSPAD] : nullptr;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// buildTMF882XZoneMap()
+//
+// Derive the zone map of a user defined SPAD map.
+//
+//  Parameter    Description
+//  ---------    -----------------------------
+//  spadConfig   The SPAD configuration - from getSPADConfig()
+//  zoneMap      The zone map to fill in
+//  pitchXDeg    The horizontal angle covered by a SPAD, in degrees
+//  pitchYDeg    The vertical angle covered by a SPAD, in degrees
+//  retval       true on success, false on error
+
+bool buildTMF882XZoneMap(const struct tmf882x_mode_app_spad_config &spadConfig, TMF882XZoneMap &zoneMap,
+                         float pitchXDeg, float pitchYDeg)
+{
+    memset(&zoneMap, 0, sizeof(zoneMap));
+
+    if (!spadConfig.num_spad_configs || spadConfig.num_spad_configs > TMF882X_NUM_SUB_CAPTURES)
+        return false;
+
+    for (uint32_t sub = 0; sub < spadConfig.num_spad_configs; sub++)
+    {
+        const struct tmf882x_mode_app_spad_config::tmf882x_mode_app_single_spad_config *config = &spadConfig.spad_configs[sub];
+
+        if (config->xsize > TMF8X2X_COM_MAX_SPAD_XSIZE || config->ysize > TMF8X2X_COM_MAX_SPAD_YSIZE)
+            return false;
+
+        // sum the positions of the enabled SPADs of each channel
+        uint16_t sumX[TMF882X_NUM_RESULT_CH] = {0};
+        uint16_t sumY[TMF882X_NUM_RESULT_CH] = {0};
+        uint8_t nSPADs[TMF882X_NUM_RESULT_CH] = {0};
+
+        for (uint8_t y = 0; y < config->ysize; y++)
+        {
+            for (uint8_t x = 0; x < config->xsize; x++)
+            {
+                uint16_t idx = y * config->xsize + x;
+                uint8_t channel = config->spad_map[idx];
+
+                if (!config->spad_mask[idx] || channel < 1 || channel > TMF882X_NUM_RESULT_CH)
+                    continue;
+
+                sumX[channel - 1] += x;
+                sumY[channel - 1] += y;
+                nSPADs[channel - 1]++;
+            }
+        }
+
+        for (uint8_t ch = 0; ch < TMF882X_NUM_RESULT_CH; ch++)
+        {
+            if (!nSPADs[ch])
+                continue;
+
+            // center of the zone from the center of the SPAD array, in SPADs. The
+            // offsets are in half SPADs.
+            float posX = (float)sumX[ch] / nSPADs[ch] - (config->xsize - 1) / 2.0f + config->xoff_q1 / 2.0f;
+            float posY = (config->ysize - 1) / 2.0f - (float)sumY[ch] / nSPADs[ch] + config->yoff_q1 / 2.0f;
+
+            float rayX = tanf(posX * pitchXDeg * kDegToRad);
+            float rayY = tanf(posY * pitchYDeg * kDegToRad);
+            float scale = kZoneRayOne / sqrtf(rayX * rayX + rayY * rayY + 1.0f);
+
+            zoneMap.rays[sub][ch].x = (int16_t)lroundf(rayX * scale);
+            zoneMap.rays[sub][ch].y = (int16_t)lroundf(rayY * scale);
+            zoneMap.rays[sub][ch].z = (int16_t)lroundf(scale);
+        }
+    }
+
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// getTMF882XPointCloud()
+//
+// Place the targets of a result in space, using the zone map of the SPAD map in
+// use.
+//
+//  Parameter    Description
+//  ---------    -----------------------------
+//  zoneMap      The zone map of the SPAD map the results are from
+//  results      The compact results
+//  points       Array to hold the points
+//  nPoints      Number of points the array holds
+//  retval       The number of points returned
+
+uint16_t getTMF882XPointCloud(const TMF882XZoneMap &zoneMap, const struct tmf882x_meas_compact &results,
+                              TMF882XPoint *points, uint16_t nPoints)
+{
+    if (!points)
+        return 0;
+
+    uint16_t count = 0;
+
+    for (uint8_t sub = 0; sub < TMF882X_NUM_SUB_CAPTURES; sub++)
+    {
+        for (uint8_t ch = 0; ch < TMF882X_NUM_RESULT_CH; ch++)
+        {
+            const TMF882XZoneRay *ray = &zoneMap.rays[sub][ch];
+
+            if (!ray->z)
+                continue;
+
+            for (uint8_t target = 0; target < TMF882X_NUM_CH_TARGETS; target++)
+            {
+                if (!results.confidence[sub][ch][target])
+                    continue;
+
+                if (count == nPoints)
+                    return count;
+
+                int32_t distance = results.distance_mm[sub][ch][target];
+
+                points[count].x = (int16_t)((distance * ray->x) >> kZoneRayShift);
+                points[count].y = (int16_t)((distance * ray->y) >> kZoneRayShift);
+                points[count].z = (int16_t)((distance * ray->z) >> kZoneRayShift);
+                points[count].confidence = results.confidence[sub][ch][target];
+                points[count].zone = sub * TMF882X_NUM_RESULT_CH + ch;
+                count++;
+            }
+        }
+    }
+
+    return count;
+}
@@ -0,0 +1,147 @@
+// qwiic_tmf882x_zones.h
+//
+// This is a library written for SparkFun Qwiic TMF882X boards
+//
+// SparkFun sells these bpards at its website: www.sparkfun.com
+//
+// Do you like this library? Help support SparkFun. Buy a board!
+//
+//  SparkFun Qwiic dToF Imager - TMF8820        https://www.sparkfun.com/products/19036
+//  SparkFun Qwiic Mini dToF Imager - TMF8820   https://www.sparkfun.com/products/19218
+//  SparkFun Qwiic Mini dToF Imager - TMF8821   https://www.sparkfun.com/products/19451
+//  SparkFun Qwiic dToF Imager - TMF8821        https://www.sparkfun.com/products/19037
+//
+// Written by Kirk Benell @ SparkFun Electronics, April 2022
+//
+// This library provides an abstract interface to the underlying TMF882X
+// SDK that is provided by AMS.
+//
+// Repository:
+//     https://github.com/sparkfun/SparkFun_Qwiic_TMF882X_Arduino_Library
+//
+//
+// SparkFun code, firmware, and software is released under the MIT
+// License(http://opensource.org/licenses/MIT).
+//
+// SPDX-License-Identifier: MIT
+//
+//    The MIT License (MIT)
+//
+//    Copyright (c) 2022 SparkFun Electronics
+//    Permission is hereby granted, free of charge, to any person obtaining a
+//    copy of this software and associated documentation files (the "Software"),
+//    to deal in the Software without restriction, including without limitation
+//    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//    and/or sell copies of the Software, and to permit persons to whom the
+//    Software is furnished to do so, subject to the following conditions: The
+//    above copyright notice and this permission notice shall be included in all
+//    copies or substantial portions of the Software. THE SOFTWARE IS PROVIDED
+//    "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+//    NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+//    PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+//    ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+//    CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+
+// Header for the zone to angle tables, and point cloud generation
+
+#pragma once
+
+#include <stdint.h>
+
+#include "tmf882x_interface.h"
+
+// Zone rays are unit vectors in Q14 fixed point
+#define kZoneRayShift 14
+#define kZoneRayOne (1 << kZoneRayShift)
+
+// Angle covered by one SPAD, in degrees - from the 29 x 29 degree field of view
+// of the 14 x 6 SPAD normal mode map.
+#define kSPADPitchXDeg (29.0f / 14)
+#define kSPADPitchYDeg (29.0f / 6)
+
+//////////////////////////////////////////////////////////////////////////////
+// Zone Map
+//
+// The ray of each zone of a SPAD map - the unit vector from the sensor through
+// the center of the zone. x is to the right, y is up and z is out along the
+// optical axis, as seen from the sensor. Indexed [sub_capture][channel - 1], the
+// same as the compact results. Zones not used by the map have a zero ray.
+
+struct TMF882XZoneRay
+{
+    int16_t x;
+    int16_t y;
+    int16_t z;
+};
+
+struct TMF882XZoneMap
+{
+    TMF882XZoneRay rays[TMF882X_NUM_SUB_CAPTURES][TMF882X_NUM_RESULT_CH];
+};
+
+//////////////////////////////////////////////////////////////////////////////
+// Point
+//
+// A target placed in space, in millimeters
+
+struct TMF882XPoint
+{
+    int16_t x;
+    int16_t y;
+    int16_t z;
+    uint8_t confidence;
+    uint8_t zone; // sub_capture * TMF882X_NUM_RESULT_CH + channel - 1
+};
+
+//////////////////////////////////////////////////////////////////////////////
+// getTMF882XZoneMap()
+//
+// Returns the zone map of a predefined SPAD map. The maps are compile time tables.
+// The zones are numbered from the top left, row by row, with sub-capture 1 holding
+// the zones after those of sub-capture 0.
+//
+//  Parameter    Description
+//  ---------    -----------------------------
+//  idSPAD       The ID of the SPAD map
+//  retval       The zone map, nullptr if the map isn't a predefined grid map - not
+//               for maps 8, 9 (9 zones) and 11, 12 (checkerboard)
+
+const TMF882XZoneMap *getTMF882XZoneMap(uint8_t idSPAD);
+
+//////////////////////////////////////////////////////////////////////////////
+// buildTMF882XZoneMap()
+//
+// Derive the zone map of a user defined SPAD map. The ray of a zone passes through
+// the center of the SPADs of its channel. The SPAD map is taken as seen from the
+// sensor, with row 0 at the top.
+//
+//  Parameter    Description
+//  ---------    -----------------------------
+//  spadConfig   The SPAD configuration - from getSPADConfig()
+//  zoneMap      The zone map to fill in
+//  pitchXDeg    The horizontal angle covered by a SPAD, in degrees
+//  pitchYDeg    The vertical angle covered by a SPAD, in degrees
+//  retval       true on success, false on error
+
+bool buildTMF882XZoneMap(const struct tmf882x_mode_app_spad_config &spadConfig, TMF882XZoneMap &zoneMap,
+                         float pitchXDeg = kSPADPitchXDeg, float pitchYDeg = kSPADPitchYDeg);
+
+//////////////////////////////////////////////////////////////////////////////
+// getTMF882XPointCloud()
+//
+// Place the targets of a result in space, using the zone map of the SPAD map in
+// use. Only table lookups and integer math are used.
+//
+//  Parameter    Description
+//  ---------    -----------------------------
+//  zoneMap      The zone map of the SPAD map the results are from
+//  results      The compact results
+//  points       Array to hold the points
+//  nPoints      Number of points the array holds
+//  retval       The number of points returned
+
+uint16_t getTMF882XPointCloud(const TMF882XZoneMap &zoneMap, const struct tmf882x_meas_compact &results,
+                              TMF882XPoint *points, uint16_t nPoints);
@@ -53,6 +53,10 @@
 // all function signatures are C, and annotated as such ("extern C") in the header file.
 //
 
+// Only built for Arduino - see sfe_linux.cpp for Linux hosts
+
+#if defined(ARDUINO)
+
 #include <stdint.h>
 #include <stdio.h>
 #include <string.h>
@@ -79,6 +83,17 @@ unsigned long sfe_millis(void)
     return millis();
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// sfe_micros()
+//
+// Wrapper around Arduino function micros() - keeps Arduino space isolated from AMS code. Used
+// to timestamp interrupts from the TMF882X INT pin - safe to call from an ISR.
+
+unsigned long sfe_micros(void)
+{
+    return micros();
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // sfe_msleep()
 //
@@ -109,6 +124,43 @@ void sfe_usleep(uint32_t usec)
     sfe_msleep(tick < 3 ? 3 : tick);
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// sfe_yield()
+//
+// Give the system a chance to run other tasks while we spin waiting on an event.
+//
+// Wrapper around Arduino function yield()
+
+void sfe_yield(void)
+{
+    yield();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// sfe_disable_interrupts()
+//
+// Start a section the ISR of the INT pin can't interrupt - used to read the interrupt time, which
+// isn't read in one instruction on 8 bit boards.
+//
+// Wrapper around Arduino function noInterrupts()
+
+void sfe_disable_interrupts(void)
+{
+    noInterrupts();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// sfe_enable_interrupts()
+//
+// End a section started by sfe_disable_interrupts()
+//
+// Wrapper around Arduino function interrupts()
+
+void sfe_enable_interrupts(void)
+{
+    interrupts();
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // sfe_set_output_device()
 //
@@ -139,3 +191,5 @@ void sfe_output(const char* fmt, va_list args)
 
     s_outputDevice->println(szBuffer);
 }
+
+#endif
@@ -58,6 +58,8 @@
 
 
 #include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -65,11 +67,20 @@ extern "C" {
 
 // Utility routines needed for the underling sdk
 unsigned long sfe_millis(void);
+unsigned long sfe_micros(void);
 void sfe_usleep(uint32_t usec);
 void sfe_msleep(uint32_t msec);
+void sfe_yield(void);
+void sfe_disable_interrupts(void);
+void sfe_enable_interrupts(void);
 void sfe_output(const char* fmt, va_list args);
 void sfe_set_output_device(void*);
 
+#if defined(__linux__) && !defined(ARDUINO)
+// Linux hosts - time only advances by sleeps and yields. For use with the device simulator.
+void sfe_set_virtual_clock(bool bEnable);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
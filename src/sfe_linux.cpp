@@ -0,0 +1,233 @@
+// sfe_linux.cpp
+//
+// This is a library written for SparkFun Qwiic TMF882X boards
+//
+// SparkFun sells these bpards at its website: www.sparkfun.com
+//
+// Do you like this library? Help support SparkFun. Buy a board!
+//
+//  SparkFun Qwiic dToF Imager - TMF8820        https://www.sparkfun.com/products/19036
+//  SparkFun Qwiic Mini dToF Imager - TMF8820   https://www.sparkfun.com/products/19218
+//  SparkFun Qwiic Mini dToF Imager - TMF8821   https://www.sparkfun.com/products/19451
+//  SparkFun Qwiic dToF Imager - TMF8821        https://www.sparkfun.com/products/19037
+//
+// Written by Kirk Benell @ SparkFun Electronics, April 2022
+//
+// This library provides an abstract interface to the underlying TMF882X
+// SDK that is provided by AMS.
+//
+// Repository:
+//     https://github.com/sparkfun/SparkFun_Qwiic_TMF882X_Arduino_Library
+//
+//
+// SparkFun code, firmware, and software is released under the MIT
+// License(http://opensource.org/licenses/MIT).
+//
+// SPDX-License-Identifier: MIT
+//
+//    The MIT License (MIT)
+//
+//    Copyright (c) 2022 SparkFun Electronics
+//    Permission is hereby granted, free of charge, to any person obtaining a
+//    copy of this software and associated documentation files (the "Software"),
+//    to deal in the Software without restriction, including without limitation
+//    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//    and/or sell copies of the Software, and to permit persons to whom the
+//    Software is furnished to do so, subject to the following conditions: The
+//    above copyright notice and this permission notice shall be included in all
+//    copies or substantial portions of the Software. THE SOFTWARE IS PROVIDED
+//    "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+//    NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+//    PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+//    ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+//    CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+// sfe_linux.cpp
+//
+// This file implements the C interface functions that the underlying TMF SDK/Library uses for platform
+// specific functionalty. The platform is a Linux host in this scenario.
+//
+// The functions are declared in sfe_arduino.h - the same interface is used for each platform.
+//
+// Only built on Linux hosts - not when building for Arduino.
+
+#if defined(__linux__) && !defined(ARDUINO)
+
+#include <sched.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "sfe_arduino.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Stash for our output device -- for messages...etc.
+//
+// Output is to a stdio FILE - stdout by default.
+static FILE* s_outputDevice = nullptr;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Virtual clock - when enabled, time only advances when the library sleeps or yields. This
+// lets the library run against the device simulator at full speed, with repeatable timing.
+
+// Time advanced for each yield - about the time of a bus transaction
+#define kVirtualYieldUS 10
+
+static bool s_virtualClock = false;
+static uint64_t s_virtualUS = 0;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Elapsed time helper - time since the first call, using the monotonic clock.
+
+static uint64_t sfe_elapsed_usec(void)
+{
+    static uint64_t startUS = 0;
+    struct timespec ts;
+
+    if (s_virtualClock)
+        return s_virtualUS;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    uint64_t nowUS = (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+
+    if (!startUS)
+        startUS = nowUS;
+
+    return nowUS - startUS;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// sfe_millis()
+//
+// Milli-seconds since the library started. Wraps, like the Arduino version.
+
+unsigned long sfe_millis(void)
+{
+    return (unsigned long)(sfe_elapsed_usec() / 1000);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// sfe_micros()
+//
+// Micro-seconds since the library started. Wraps, like the Arduino version.
+
+unsigned long sfe_micros(void)
+{
+    return (unsigned long)sfe_elapsed_usec();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// sfe_msleep()
+//
+// Sleep for a number of milli-seconds
+
+void sfe_msleep(uint32_t msec)
+{
+    sfe_usleep(msec * 1000);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// sfe_usleep()
+//
+// Sleep for a number of micro-seconds. Unlike the Arduino version, the full resolution is kept.
+
+void sfe_usleep(uint32_t usec)
+{
+    struct timespec ts;
+
+    if (s_virtualClock)
+    {
+        s_virtualUS += usec;
+        return;
+    }
+
+    ts.tv_sec = usec / 1000000;
+    ts.tv_nsec = (usec % 1000000) * 1000;
+
+    while (nanosleep(&ts, &ts) == -1)
+        ; // interrupted - sleep for the remainder
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// sfe_yield()
+//
+// Give the system a chance to run other tasks while we spin waiting on an event.
+
+void sfe_yield(void)
+{
+    if (s_virtualClock)
+        s_virtualUS += kVirtualYieldUS;
+    else
+        sched_yield();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// sfe_disable_interrupts()
+//
+// Nothing to do - there's no ISR on the host, and 32 bit values are read in one load.
+
+void sfe_disable_interrupts(void)
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// sfe_enable_interrupts()
+//
+// Nothing to do - see sfe_disable_interrupts()
+
+void sfe_enable_interrupts(void)
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// sfe_set_virtual_clock()
+//
+// Enable or disable the virtual clock. Virtual time starts at the current elapsed time, so
+// the clock doesn't go backwards.
+
+void sfe_set_virtual_clock(bool bEnable)
+{
+    if (bEnable == s_virtualClock)
+        return;
+
+    if (bEnable)
+        s_virtualUS = sfe_elapsed_usec();
+
+    s_virtualClock = bEnable;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// sfe_set_output_device()
+//
+// Function to set the output device used in this file for dumping out text messages. On
+// Linux, this is a stdio FILE pointer.
+
+void sfe_set_output_device(void* theDevice)
+{
+    if (!theDevice)
+        return;
+
+    s_outputDevice = (FILE*)theDevice;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// sfe_output()
+//
+// Outputs a string to the provided output device. Expects a format string and arg list
+
+void sfe_output(const char* fmt, va_list args)
+{
+    if (!fmt)
+        return;
+
+    FILE* output = s_outputDevice ? s_outputDevice : stdout;
+
+    vfprintf(output, fmt, args);
+    fputc('\n', output);
+}
+
+#endif
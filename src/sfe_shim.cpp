@@ -200,10 +200,12 @@ void tof_usleep(void* pTarget, uint32_t usec)
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 // tof_get_timespec()
 //
-// Used to get a number of elapsed milli secs in a timespec struct.
+// Used to get the elapsed time in a timespec struct - milli-sec resolution.
 
 void tof_get_timespec(struct timespec* ts)
 {
-    ts->tv_sec = sfe_millis();
-    ts->tv_nsec = 0;
+    uint32_t ms = sfe_millis();
+
+    ts->tv_sec = ms / 1000;
+    ts->tv_nsec = (ms % 1000) * 1000000;
 }
@@ -0,0 +1,110 @@
+// tmf882x_hist_unpack.c
+//
+// This is a library written for SparkFun Qwiic TMF882X boards
+//
+// SparkFun sells these bpards at its website: www.sparkfun.com
+//
+// Do you like this library? Help support SparkFun. Buy a board!
+//
+//  SparkFun Qwiic dToF Imager - TMF8820        https://www.sparkfun.com/products/19036
+//  SparkFun Qwiic Mini dToF Imager - TMF8820   https://www.sparkfun.com/products/19218
+//  SparkFun Qwiic Mini dToF Imager - TMF8821   https://www.sparkfun.com/products/19451
+//  SparkFun Qwiic dToF Imager - TMF8821        https://www.sparkfun.com/products/19037
+//
+// Written by Kirk Benell @ SparkFun Electronics, April 2022
+//
+// This library provides an abstract interface to the underlying TMF882X
+// SDK that is provided by AMS.
+//
+// Repository:
+//     https://github.com/sparkfun/SparkFun_Qwiic_TMF882X_Arduino_Library
+//
+//
+// SparkFun code, firmware, and software is released under the MIT
+// License(http://opensource.org/licenses/MIT).
+//
+// SPDX-License-Identifier: MIT
+//
+//    The MIT License (MIT)
+//
+//    Copyright (c) 2022 SparkFun Electronics
+//    Permission is hereby granted, free of charge, to any person obtaining a
+//    copy of this software and associated documentation files (the "Software"),
+//    to deal in the Software without restriction, including without limitation
+//    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//    and/or sell copies of the Software, and to permit persons to whom the
+//    Software is furnished to do so, subject to the following conditions: The
+//    above copyright notice and this permission notice shall be included in all
+//    copies or substantial portions of the Software. THE SOFTWARE IS PROVIDED
+//    "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+//    NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+//    PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+//    ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+//    CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Unpack kernels for the 24 bit histograms of the TMF882X
+
+#include <string.h>
+
+#include "inc/tmf882x.h"
+#include "inc/tmf882x_hist_unpack.h"
+
+// Not needed in the memory profiles without histograms
+#ifndef CONFIG_TMF882X_NO_HISTOGRAM_SUPPORT
+
+//////////////////////////////////////////////////////////////////////////////
+// unpack_bytes()
+//
+// Build count bins, one byte from each plane per bin.
+
+static void unpack_bytes(uint32_t *bins, const uint8_t *low, const uint8_t *mid, const uint8_t *high,
+                         uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++)
+        bins[i] = (uint32_t)low[i] | ((uint32_t)mid[i] << 8) | ((uint32_t)high[i] << 16);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// tmf882x_hist_unpack24_bytes()
+//
+// Portable version - each bin is built from one byte of each plane.
+
+void tmf882x_hist_unpack24_bytes(uint32_t *bins, const uint8_t *data, uint32_t num_bins)
+{
+    unpack_bytes(bins, data, data + num_bins, data + 2 * num_bins, num_bins);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// tmf882x_hist_unpack24_words()
+//
+// Word at a time version - a 32 bit word is loaded from each plane, holding
+// the bytes of four bins, and the bins are built from the three words. The
+// planes don't need to be aligned - memcpy() is used for the loads, which
+// compiles to a single load where unaligned access is allowed.
+
+void tmf882x_hist_unpack24_words(uint32_t *bins, const uint8_t *data, uint32_t num_bins)
+{
+    const uint8_t *low = data;
+    const uint8_t *mid = data + num_bins;
+    const uint8_t *high = data + 2 * num_bins;
+    uint32_t i = 0;
+
+    for (; i + 4 <= num_bins; i += 4) {
+        uint32_t l, m, h;
+
+        memcpy(&l, low + i, sizeof(l));
+        memcpy(&m, mid + i, sizeof(m));
+        memcpy(&h, high + i, sizeof(h));
+
+        bins[i] = (l & 0xFF) | ((m & 0xFF) << 8) | ((h & 0xFF) << 16);
+        bins[i + 1] = ((l >> 8) & 0xFF) | (m & 0xFF00) | ((h & 0xFF00) << 8);
+        bins[i + 2] = ((l >> 16) & 0xFF) | ((m >> 8) & 0xFF00) | (h & 0xFF0000);
+        bins[i + 3] = (l >> 24) | ((m >> 16) & 0xFF00) | ((h >> 8) & 0xFF0000);
+    }
+
+    // any bins left over
+    unpack_bytes(bins + i, low + i, mid + i, high + i, num_bins - i);
+}
+
+#endif
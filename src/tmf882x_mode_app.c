@@ -25,12 +25,16 @@
  */
 
 /***** tmf882x_app.c *****/
+#include <stddef.h>
+
 #include "inc/tmf882x.h"
 #include "inc/tmf882x_host_interface.h"
 #include "inc/tmf882x_clock_correction.h"
 #include "inc/tmf882x_mode_app_protocol.h"
 #include "inc/tmf882x_mode_app_ioctl.h"
 #include "inc/tmf882x_mode_app.h"
+#include "inc/tmf882x_hist_unpack.h"
+#include "inc/tmf882x_result_unpack.h"
 #include "tmf882x_interface.h"
 
 #define TMF882X_APP_MODE_TAG          0x03U
@@ -50,17 +54,46 @@
 #define MS_TIME_TO_RETRIES(ms)          ((ms)*1000/(CMD_USLEEP_INCR))
 #define BITS_IN_BYTE                    8
 #define TMF882X_INT_MASK                0x7
-#define RESULT_IDX_TO_CHANNEL(idx)     (((idx)%((TMF882X_HIST_NUM_TDC*2)-1)) + 1)
-#define RESULT_IDX_TO_SUB_CAPTURE(idx) (((idx)/((TMF882X_HIST_NUM_TDC*2)-1)) % \
-                                        TMF8X2X_MAX_CONFIGURATIONS)
 #define APP_IS_CMD_BUSY(x)             ((x) >= TMF8X2X_COM_CMD_STAT__cmd_stat__CMD_MEASURE)
 #define reg_to_idx(reg)                ((reg) - TMF8X2X_COM_CONFIG_RESULT - \
                                         TMF8X2X_COM_HEADER_SIZE)
 
+// Common config page fields - the registers a config update can write
+#define CFG_FIELDS_FIRST_REG           TMF8X2X_COM_PERIOD_MS_LSB
+#define CFG_FIELDS_LAST_REG            TMF8X2X_COM_OSC_TRIM_VALUE_MSB
+#define CFG_FIELDS_SIZE                (CFG_FIELDS_LAST_REG - CFG_FIELDS_FIRST_REG + 1)
+
 // MSB of RID register is used to indicate a multi-packet response
 #define APP_RESP_IS_MULTI_PACKET(RID) (RID & TMF8X2X_COM_OPTIONAL_SUBPACKET_HEADER_MASK)
 
 #define ARR_SIZE(arr)  (sizeof(arr)/sizeof(arr[0]))
+
+// Memory profile checks - the buffers must hold the messages of the profile.
+// The output slots of volat_data are each sized for their own type, and are
+// published as a struct tmf882x_msg - the header must come first.
+#define APP_SLOT_SIZE(member) sizeof(((struct tmf882x_mode_app *)0)->volat_data.member)
+
+_Static_assert(APP_MAX_MSG_SIZE >= TMF8X2X_COM_HEADER_PLUS_PAYLOAD,
+               "i2c_msg buffer can't hold one packet");
+_Static_assert(offsetof(struct tmf882x_msg_meas_results, hdr) == 0 &&
+               offsetof(struct tmf882x_msg_error, hdr) == 0,
+               "output slot can't be published as a message");
+_Static_assert(APP_SLOT_SIZE(result_msg.results) >= TMF882X_NUM_CH_TARGETS * TMF882X_NUM_SUB_CAPTURES *
+                                                        TMF882X_NUM_RESULT_CH * sizeof(struct tmf882x_meas_result),
+               "results slot can't hold a full result list");
+#ifndef CONFIG_TMF882X_NO_STATS_SUPPORT
+_Static_assert(offsetof(struct tmf882x_msg_meas_stats, hdr) == 0,
+               "stats slot can't be published as a message");
+#endif
+#ifndef CONFIG_TMF882X_NO_HISTOGRAM_SUPPORT
+_Static_assert(APP_MAX_MSG_SIZE >= (TMF882X_HIST_NUM_TDC * TMF882X_HIST_NUM_BINS *
+                                    APP_HIST_BYTES_PER_BIN) + TMF8X2X_COM_HEADER_PLUS_PAYLOAD,
+               "i2c_msg buffer can't hold a histogram");
+_Static_assert(offsetof(struct tmf882x_msg_histogram, hdr) == 0,
+               "histogram slot can't be published as a message");
+_Static_assert(APP_SLOT_SIZE(hist_msg.bins) >= TMF882X_HIST_NUM_TDC * TMF882X_HIST_NUM_BINS * sizeof(uint32_t),
+               "histogram slot can't hold the bins of all TDCs");
+#endif
 #define tof_app_dbg(app, fmt, ...) \
 ({ \
     struct tmf882x_mode_app *__app = (app); \
@@ -189,9 +222,25 @@ static inline struct tmf882x_mode *to_parent(struct tmf882x_mode_app *app)
     return &app->mode;
 }
 
-static inline struct tmf882x_msg * to_msg(struct tmf882x_mode_app *app)
+static inline struct tmf882x_msg * to_err_msg(struct tmf882x_mode_app *app)
 {
-    return &app->volat_data.msg;
+    return (struct tmf882x_msg *)&app->volat_data.err_msg;
+}
+
+static struct tmf882x_capture * to_capture(struct tmf882x_mode_app *app,
+                                           uint32_t capture_num)
+{
+    struct tmf882x_capture *capture = app->capture;
+
+    if (!capture) return NULL;
+
+    // data held for an earlier capture that never got its results is dropped
+    if (capture->capture_num != capture_num) {
+        capture->capture_num = capture_num;
+        capture->hist_mask = 0;
+        capture->stats_mask = 0;
+    }
+    return capture;
 }
 
 static inline struct tmf882x_mode_app_i2c_msg * to_i2cmsg(struct tmf882x_mode_app *app)
@@ -471,7 +520,10 @@ static int32_t clock_skew_correction(struct tmf882x_mode_app *app,
     uint32_t cr_dist = 0;
     uint32_t i = 0;
 
-    tof_get_timespec(&current_ts);
+    if (app->replay_ts)
+        current_ts = *app->replay_ts;
+    else
+        tof_get_timespec(&current_ts);
     if ( (current_ts.tv_sec - app->volat_data.timestamp.tv_sec) >= 60 ) {
         // Reset our clock correction averaging every minute so we can still
         //  be responsive to clock drift in the device
@@ -500,6 +552,16 @@ static int32_t clock_skew_correction(struct tmf882x_mode_app *app,
                         results->results[i].distance_mm, cr_dist);
             results->results[i].distance_mm = cr_dist;
         }
+
+        // same correction for the compact copy of the results
+        for (i = 0; i < TMF882X_MAX_MEAS_RESULTS; ++i) {
+            if (((uint8_t *)app->volat_data.compact.confidence)[i] ||
+                ((uint16_t *)app->volat_data.compact.distance_mm)[i]) {
+                ((uint16_t *)app->volat_data.compact.distance_mm)[i] = (uint16_t)
+                    tmf882x_clk_corr_map(&app->volat_data.clk_cr,
+                        ((uint16_t *)app->volat_data.compact.distance_mm)[i]);
+            }
+        }
     }
 
     return 0;
@@ -512,33 +574,33 @@ static int32_t publish_measure_results(struct tmf882x_mode_app *app,
     (void) clock_skew_correction(app, results);
 
     // fire away
-    return tof_queue_msg(priv(app), to_msg(app));
+    return tof_queue_msg(priv(app), (struct tmf882x_msg *)results);
 }
 
 static int32_t decode_result_msg(struct tmf882x_mode_app *app,
                                  const struct tmf882x_mode_app_i2c_msg *i2c_msg)
 {
-    uint32_t i = 0, j = 0;
-    struct tmf882x_msg_meas_results *result_msg = &(to_msg(app)->meas_result_msg);
+    struct tmf882x_msg_meas_results *result_msg = &app->volat_data.result_msg;
+    struct tmf882x_meas_compact *compact = &app->volat_data.compact;
+    struct tmf882x_capture *capture = NULL;
     const uint8_t *head = i2c_msg->buf;
     const uint8_t *tail = NULL;
-    uint8_t confidence = 0;
-    uint16_t distance_mm = 0;
     uint32_t obj_cnt = 0;
-    uint32_t ch_target_idx = 0;
     int32_t extra_data = 0;
 
-    //initialize output msg
-    TOF_ZERO_MSG(result_msg);
+    //initialize output msg - decoded in place if there is a capture buffer.
+    // Every field is written below, and the results up to num_results, so
+    // the message isn't cleared first.
+    capture = to_capture(app, head[reg_to_idx(TMF8X2X_COM_RESULT_NUMBER)]);
+    if (capture)
+        result_msg = &capture->results;
     TOF_SET_MSG_HDR(result_msg, ID_MEAS_RESULTS, struct tmf882x_msg_meas_results);
+    memset(compact, 0, sizeof(*compact));
 
     // Decode result Header
-    decode_8b(&head[reg_to_idx(TMF8X2X_COM_RESULT_NUMBER)],
-              (uint8_t *)&result_msg->result_num);
-    decode_8b(&head[reg_to_idx(TMF8X2X_COM_TEMPERATURE)],
-              (uint8_t *)&result_msg->temperature);
-    decode_8b(&head[reg_to_idx(TMF8X2X_COM_NUMBER_VALID_RESULTS)],
-              (uint8_t *)&result_msg->valid_results);
+    result_msg->result_num = head[reg_to_idx(TMF8X2X_COM_RESULT_NUMBER)];
+    result_msg->temperature = head[reg_to_idx(TMF8X2X_COM_TEMPERATURE)];
+    result_msg->valid_results = head[reg_to_idx(TMF8X2X_COM_NUMBER_VALID_RESULTS)];
     decode_32b(&head[reg_to_idx(TMF8X2X_COM_AMBIENT_LIGHT_0)],
                &result_msg->ambient_light);
     decode_32b(&head[reg_to_idx(TMF8X2X_COM_PHOTON_COUNT_0)],
@@ -546,33 +608,24 @@ static int32_t decode_result_msg(struct tmf882x_mode_app *app,
     decode_32b(&head[reg_to_idx(TMF8X2X_COM_REFERENCE_COUNT_0)],
                &result_msg->ref_photon_count);
     decode_32b(&head[reg_to_idx(TMF8X2X_COM_SYS_TICK_0)], &result_msg->sys_ticks);
+    result_msg->host_time_us = 0;
 
-    // start of object result list
-    for (i = 0, tail = &head[reg_to_idx(TMF8X2X_COM_RES_CONFIDENCE_0)], obj_cnt = 0;
-         i < TMF8X2X_COM_MAX_MEASUREMENT_RESULTS; ++i) {
-
-        tail = decode_8b(tail, &confidence);
-        tail = decode_16b(tail, &distance_mm);
-
-        if (confidence != 0 || distance_mm != 0) {
-            // object detected, add it to the result message
-
-            // Find how many targets are in this channel already
-            for (j = 0, ch_target_idx = 0; j < obj_cnt; ++j)
-                if (result_msg->results[j].channel == RESULT_IDX_TO_CHANNEL(i) &&
-                    result_msg->results[j].sub_capture == RESULT_IDX_TO_SUB_CAPTURE(i))
-                    ch_target_idx++;
-
-            result_msg->results[obj_cnt].confidence = confidence;
-            result_msg->results[obj_cnt].distance_mm = distance_mm;
-            result_msg->results[obj_cnt].channel = RESULT_IDX_TO_CHANNEL(i);
-            result_msg->results[obj_cnt].sub_capture = RESULT_IDX_TO_SUB_CAPTURE(i);
-            result_msg->results[obj_cnt].ch_target_idx = ch_target_idx;
-            obj_cnt++;
-        }
-    }
+    // object result list - one pass, constant cost per result
+    tail = &head[reg_to_idx(TMF8X2X_COM_RES_CONFIDENCE_0)];
+    obj_cnt = tmf882x_result_unpack(result_msg, compact, tail);
+    tail += TMF882X_RESULT_LIST_SIZE;
 
     result_msg->num_results = obj_cnt;
+
+    compact->result_num = result_msg->result_num;
+    compact->temperature = result_msg->temperature;
+    compact->valid_results = result_msg->valid_results;
+    compact->num_results = obj_cnt;
+    compact->ambient_light = result_msg->ambient_light;
+    compact->photon_count = result_msg->photon_count;
+    compact->ref_photon_count = result_msg->ref_photon_count;
+    compact->sys_ticks = result_msg->sys_ticks;
+    compact->host_time_us = 0;
     if (obj_cnt != result_msg->valid_results) {
         tof_info(priv(app), "Warning num objects (%u) != valid results (%u)",
                  obj_cnt, result_msg->valid_results);
@@ -593,24 +646,31 @@ static int32_t decode_result_msg(struct tmf882x_mode_app *app,
     return publish_measure_results(app, result_msg);
 }
 
+#ifndef CONFIG_TMF882X_NO_STATS_SUPPORT
 static int32_t decode_meas_stats_msg(struct tmf882x_mode_app *app,
                                  const struct tmf882x_mode_app_i2c_msg *i2c_msg)
 {
     uint32_t i;
-    struct tmf882x_msg_meas_stats *stat_msg = &(to_msg(app)->meas_stat_msg);
+    struct tmf882x_msg_meas_stats *stat_msg = &app->volat_data.stats_msg;
+    struct tmf882x_capture *capture = NULL;
     const uint8_t *head = i2c_msg->buf;
     const uint8_t *tail;
+    uint8_t sub_capture = head[reg_to_idx(TMF8X2X_COM_STATISTICS_CFG_IDX)];
 
-    //initialize output msg
-    TOF_ZERO_MSG(stat_msg);
+    //initialize output msg - decoded in place if there is a capture buffer.
+    // Every field is written below, so the message isn't cleared first.
+    capture = to_capture(app, app->volat_data.capture_num);
+    if (capture && sub_capture < TMF882X_NUM_SUB_CAPTURES) {
+        stat_msg = &capture->stats[sub_capture];
+        capture->stats_mask |= (1 << sub_capture);
+    }
     TOF_SET_MSG_HDR(stat_msg, ID_MEAS_STATS, struct tmf882x_msg_meas_stats);
 
     // This tag *should* match the 'result_num' from the next measurement
     // result data
     stat_msg->capture_num = app->volat_data.capture_num;
     //fill out sub-capture index field
-    decode_8b(&head[reg_to_idx(TMF8X2X_COM_STATISTICS_CFG_IDX)],
-              (uint8_t *)&stat_msg->sub_capture);
+    stat_msg->sub_capture = sub_capture;
     decode_32b(&head[reg_to_idx(TMF8X2X_COM_TDCIF_STATUS)],
                &stat_msg->tdcif_status);
     decode_32b(&head[reg_to_idx(TMF8X2X_COM_ITERATIONS_CONFIGURED)],
@@ -632,8 +692,9 @@ static int32_t decode_meas_stats_msg(struct tmf882x_mode_app *app,
     }
 
     // publish statistic data
-    return tof_queue_msg(priv(app), to_msg(app));
+    return tof_queue_msg(priv(app), (struct tmf882x_msg *)stat_msg);
 }
+#endif
 
 static int32_t encode_config_msg(struct tmf882x_mode_app *app,
                              struct tmf882x_mode_app_i2c_msg *i2c_msg,
@@ -655,7 +716,12 @@ static int32_t encode_config_msg(struct tmf882x_mode_app *app,
     encode_8b(&head[reg_to_idx(TMF8X2X_COM_POWER_CFG)], config->power_cfg);
     encode_8b(&head[reg_to_idx(TMF8X2X_COM_SPAD_MAP_ID)], config->spad_map_id);
     encode_32b(&head[reg_to_idx(TMF8X2X_COM_ALG_SETTING_0)], config->alg_setting);
+#ifdef CONFIG_TMF882X_NO_HISTOGRAM_SUPPORT
+    // histogram messages don't fit in the message buffers of this build
+    encode_8b(&head[reg_to_idx(TMF8X2X_COM_HIST_DUMP)], 0);
+#else
     encode_8b(&head[reg_to_idx(TMF8X2X_COM_HIST_DUMP)], config->histogram_dump);
+#endif
     encode_8b(&head[reg_to_idx(TMF8X2X_COM_SPREAD_SPECTRUM)], config->spread_spectrum);
     encode_8b(&head[reg_to_idx(TMF8X2X_COM_I2C_SLAVE_ADDRESS)],
               (config->i2c_slave_addr << TMF8X2X_COM_I2C_SLAVE_ADDRESS__7bit_slave_address__SHIFT));
@@ -821,11 +887,8 @@ static int32_t rid_to_histogram_type(struct tmf882x_mode_app *app,
 static int32_t decode_histogram_msg(struct tmf882x_mode_app *app,
                                     const struct tmf882x_mode_app_i2c_msg *i2c_msg)
 {
-    struct tmf882x_msg *msg = to_msg(app);
-    uint32_t tdc_idx = 0;
-    uint32_t bin_idx = 0;
-    uint32_t byte_idx = 0;
-    uint32_t offset = 0;
+    struct tmf882x_msg_histogram *hist_msg = &app->volat_data.hist_msg;
+    struct tmf882x_capture *capture = NULL;
     uint32_t num_tdc = 0;
     uint32_t bytes_per_bin = 0;
     uint32_t num_bins = 0;
@@ -842,7 +905,7 @@ static int32_t decode_histogram_msg(struct tmf882x_mode_app *app,
         case HIST_TYPE_RAW:
         case HIST_TYPE_ELEC_CAL:
             /* raw / elec cal histograms are 24 bit */
-            bytes_per_bin = 3;
+            bytes_per_bin = APP_HIST_BYTES_PER_BIN;
             break;
         default:
             return -1;
@@ -872,40 +935,38 @@ static int32_t decode_histogram_msg(struct tmf882x_mode_app *app,
      *     tdc1 - bin1 - byte1
      */
 
-    //initialize output msg
-    TOF_ZERO_MSG(msg);
+    // initialize output msg - raw histograms are decoded in place if there
+    // is a capture buffer. The bins are all written by the unpack below, so
+    // only the header is set up - no clearing of the whole message.
+    if (hist_type == HIST_TYPE_RAW)
+        capture = to_capture(app, app->volat_data.capture_num);
+    if (capture && i2c_msg->cfg_id < TMF882X_NUM_SUB_CAPTURES) {
+        hist_msg = &capture->hist[i2c_msg->cfg_id];
+        capture->hist_mask |= (1 << i2c_msg->cfg_id);
+    }
 
     // Init histogram msg header
-    TOF_SET_HISTOGRAM_MSG(msg, hist_type);
-    msg->hist_msg.num_bins = num_bins;
-    msg->hist_msg.num_tdc = num_tdc;
+    TOF_SET_HISTOGRAM_MSG(hist_msg, hist_type);
+    hist_msg->num_bins = num_bins;
+    hist_msg->num_tdc = num_tdc;
     // This tag *should* match the 'result_num' from the next measurement
     // result data
-    msg->hist_msg.capture_num = app->volat_data.capture_num;
-
-    for (tdc_idx = 0; tdc_idx < num_tdc; ++tdc_idx) {
-
-        for (byte_idx = 0; byte_idx < bytes_per_bin; ++byte_idx) {
+    hist_msg->capture_num = app->volat_data.capture_num;
 
-            offset = (byte_idx * num_bins * num_tdc) + (num_bins * tdc_idx);
-
-            for (bin_idx = 0; bin_idx < num_bins; ++bin_idx) {
-                msg->hist_msg.bins[tdc_idx][bin_idx] |=
-                    (data[offset + bin_idx] << (BITS_IN_BYTE*byte_idx));
-            }
-        }
-    }
+    // The bins of all TDCs are contiguous in both the byte planes and the
+    // message, so they are unpacked in one pass
+    tmf882x_hist_unpack24(hist_msg->bins[0], data, num_tdc * num_bins);
 
     // Update time-multiplexed index (sub capture)
-    msg->hist_msg.sub_capture = i2c_msg->cfg_id;
+    hist_msg->sub_capture = i2c_msg->cfg_id;
 
     // debug histogram data
     if (DEBUG_DUMP_HIST) {
-        tmf882x_dump_data(to_parent(app), (uint8_t *)msg->hist_msg.bins[0], 256);
+        tmf882x_dump_data(to_parent(app), (uint8_t *)hist_msg->bins[0], 256);
     }
 
     // publish histogram data
-    return tof_queue_msg(priv(app), msg);
+    return tof_queue_msg(priv(app), (struct tmf882x_msg *)hist_msg);
 }
 #endif
 
@@ -923,8 +984,8 @@ static int32_t tmf882x_mode_app_i2c_msg_push(struct tmf882x_mode_app *app,
         rc = tof_i2c_write(priv(app), TMF8X2X_COM_TID,
                            hdr_buf, TMF8X2X_COM_HEADER_SIZE);
         if (rc) {
-            TOF_SET_ERR_MSG(to_msg(app), ERR_COMM);
-            tof_queue_msg(priv(app), to_msg(app));
+            TOF_SET_ERR_MSG(to_err_msg(app), ERR_COMM);
+            tof_queue_msg(priv(app), to_err_msg(app));
             tof_err(priv(app), "Error: %d writing App i2c_msg header", rc);
             return -1;
         }
@@ -935,8 +996,8 @@ static int32_t tmf882x_mode_app_i2c_msg_push(struct tmf882x_mode_app *app,
                            i2c_msg->buf, i2c_msg->size);
         if (rc) {
             tof_err(priv(app), "Error: %d writing App i2c_msg payload", rc);
-            TOF_SET_ERR_MSG(to_msg(app), ERR_COMM);
-            tof_queue_msg(priv(app), to_msg(app));
+            TOF_SET_ERR_MSG(to_err_msg(app), ERR_COMM);
+            tof_queue_msg(priv(app), to_err_msg(app));
             return -1;
         }
     }
@@ -949,8 +1010,8 @@ static int32_t tmf882x_mode_app_i2c_msg_push(struct tmf882x_mode_app *app,
                           i2c_msg->cmd);
     if (rc) {
         tof_err(priv(app), "Error: %d writing App i2c_msg command", rc);
-        TOF_SET_ERR_MSG(to_msg(app), ERR_COMM);
-        tof_queue_msg(priv(app), to_msg(app));
+        TOF_SET_ERR_MSG(to_err_msg(app), ERR_COMM);
+        tof_queue_msg(priv(app), to_err_msg(app));
         return -1;
     }
 
@@ -1071,8 +1132,8 @@ static int32_t tmf882x_mode_app_i2c_msg_recv(struct tmf882x_mode_app *app,
     rc = wait_for_tid_change(app);
     if (rc) {
         tof_err(priv(app), "Error: %d IRQ TID never changed", rc);
-        TOF_SET_ERR_MSG(to_msg(app), ERR_COMM);
-        tof_queue_msg(priv(app), to_msg(app));
+        TOF_SET_ERR_MSG(to_err_msg(app), ERR_COMM);
+        tof_queue_msg(priv(app), to_err_msg(app));
         return -1;
     }
 
@@ -1081,8 +1142,8 @@ static int32_t tmf882x_mode_app_i2c_msg_recv(struct tmf882x_mode_app *app,
                       i2c_msg->buf, payload_sz);
     if (rc) {
         tof_err(priv(app), "Error: %d reading App i2c_msg header", rc);
-        TOF_SET_ERR_MSG(to_msg(app), ERR_COMM);
-        tof_queue_msg(priv(app), to_msg(app));
+        TOF_SET_ERR_MSG(to_err_msg(app), ERR_COMM);
+        tof_queue_msg(priv(app), to_err_msg(app));
         return -1;
     }
 
@@ -1092,6 +1153,15 @@ static int32_t tmf882x_mode_app_i2c_msg_recv(struct tmf882x_mode_app *app,
 
     if (APP_RESP_IS_MULTI_PACKET(i2c_msg->rid)) {
 
+        // each packet is read in full, the last one can go past the message
+        if (i2c_msg->size + payload_sz > sizeof(i2c_msg->buf)) {
+            tof_err(priv(app), "Error: i2c_msg size %u B too large for buffer",
+                    i2c_msg->size);
+            TOF_SET_ERR_MSG(to_err_msg(app), ERR_BUF_OVERFLOW);
+            tof_queue_msg(priv(app), to_err_msg(app));
+            return -1;
+        }
+
         data_read = i2c_msg->pckt_size;
         // First packet is already read, throw out header by shifting data down
         app_memmove(i2c_msg->buf, head, i2c_msg->pckt_size);
@@ -1113,8 +1183,8 @@ static int32_t tmf882x_mode_app_i2c_msg_recv(struct tmf882x_mode_app *app,
                 if (rc) {
                     tof_err(priv(app), "Error: %d reading App i2c_msg packet",
                             rc);
-                    TOF_SET_ERR_MSG(to_msg(app), ERR_COMM);
-                    tof_queue_msg(priv(app), to_msg(app));
+                    TOF_SET_ERR_MSG(to_err_msg(app), ERR_COMM);
+                    tof_queue_msg(priv(app), to_err_msg(app));
                     return -1;
                 }
 
@@ -1203,7 +1273,9 @@ static int32_t decode_irq_msg(struct tmf882x_mode_app *app,
             }
             break;
         case TMF8X2X_COM_CONFIG_RESULT__cid_rid__ACCUMULATED_HITS_RESULT:
+#ifndef CONFIG_TMF882X_NO_STATS_SUPPORT
             rc = decode_meas_stats_msg(app, i2c_msg);
+#endif
             break;
         case 0:
             // Message RID '0' is not a valid message, and this IRQ does not
@@ -1218,8 +1290,8 @@ static int32_t decode_irq_msg(struct tmf882x_mode_app *app,
 
     if (rc) {
         // publish error message
-        TOF_SET_ERR_MSG(to_msg(app), ERR_COMM);
-        tof_queue_msg(priv(app), to_msg(app));
+        TOF_SET_ERR_MSG(to_err_msg(app), ERR_COMM);
+        tof_queue_msg(priv(app), to_err_msg(app));
     }
 
     return rc;
@@ -1430,8 +1502,8 @@ static int32_t tmf882x_mode_app_handle_irq(struct tmf882x_mode *self)
 
     int_stat = tof_clear_irq(app);
     if (int_stat < 0) {
-        TOF_SET_ERR_MSG(to_msg(app), ERR_COMM);
-        tof_queue_msg(priv(app), to_msg(app));
+        TOF_SET_ERR_MSG(to_err_msg(app), ERR_COMM);
+        tof_queue_msg(priv(app), to_err_msg(app));
         return int_stat;
     }
 
@@ -1466,6 +1538,8 @@ static int32_t tmf882x_mode_app_handle_irq(struct tmf882x_mode *self)
             tof_err(priv(app), "Error (%d) receiving i2c message", rc);
             return rc;
         }
+        if (app->recorder.record)
+            app->recorder.record(app->recorder.context, i2c_msg);
         rc = decode_irq_msg(app, i2c_msg);
         if (rc) {
             tof_err(priv(app), "Error (%d) decoding i2c message", rc);
@@ -1519,6 +1593,7 @@ static int32_t tmf882x_mode_app_get_config(struct tmf882x_mode_app *app,
 
     // Cache latest common config to local context
     app_memmove(&app->volat_data.cfg, cfg, sizeof(app->volat_data.cfg));
+    app->volat_data.cfg_valid = true;
 
     if (capture_state) {
         rc = tmf882x_mode_app_start_measurements(&app->mode);
@@ -1568,6 +1643,9 @@ static int32_t tmf882x_mode_app_set_config(struct tmf882x_mode_app *app,
         return -1;
     }
 
+    // the cached config doesn't match the device until the commit is done
+    app->volat_data.cfg_valid = false;
+
     rc = commit_config_msg(app, i2c_msg);
     if (rc) {
         tof_err(priv(app), "Error (%d) commiting common config", rc);
@@ -1576,6 +1654,7 @@ static int32_t tmf882x_mode_app_set_config(struct tmf882x_mode_app *app,
 
     // Cache latest common config to local context
     app_memmove(&app->volat_data.cfg, cfg, sizeof(app->volat_data.cfg));
+    app->volat_data.cfg_valid = true;
 
     if (DEBUG_DUMP_CONFIG) {
         tof_info(priv(app), "WRITE Config");
@@ -1593,6 +1672,97 @@ static int32_t tmf882x_mode_app_set_config(struct tmf882x_mode_app *app,
     return rc;
 }
 
+static int32_t tmf882x_mode_app_update_config(struct tmf882x_mode_app *app,
+                                              const struct tmf882x_mode_app_config *cfg)
+{
+    int32_t rc = 0;
+    bool capture_state = false;
+    struct tmf882x_mode_app_i2c_msg *i2c_msg;
+    uint8_t cached[CFG_FIELDS_SIZE];
+    uint8_t *fields;
+    uint32_t first, last;
+
+    if (!verify_mode(&app->mode)) return -1;
+    if (!cfg) return -1;
+
+    // Without a valid cached config, the page has to be read for modification
+    if (!app->volat_data.cfg_valid)
+        return tmf882x_mode_app_set_config(app, cfg);
+
+    // Encode the cached and the new config, and find the bytes that differ
+    i2c_msg = to_i2cmsg(app);
+    fields = &i2c_msg->buf[reg_to_idx(CFG_FIELDS_FIRST_REG)];
+
+    (void) encode_config_msg(app, i2c_msg, &app->volat_data.cfg);
+    app_memmove(cached, fields, CFG_FIELDS_SIZE);
+    (void) encode_config_msg(app, i2c_msg, cfg);
+
+    for (first = 0; first < CFG_FIELDS_SIZE && fields[first] == cached[first]; ++first)
+        ;
+    if (first == CFG_FIELDS_SIZE)
+        return 0; // nothing to do, the device has this config
+
+    for (last = CFG_FIELDS_SIZE - 1; fields[last] == cached[last]; --last)
+        ;
+
+    if ((capture_state = is_measuring(app))) {
+        rc = tmf882x_mode_app_stop_measurements(&app->mode);
+        if (rc) {
+            tof_err(priv(app), "Error (%d) stopping measurements "
+                    "for updating config", rc);
+            return -1;
+        }
+    }
+
+    // Load the page into the register map - the content is known, so it isn't
+    // read back
+    i2c_msg->cmd = TMF8X2X_COM_CMD_STAT__cmd_stat__CMD_LOAD_CONFIG_PAGE_COMMON;
+    i2c_msg->size = 0;
+
+    rc = tmf882x_mode_app_i2c_msg_send(app, i2c_msg);
+    if (rc) {
+        tof_err(priv(app), "Error (%d) loading common config for update", rc);
+        return -1;
+    }
+
+    // the cached config doesn't match the device until the commit is done
+    app->volat_data.cfg_valid = false;
+
+    // write the bytes that differ, then commit the page
+    rc = tof_i2c_write(priv(app), CFG_FIELDS_FIRST_REG + first,
+                       &fields[first], last - first + 1);
+    if (rc) {
+        tof_err(priv(app), "Error (%d) writing common config update", rc);
+        TOF_SET_ERR_MSG(to_err_msg(app), ERR_COMM);
+        tof_queue_msg(priv(app), to_err_msg(app));
+        return -1;
+    }
+
+    i2c_msg->size = 0;
+    rc = commit_config_msg(app, i2c_msg);
+    if (rc) {
+        tof_err(priv(app), "Error (%d) commiting common config", rc);
+        return -1;
+    }
+
+    // Cache latest common config to local context
+    app_memmove(&app->volat_data.cfg, cfg, sizeof(app->volat_data.cfg));
+    app->volat_data.cfg_valid = true;
+
+    tof_app_dbg(app, "app: config update - %u B at %#x",
+                last - first + 1, CFG_FIELDS_FIRST_REG + first);
+
+    if (capture_state) {
+        rc = tmf882x_mode_app_start_measurements(&app->mode);
+        if (rc) {
+            tof_err(priv(app), "Error (%d) re-starting measurements", rc);
+            return -1;
+        }
+    }
+
+    return rc;
+}
+
 static int32_t tmf882x_mode_app_get_spad_config(struct tmf882x_mode_app *app,
                                                 struct tmf882x_mode_app_spad_config *spad_cfg)
 {
@@ -1658,7 +1828,8 @@ static int32_t tmf882x_mode_app_get_spad_config(struct tmf882x_mode_app *app,
 }
 
 static int32_t tmf882x_mode_app_set_spad_config(struct tmf882x_mode_app *app,
-                                                const struct tmf882x_mode_app_spad_config *spad_cfg)
+                                                const struct tmf882x_mode_app_spad_config *spad_cfg,
+                                                struct tmf882x_mode_app_spad_image *spad_img)
 {
     int32_t rc = 0;
     int32_t i;
@@ -1709,6 +1880,10 @@ static int32_t tmf882x_mode_app_set_spad_config(struct tmf882x_mode_app *app,
     }
 
     i2c_msg = to_i2cmsg(app);
+    if (spad_img) {
+        spad_img->spad_map_id = app->volat_data.cfg.spad_map_id;
+        spad_img->num_pages = 0;
+    }
     for (i = 0; i < num_cfg; ++i) {
 
         // Write the nth time-multiplexed spad config assume spad read configs are all
@@ -1730,6 +1905,14 @@ static int32_t tmf882x_mode_app_set_spad_config(struct tmf882x_mode_app *app,
             return -1;
         }
 
+        // keep the encoded page, it can be written again as it is
+        if (spad_img) {
+            app_memmove(spad_img->pages[i],
+                        &i2c_msg->buf[reg_to_idx(TMF8X2X_COM_SPAD_ENABLE_SPAD0_0)],
+                        TMF882X_SPAD_PAGE_SIZE);
+            spad_img->num_pages++;
+        }
+
         rc = commit_config_msg(app, i2c_msg);
         if (rc) {
             tof_err(priv(app), "Error (%d) commiting spad_%u config RID: %#x",
@@ -1754,6 +1937,94 @@ static int32_t tmf882x_mode_app_set_spad_config(struct tmf882x_mode_app *app,
     return rc;
 }
 
+static int32_t tmf882x_mode_app_set_spad_image(struct tmf882x_mode_app *app,
+                                               const struct tmf882x_mode_app_spad_image *spad_img)
+{
+    int32_t rc = 0;
+    int32_t i;
+    bool capture_state = false;
+    struct tmf882x_mode_app_i2c_msg *i2c_msg;
+    struct tmf882x_mode_app_config cfg;
+
+    if (!verify_mode(&app->mode)) return -1;
+    if (!spad_img) return -1;
+    if (spad_img->num_pages == 0 ||
+        spad_img->num_pages > TMF8X2X_MAX_CONFIGURATIONS) {
+        tof_err(priv(app), "Error, spad image has %u pages",
+                spad_img->num_pages);
+        return -1;
+    }
+
+    if ((capture_state = is_measuring(app))) {
+        rc = tmf882x_mode_app_stop_measurements(&app->mode);
+        if (rc) {
+            tof_err(priv(app), "Error (%d) stopping measurements "
+                    "for setting spad image", rc);
+            return -1;
+        }
+    }
+
+    // Switch the spad map id first, only the changed byte is written
+    if (!app->volat_data.cfg_valid) {
+        rc = tmf882x_mode_app_get_config(app, &cfg);
+        if (rc) return -1;
+    }
+    if (app->volat_data.cfg.spad_map_id != spad_img->spad_map_id) {
+        app_memmove(&cfg, &app->volat_data.cfg, sizeof(cfg));
+        cfg.spad_map_id = spad_img->spad_map_id;
+        rc = tmf882x_mode_app_update_config(app, &cfg);
+        if (rc) {
+            tof_err(priv(app), "Error (%d) setting spad map id %u",
+                    rc, spad_img->spad_map_id);
+            return -1;
+        }
+    }
+
+    i2c_msg = to_i2cmsg(app);
+    for (i = 0; i < spad_img->num_pages; ++i) {
+
+        // Load the nth spad config page - its content is replaced, so it
+        // isn't read back
+        i2c_msg->cmd = TMF8X2X_COM_CMD_STAT__cmd_stat__CMD_LOAD_CONFIG_PAGE_SPAD_1 + i;
+        i2c_msg->size = 0;
+
+        rc = tmf882x_mode_app_i2c_msg_send(app, i2c_msg);
+        if (rc) {
+            tof_err(priv(app), "Error (%d) loading spad_%u config", rc, i);
+            return -1;
+        }
+
+        rc = tof_i2c_write(priv(app), TMF8X2X_COM_SPAD_ENABLE_SPAD0_0,
+                           spad_img->pages[i], TMF882X_SPAD_PAGE_SIZE);
+        if (rc) {
+            tof_err(priv(app), "Error (%d) writing spad_%u image", rc, i);
+            TOF_SET_ERR_MSG(to_err_msg(app), ERR_COMM);
+            tof_queue_msg(priv(app), to_err_msg(app));
+            return -1;
+        }
+
+        i2c_msg->size = 0;
+        rc = commit_config_msg(app, i2c_msg);
+        if (rc) {
+            tof_err(priv(app), "Error (%d) commiting spad_%u image", rc, i);
+            return -1;
+        }
+    }
+
+    tof_app_dbg(app, "app: spad image - map %u, %u pages",
+                spad_img->spad_map_id, spad_img->num_pages);
+
+    if (capture_state) {
+        rc = tmf882x_mode_app_start_measurements(&app->mode);
+        if (rc) {
+            tof_err(priv(app), "Error (%d) re-starting measurements", rc);
+            return -1;
+        }
+    }
+
+    return rc;
+}
+
 static int32_t tmf882x_mode_app_get_calib_data(struct tmf882x_mode_app *app,
                                                struct tmf882x_mode_app_calib *calib)
 {
@@ -1900,6 +2171,7 @@ static int32_t tmf882x_mode_app_do_factory_calib(struct tmf882x_mode_app *app,
     bool capture_state = false;
     bool is_8x8 = false;
     struct tmf882x_mode_app_i2c_msg *i2c_msg;
+    struct tmf882x_mode_app_config cfg;
     uint32_t hist_dump_save = 0;
     uint32_t i = 0;
     uint32_t num_calib = 0;
@@ -1916,16 +2188,17 @@ static int32_t tmf882x_mode_app_do_factory_calib(struct tmf882x_mode_app *app,
         }
     }
 
-    // disable histogram readout for factory calibration
-    hist_dump_save = app->volat_data.cfg.histogram_dump;
-    app->volat_data.cfg.histogram_dump = 0;
-    rc = tmf882x_mode_app_set_config(app, &app->volat_data.cfg);
+    // disable histogram readout for factory calibration - only written if
+    // it is enabled
+    app_memmove(&cfg, &app->volat_data.cfg, sizeof(cfg));
+    hist_dump_save = cfg.histogram_dump;
+    cfg.histogram_dump = 0;
+    rc = tmf882x_mode_app_update_config(app, &cfg);
     if (rc) {
         tof_err(priv(app), "Error (%d) disabling histogram dump "
                 "for performing factory calibration", rc);
         return -1;
     }
-    app->volat_data.cfg.histogram_dump = hist_dump_save;
 
     is_8x8 = tmf882x_mode_app_is_8x8_mode(app);
 
@@ -1959,8 +2232,8 @@ static int32_t tmf882x_mode_app_do_factory_calib(struct tmf882x_mode_app *app,
         return -1;
     }
 
-    app->volat_data.cfg.histogram_dump = hist_dump_save;
-    rc = tmf882x_mode_app_set_config(app, &app->volat_data.cfg);
+    cfg.histogram_dump = hist_dump_save;
+    rc = tmf882x_mode_app_update_config(app, &cfg);
     if (rc) {
         tof_err(priv(app), "Error (%d) re-loading histogram dump "
                 "after performing factory calibration", rc);
@@ -2065,6 +2338,30 @@ static int32_t tmf882x_mode_app_set_8x8_mode(struct tmf882x_mode_app *app, bool
     return 0;
 }
 
+static int32_t tmf882x_mode_app_replay_msg(struct tmf882x_mode_app *app,
+                                          const struct tmf882x_mode_app_replay *replay)
+{
+    struct timespec ts = {0};
+    int32_t rc;
+
+    if (!replay || !replay->i2c_msg) return -1;
+
+    // the recorded receive time stands in for the host clock
+    ts.tv_sec = replay->host_time_us / 1000000;
+    ts.tv_nsec = (replay->host_time_us % 1000000) * 1000;
+
+    if (replay->restart) {
+        app->volat_data.capture_num = 1;
+        tmf882x_clk_corr_recalc(&app->volat_data.clk_cr);
+    }
+
+    app->replay_ts = &ts;
+    rc = decode_irq_msg(app, replay->i2c_msg);
+    app->replay_ts = NULL;
+
+    return rc;
+}
+
 static int32_t tmf882x_mode_app_ioctl(struct tmf882x_mode *self, uint32_t cmd,
                                       const void *input, void *output)
 {
@@ -2092,8 +2389,15 @@ static int32_t tmf882x_mode_app_ioctl(struct tmf882x_mode *self, uint32_t cmd,
         case APP_GET_CFG:
             rc = tmf882x_mode_app_get_config(app, output);
             break;
+        case APP_UPDATE_CFG:
+            rc = tmf882x_mode_app_update_config(app, input);
+            break;
         case APP_SET_SPADCFG:
-            rc = tmf882x_mode_app_set_spad_config(app, input);
+            rc = tmf882x_mode_app_set_spad_config(app, input,
+                        (_IOCTL_DIR(cmd) & _IOCTL_READ) ? output : NULL);
+            break;
+        case APP_SET_SPADIMG:
+            rc = tmf882x_mode_app_set_spad_image(app, input);
             break;
         case APP_GET_SPADCFG:
             rc = tmf882x_mode_app_get_spad_config(app, output);
@@ -2128,6 +2432,21 @@ static int32_t tmf882x_mode_app_ioctl(struct tmf882x_mode *self, uint32_t cmd,
             (*(bool *)output) = tmf882x_mode_app_is_8x8_mode(app);
             rc = 0;
             break;
+        case APP_SET_CAPTURE:
+            app->capture = (*(struct tmf882x_capture **)input);
+            if (app->capture) {
+                app->capture->hist_mask = 0;
+                app->capture->stats_mask = 0;
+            }
+            rc = 0;
+            break;
+        case APP_SET_RECORDER:
+            app->recorder = (*(const struct tmf882x_mode_app_recorder *)input);
+            rc = 0;
+            break;
+        case APP_REPLAY_MSG:
+            rc = tmf882x_mode_app_replay_msg(app, input);
+            break;
         default:
             tof_err(priv(app), "Error unhandled IOCTL cmd [%x]", cmd);
     }
@@ -0,0 +1,96 @@
+// tmf882x_result_unpack.c
+//
+// This is a library written for SparkFun Qwiic TMF882X boards
+//
+// SparkFun sells these bpards at its website: www.sparkfun.com
+//
+// Do you like this library? Help support SparkFun. Buy a board!
+//
+//  SparkFun Qwiic dToF Imager - TMF8820        https://www.sparkfun.com/products/19036
+//  SparkFun Qwiic Mini dToF Imager - TMF8820   https://www.sparkfun.com/products/19218
+//  SparkFun Qwiic Mini dToF Imager - TMF8821   https://www.sparkfun.com/products/19451
+//  SparkFun Qwiic dToF Imager - TMF8821        https://www.sparkfun.com/products/19037
+//
+// Written by Kirk Benell @ SparkFun Electronics, April 2022
+//
+// This library provides an abstract interface to the underlying TMF882X
+// SDK that is provided by AMS.
+//
+// Repository:
+//     https://github.com/sparkfun/SparkFun_Qwiic_TMF882X_Arduino_Library
+//
+//
+// SparkFun code, firmware, and software is released under the MIT
+// License(http://opensource.org/licenses/MIT).
+//
+// SPDX-License-Identifier: MIT
+//
+//    The MIT License (MIT)
+//
+//    Copyright (c) 2022 SparkFun Electronics
+//    Permission is hereby granted, free of charge, to any person obtaining a
+//    copy of this software and associated documentation files (the "Software"),
+//    to deal in the Software without restriction, including without limitation
+//    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+//    and/or sell copies of the Software, and to permit persons to whom the
+//    Software is furnished to do so, subject to the following conditions: The
+//    above copyright notice and this permission notice shall be included in all
+//    copies or substantial portions of the Software. THE SOFTWARE IS PROVIDED
+//    "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+//    NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+//    PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+//    ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+//    CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+// Unpack kernel for the object result list of the TMF882X
+
+#include "inc/tmf882x.h"
+#include "inc/tmf882x_result_unpack.h"
+
+//////////////////////////////////////////////////////////////////////////////
+// tmf882x_result_unpack()
+//
+// The slots are in the order of the loops below - target, then sub capture,
+// then channel. The compact layout is indexed by the target slot, the result
+// message counts the targets found in each channel.
+
+uint32_t tmf882x_result_unpack(struct tmf882x_msg_meas_results *results,
+                               struct tmf882x_meas_compact *compact,
+                               const uint8_t *data)
+{
+    // targets found so far in each channel
+    uint8_t ch_targets[TMF882X_NUM_SUB_CAPTURES][TMF882X_NUM_RESULT_CH] = {{0}};
+    struct tmf882x_meas_result *result = results->results;
+    uint32_t target, sub_capture, channel;
+    uint16_t distance_mm;
+    uint8_t confidence;
+
+    for (target = 0; target < TMF882X_NUM_CH_TARGETS; ++target) {
+        for (sub_capture = 0; sub_capture < TMF882X_NUM_SUB_CAPTURES; ++sub_capture) {
+            for (channel = 0; channel < TMF882X_NUM_RESULT_CH; ++channel, data += 3) {
+
+                confidence = data[0];
+                distance_mm = (uint16_t)data[1] | ((uint16_t)data[2] << 8);
+
+                if (confidence == 0 && distance_mm == 0)
+                    continue;
+
+                // object detected, add it to the result message
+                result->confidence = confidence;
+                result->distance_mm = distance_mm;
+                result->channel = channel + 1;
+                result->sub_capture = sub_capture;
+                result->ch_target_idx = ch_targets[sub_capture][channel]++;
+                result++;
+
+                // the compact layout has a fixed slot for each target
+                compact->distance_mm[sub_capture][channel][target] = distance_mm;
+                compact->confidence[sub_capture][channel][target] = confidence;
+            }
+        }
+    }
+
+    return (uint32_t)(result - results->results);
+}